@@ -0,0 +1,150 @@
+// Compares REST throughput of the blocking curl HttpClient with the pipelined
+// AsyncHttpClient against a local stand-in for the exchange: a plain HTTP/1.1
+// keep-alive server answering every POST with a fixed JSON-RPC result.
+//
+// Build from the repository root:
+//   g++ -std=c++20 -O2 -pthread -I src bench/HttpClientBench.cpp src/auth/utils/HttpClient.cpp
+//       src/auth/utils/AsyncHttpClient.cpp src/logger.cpp -lcurl -lssl -lcrypto -o HttpClientBench
+#include "auth/utils/AsyncHttpClient.h"
+#include "auth/utils/HttpClient.h"
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/http.hpp>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+namespace http = boost::beast::http;
+using tcp = boost::asio::ip::tcp;
+
+constexpr int REQUESTS = 5000;
+constexpr int CURL_THREADS = 8;
+const char* PAYLOAD = R"({"jsonrpc":"2.0","id":1,"method":"private/buy","params":{"instrument_name":"BTC-PERPETUAL","amount":10,"type":"limit","price":50000}})";
+const char* RESULT = R"({"jsonrpc":"2.0","id":1,"result":{"order":{"order_id":"1","order_state":"open","filled_amount":0,"average_price":0},"trades":[]}})";
+
+// One thread per connection, answering requests in the order they arrive
+class StandInServer {
+public:
+    StandInServer() : acceptor(context, tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0)) {
+        std::thread([this] { acceptLoop(); }).detach();
+    }
+
+    unsigned short port() const { return acceptor.local_endpoint().port(); }
+
+private:
+    boost::asio::io_context context;
+    tcp::acceptor acceptor;
+
+    void acceptLoop() {
+        while (true) {
+            tcp::socket socket(context);
+            boost::system::error_code ec;
+            acceptor.accept(socket, ec);
+            if (ec) {
+                return;
+            }
+            std::thread([socket = std::move(socket)]() mutable { serve(socket); }).detach();
+        }
+    }
+
+    static void serve(tcp::socket& socket) {
+        socket.set_option(tcp::no_delay(true));
+        boost::beast::flat_buffer buffer;
+        boost::system::error_code ec;
+        while (true) {
+            http::request<http::string_body> request;
+            http::read(socket, buffer, request, ec);
+            if (ec) {
+                return;
+            }
+            http::response<http::string_body> response{http::status::ok, request.version()};
+            response.set(http::field::content_type, "application/json");
+            response.keep_alive(request.keep_alive());
+            response.body() = RESULT;
+            response.prepare_payload();
+            http::write(socket, response, ec);
+            if (ec || !request.keep_alive()) {
+                return;
+            }
+        }
+    }
+};
+
+void report(const char* name, std::chrono::steady_clock::time_point start, int failed) {
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ": " << static_cast<long>(REQUESTS / seconds) << " requests/s, "
+              << seconds * 1e6 / REQUESTS << " us/request (" << failed << " failed)\n";
+}
+
+AsyncHttpClient::Request makeRequest() {
+    AsyncHttpClient::Request request;
+    request.target = "/api/v2/private/buy";
+    request.body = PAYLOAD;
+    request.headers = {{"Authorization", "Bearer token"}, {"Content-Type", "application/json"}};
+    return request;
+}
+
+} // namespace
+
+int main() {
+    StandInServer server;
+    std::string origin = "http://127.0.0.1:" + std::to_string(server.port());
+    std::string url = origin + "/api/v2/private/buy";
+    std::map<std::string, std::string> headers = {{"Authorization", "Bearer token"},
+                                                  {"Content-Type", "application/json"}};
+
+    // One request at a time, as a CLI command or a single dispatcher thread sends them
+    auto start = std::chrono::steady_clock::now();
+    int failed = 0;
+    HttpClient curl;
+    for (int i = 0; i < REQUESTS; ++i) {
+        failed += curl.post(url, PAYLOAD, headers).empty();
+    }
+    report("curl, sequential", start, failed);
+
+    AsyncHttpClient client(origin);
+    start = std::chrono::steady_clock::now();
+    failed = 0;
+    for (int i = 0; i < REQUESTS; ++i) {
+        failed += client.post(makeRequest()).get().status != 200;
+    }
+    report("async, sequential", start, failed);
+
+    // Many in flight, as order coroutines and execution workers send them
+    start = std::chrono::steady_clock::now();
+    std::atomic<int> curlFailed{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < CURL_THREADS; ++t) {
+        workers.emplace_back([&] {
+            HttpClient worker;
+            for (int i = 0; i < REQUESTS / CURL_THREADS; ++i) {
+                curlFailed += worker.post(url, PAYLOAD, headers).empty();
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    report("curl, 8 threads", start, curlFailed);
+
+    start = std::chrono::steady_clock::now();
+    std::atomic<int> remaining{REQUESTS};
+    std::atomic<int> asyncFailed{0};
+    std::promise<void> done;
+    for (int i = 0; i < REQUESTS; ++i) {
+        client.post(makeRequest(), [&](AsyncHttpClient::Response& response) {
+            asyncFailed += response.status != 200;
+            if (--remaining == 0) {
+                done.set_value();
+            }
+        });
+    }
+    done.get_future().wait();
+    report("async, pipelined", start, asyncFailed);
+    return 0;
+}
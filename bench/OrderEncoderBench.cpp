@@ -0,0 +1,90 @@
+// Compares the jsoncpp order serialization path with OrderEncoder.
+//
+// Build from the repository root:
+//   g++ -std=c++17 -O2 -I src -I /usr/include/jsoncpp bench/OrderEncoderBench.cpp
+//       src/orders/OrderEncoder.cpp src/market/InstrumentRegistry.cpp -ljsoncpp -o OrderEncoderBench
+#include "orders/OrderEncoder.h"
+#include <json/json.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+static std::atomic<size_t> allocationCount{0};
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+constexpr int ITERATIONS = 200000;
+
+std::string encodeWithJsoncpp(const Order& order, uint64_t requestId) {
+    Json::Value request;
+    request["jsonrpc"] = "2.0";
+    request["id"] = static_cast<Json::UInt64>(requestId);
+    request["method"] = std::string("private/") + toString(order.side);
+
+    Json::Value params;
+    params["instrument_name"] = order.instrumentName().str();
+    params["amount"] = order.amount;
+    params["type"] = toString(order.type);
+    if (order.type == OrderType::Limit) {
+        params["price"] = order.price;
+    }
+    params["label"] = order.label.str();
+    request["params"] = params;
+
+    Json::StreamWriterBuilder writer;
+    return Json::writeString(writer, request);
+}
+
+template <typename Fn>
+void run(const char* name, Fn&& fn) {
+    size_t allocationsBefore = allocationCount.load();
+    auto start = std::chrono::steady_clock::now();
+    size_t bytes = 0;
+    for (int i = 0; i < ITERATIONS; ++i) {
+        bytes += fn(static_cast<uint64_t>(i));
+    }
+    auto end = std::chrono::steady_clock::now();
+    double nsPerOrder = std::chrono::duration<double, std::nano>(end - start).count() / ITERATIONS;
+    double allocationsPerOrder = static_cast<double>(allocationCount.load() - allocationsBefore) / ITERATIONS;
+    std::cout << name << ": " << nsPerOrder << " ns/order, " << allocationsPerOrder
+              << " allocations/order (" << bytes << " bytes)\n";
+}
+
+} // namespace
+
+int main() {
+    Order order{};
+    order.instrumentId = InstrumentRegistry::instance().intern("BTC-PERPETUAL");
+    order.side = OrderSide::Buy;
+    order.type = OrderType::Limit;
+    order.amount = 100;
+    order.price = 64123.5;
+    order.label = "q-1234";
+
+    OrderEncoder encoder;
+    encoder.prepare(order.instrumentId, 1, 0);
+
+    OrderEncoder::Buffer buffer;
+    encoder.encodePlace(order, 1, buffer);
+    std::cout << "Encoded: " << std::string(buffer.data, buffer.length) << "\n";
+
+    run("jsoncpp", [&](uint64_t id) {
+        return encodeWithJsoncpp(order, id).size();
+    });
+    run("OrderEncoder", [&](uint64_t id) {
+        encoder.encodePlace(order, id, buffer);
+        return buffer.length;
+    });
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Measures pre-trade check cost per rule, per composed rule set and for the
+// full RiskManager::checkOrder path including the exposure reservation.
+//
+// Build from the repository root:
+//   g++ -std=c++17 -O2 -I src bench/RiskPipelineBench.cpp src/risk/RiskManager.cpp
+//       src/risk/RateLimiter.cpp src/market/InstrumentRegistry.cpp src/logger.cpp -o RiskPipelineBench
+#include "risk/RiskManager.h"
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+constexpr int ITERATIONS = 5000000;
+constexpr int AMOUNTS = 64;
+
+// Keeps the compiler from hoisting the pure checks out of the loop
+template <typename T>
+void consume(T value) {
+    asm volatile("" : : "r"(value) : "memory");
+}
+
+template <typename Fn>
+void run(const char* name, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    unsigned rejected = 0;
+    for (int i = 0; i < ITERATIONS; ++i) {
+        RiskRejection rejection = fn(i);
+        rejected += rejection != RiskRejection::None;
+        consume(rejection);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double nsPerCheck = std::chrono::duration<double, std::nano>(end - start).count() / ITERATIONS;
+    std::cout << name << ": " << nsPerCheck << " ns/check (" << rejected << " rejected)\n";
+}
+
+template <typename Pipeline>
+void runPipeline(const char* name, Order* orders, const RuleLimits& limits, const RateLimiter* rateLimiter) {
+    run(name, [&](int i) {
+        const Order& order = orders[i % AMOUNTS];
+        RuleContext context{order, limits, order.amount, 1.0, 0.5, 1e-5, 20.0, 900.0,
+                            3.0, 0.01, 500.0, 1e4, false, rateLimiter};
+        return Pipeline::check(context);
+    });
+}
+
+} // namespace
+
+int main() {
+    RateLimiter rateLimiter;
+    RiskManager riskManager(&rateLimiter);
+    RiskManager::RiskLimits limits = riskManager.getRiskLimits();
+    limits.maxOrdersPerSecond = 1000000000;
+    limits.maxPortfolioDelta = 100;
+    limits.maxPortfolioVega = 1e5;
+    limits.maxOptionMargin = 1e6;
+    riskManager.setRiskLimits(limits);
+    RuleLimits linear = riskManager.getRuleLimits(InstrumentClass::Perpetual);
+
+    Order orders[AMOUNTS];
+    for (int i = 0; i < AMOUNTS; ++i) {
+        orders[i].instrumentId = InstrumentRegistry::instance().intern("BTC-PERPETUAL");
+        orders[i].side = i % 2 ? OrderSide::Buy : OrderSide::Sell;
+        orders[i].amount = 0.1 + 0.01 * i;
+        orders[i].price = 60000 + i;
+    }
+
+    runPipeline<RiskPipeline<DailyLossRule>>("DailyLossRule", orders, linear, &rateLimiter);
+    runPipeline<RiskPipeline<OrderSizeRule>>("OrderSizeRule", orders, linear, &rateLimiter);
+    runPipeline<RiskPipeline<LeverageRule>>("LeverageRule", orders, linear, &rateLimiter);
+    runPipeline<RiskPipeline<MarginRule>>("MarginRule", orders, linear, &rateLimiter);
+    runPipeline<RiskPipeline<GreekLimitRule>>("GreekLimitRule", orders, linear, &rateLimiter);
+    runPipeline<RiskPipeline<RateLimitRule>>("RateLimitRule", orders, linear, &rateLimiter);
+    runPipeline<LinearRiskRules>("LinearRiskRules", orders, linear, &rateLimiter);
+    runPipeline<OptionRiskRules>("OptionRiskRules", orders, riskManager.getRuleLimits(InstrumentClass::Option),
+                                 &rateLimiter);
+
+    // Reserves and hands the exposure straight back, as a cancelled order would
+    run("RiskManager::checkOrder", [&](int i) {
+        const Order& order = orders[i % AMOUNTS];
+        RiskRejection rejection = riskManager.checkOrder(order);
+        if (rejection == RiskRejection::None) {
+            riskManager.adjustExposure(order.instrumentId, order.side, -order.amount);
+        }
+        return rejection;
+    });
+    return 0;
+}
@@ -0,0 +1,49 @@
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// Inline, NUL-terminated string of at most N - 1 characters. Longer input is
+// truncated. Used for exchange identifiers in records that must not allocate.
+template <size_t N>
+class FixedString {
+public:
+    FixedString() { data[0] = '\0'; }
+    FixedString(std::string_view value) { assign(value); }
+
+    void assign(std::string_view value) {
+        size_t length = value.size() < N - 1 ? value.size() : N - 1;
+        std::memcpy(data, value.data(), length);
+        data[length] = '\0';
+    }
+
+    FixedString& operator=(std::string_view value) {
+        assign(value);
+        return *this;
+    }
+
+    void clear() { data[0] = '\0'; }
+    bool empty() const { return data[0] == '\0'; }
+    size_t size() const { return std::strlen(data); }
+    const char* c_str() const { return data; }
+    std::string_view view() const { return std::string_view(data); }
+    std::string str() const { return std::string(data); }
+
+    bool operator==(std::string_view other) const { return view() == other; }
+    bool operator!=(std::string_view other) const { return view() != other; }
+    bool operator==(const FixedString& other) const { return view() == other.view(); }
+    bool operator!=(const FixedString& other) const { return view() != other.view(); }
+
+    friend std::ostream& operator<<(std::ostream& os, const FixedString& value) {
+        return os << value.data;
+    }
+
+private:
+    char data[N];
+};
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef IO_CONTEXT_H
+#define IO_CONTEXT_H
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <thread>
+
+// The process-wide asio io_context for asynchronous REST traffic, run on one
+// dedicated thread from first use until exit. Everything it runs shares that
+// thread, so handlers and coroutines on it must never block.
+class IoContext {
+public:
+    static IoContext& instance() {
+        static IoContext shared;
+        return shared;
+    }
+
+    boost::asio::io_context& context() { return ioContext; }
+    bool isIoThread() const { return std::this_thread::get_id() == thread.get_id(); }
+
+private:
+    boost::asio::io_context ioContext{1};
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work{ioContext.get_executor()};
+    std::thread thread{[this] { ioContext.run(); }};
+
+    IoContext() = default;
+    ~IoContext() {
+        work.reset();
+        ioContext.stop();
+        thread.join();
+    }
+};
+
+#endif
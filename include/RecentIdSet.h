@@ -0,0 +1,45 @@
+#ifndef RECENT_ID_SET_H
+#define RECENT_ID_SET_H
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+// Remembers the most recent `capacity` IDs, evicting the oldest first. Used to
+// drop duplicate exchange events (e.g. trades both streamed and fetched again after a reconnect)
+// without growing without bound. Not thread-safe.
+class RecentIdSet {
+public:
+    explicit RecentIdSet(size_t capacity) : capacity(capacity) {
+        ids.reserve(capacity);
+    }
+
+    // Returns false if the ID was already present
+    bool insert(std::string_view id) {
+        std::string key(id);
+        if (!ids.insert(key).second) {
+            return false;
+        }
+        order.push_back(std::move(key));
+        if (order.size() > capacity) {
+            ids.erase(order.front());
+            order.pop_front();
+        }
+        return true;
+    }
+
+    bool contains(std::string_view id) const {
+        return ids.count(std::string(id)) > 0;
+    }
+
+    size_t size() const { return order.size(); }
+
+private:
+    size_t capacity;
+    std::unordered_set<std::string> ids;
+    std::deque<std::string> order;
+};
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef SEQ_LOCK_H
+#define SEQ_LOCK_H
+
+#include <atomic>
+#include <cstdint>
+
+// Sequence lock for small records of relaxed atomics that must be read as a
+// consistent set. Writers serialize among themselves by spinning on an odd
+// sequence; readers never block and retry if a write overlapped their read.
+// Meant for short, rarely contended writes such as one instrument's position.
+class SeqLock {
+public:
+    void lock() {
+        uint32_t current = sequence.load(std::memory_order_relaxed);
+        while ((current & 1) || !sequence.compare_exchange_weak(current, current + 1, std::memory_order_acquire,
+                                                                 std::memory_order_relaxed)) {
+            current = sequence.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void unlock() { sequence.fetch_add(1, std::memory_order_release); }
+
+    // Usage: do { v = readBegin(); ...loads... } while (readRetry(v));
+    uint32_t readBegin() const {
+        uint32_t current;
+        while ((current = sequence.load(std::memory_order_acquire)) & 1) {
+        }
+        return current;
+    }
+
+    bool readRetry(uint32_t begin) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return sequence.load(std::memory_order_relaxed) != begin;
+    }
+
+private:
+    std::atomic<uint32_t> sequence{0};
+};
+
+#endif
@@ -1,24 +1,148 @@
 #include "AuthManager.h"
-#include "utils/HttpClient.h"
+#include "utils/AsyncHttpClient.h"
 #include <json/json.h>
 #include <iostream>
-#include <chrono>
+#include <sstream>
+#include <algorithm>
+
+namespace {
+// Deribit tokens currently last 900 s; assume that if expires_in is missing
+constexpr std::chrono::seconds DEFAULT_EXPIRES_IN{900};
+}
 
 AuthManager::AuthManager(const std::string& clientId, const std::string& clientSecret, const std::string& apiUrl)
-    : clientId(clientId), clientSecret(clientSecret), apiUrl(apiUrl) {}
+    : clientId(clientId), clientSecret(clientSecret), apiUrl(apiUrl), restClient(std::make_unique<AsyncHttpClient>(apiUrl)) {}
+
+AuthManager::~AuthManager() {
+    stop();
+}
 
 bool AuthManager::authenticate() {
-    return makeAuthRequest("client_credentials");
+    std::lock_guard<std::mutex> lock(authMutex);
+    if (!makeAuthRequest("client_credentials")) {
+        return false;
+    }
+    if (!running) {
+        running = true;
+        refreshThread = std::thread(&AuthManager::refreshLoop, this);
+    }
+    return true;
 }
 
 bool AuthManager::refreshToken() {
-    std::lock_guard<std::mutex> lock(tokenMutex);
-    return makeAuthRequest("refresh_token", refreshToken);
+    std::lock_guard<std::mutex> lock(authMutex);
+    return renewLocked();
+}
+
+bool AuthManager::ensureValidToken() {
+    std::shared_ptr<const Token> token = currentToken();
+    if (token && Clock::now() < token->expiresAt) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(authMutex);
+    // Another caller or the refresher may have renewed it while we waited
+    token = currentToken();
+    if (token && Clock::now() < token->expiresAt) {
+        return true;
+    }
+    return renewLocked();
+}
+
+void AuthManager::stop() {
+    {
+        std::lock_guard<std::mutex> lock(authMutex);
+        if (!running) {
+            return;
+        }
+        running = false;
+    }
+    refreshCV.notify_all();
+    if (refreshThread.joinable()) {
+        refreshThread.join();
+    }
+}
+
+void AuthManager::setRefreshOptions(const RefreshOptions& options) {
+    std::lock_guard<std::mutex> lock(authMutex);
+    refreshOptions = options;
+}
+
+std::shared_ptr<const AuthManager::Token> AuthManager::currentToken() const {
+    return publishedToken.load(std::memory_order_acquire);
 }
 
-std::string AuthManager::getAccessToken() {
-    std::lock_guard<std::mutex> lock(tokenMutex);
-    return accessToken;
+std::string AuthManager::getAccessToken() const {
+    std::shared_ptr<const Token> token = currentToken();
+    return token ? token->accessToken : std::string();
+}
+
+std::string AuthManager::webSocketAuthRequest(int requestId) const {
+    Json::Value request;
+    request["jsonrpc"] = "2.0";
+    request["id"] = requestId;
+    request["method"] = "public/auth";
+    request["params"]["grant_type"] = "client_credentials";
+    request["params"]["client_id"] = clientId;
+    request["params"]["client_secret"] = clientSecret;
+
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "";
+    return Json::writeString(writer, request);
+}
+
+bool AuthManager::renewLocked() {
+    if (!refreshTokenValue.empty() && makeAuthRequest("refresh_token", refreshTokenValue)) {
+        return true;
+    }
+    // Refresh tokens expire too; start over with the client credentials
+    return makeAuthRequest("client_credentials");
+}
+
+void AuthManager::publish(const std::string& accessToken, std::chrono::seconds expiresIn) {
+    auto token = std::make_shared<Token>();
+    token->accessToken = accessToken;
+    token->authorizationHeader = "Bearer " + accessToken;
+    token->expiresAt = Clock::now() + expiresIn;
+
+    // Readers still holding the previous token keep it alive until they drop it
+    publishedToken.store(std::move(token), std::memory_order_release);
+}
+
+AuthManager::Clock::time_point AuthManager::nextRefreshTime(const Token& token) const {
+    auto now = Clock::now();
+    if (token.expiresAt <= now) {
+        return now;
+    }
+    auto lifetime = token.expiresAt - now;
+    auto early = now + std::chrono::duration_cast<Clock::duration>(lifetime * refreshOptions.refreshAtFraction);
+    auto latest = token.expiresAt - refreshOptions.minRefreshMargin;
+    return std::max(now, std::min(early, latest));
+}
+
+void AuthManager::refreshLoop() {
+    std::unique_lock<std::mutex> lock(authMutex);
+    auto retryDelay = refreshOptions.initialRetryDelay;
+
+    while (running) {
+        std::shared_ptr<const Token> token = currentToken();
+        auto refreshAt = token ? nextRefreshTime(*token) : Clock::now();
+        // Wakes early on stop() or when a caller renewed the token first
+        if (refreshCV.wait_until(lock, refreshAt, [this, token]() {
+                return !running || currentToken() != token;
+            })) {
+            continue;
+        }
+
+        if (renewLocked()) {
+            retryDelay = refreshOptions.initialRetryDelay;
+            continue;
+        }
+
+        std::cerr << "Token refresh failed, retrying in " << retryDelay.count() << " ms" << std::endl;
+        refreshCV.wait_for(lock, retryDelay, [this]() { return !running; });
+        retryDelay = std::min(retryDelay * 2, refreshOptions.maxRetryDelay);
+    }
 }
 
 bool AuthManager::makeAuthRequest(const std::string& grantType, const std::string& token) {
@@ -37,14 +161,17 @@ bool AuthManager::makeAuthRequest(const std::string& grantType, const std::strin
     Json::StreamWriterBuilder writer;
     std::string payload = Json::writeString(writer, requestBody);
 
-    HttpClient client;
-    std::string response;
-    try {
-        response = client.post(apiUrl, payload, {{"Content-Type", "application/json"}});
-    } catch (const std::exception& e) {
-        std::cerr << "Error in HTTP request: " << e.what() << std::endl;
+    std::string origin;
+    AsyncHttpClient::Request request;
+    AsyncHttpClient::splitUrl(apiUrl, origin, request.target);
+    request.body = std::move(payload);
+    request.headers = {{"Content-Type", "application/json"}};
+    AsyncHttpClient::Response httpResponse = restClient->post(std::move(request)).get();
+    if (!httpResponse.error.empty()) {
+        std::cerr << "Error in HTTP request: " << httpResponse.error << std::endl;
         return false;
     }
+    const std::string& response = httpResponse.body;
 
     Json::CharReaderBuilder reader;
     Json::Value jsonResponse;
@@ -56,18 +183,23 @@ bool AuthManager::makeAuthRequest(const std::string& grantType, const std::strin
     }
 
     if (jsonResponse.isMember("error")) {
-        std::cerr << "Authentication error: " << jsonResponse["error"].asString() << std::endl;
+        std::cerr << "Authentication error: " << jsonResponse["error"]["message"].asString() << std::endl;
         return false;
     }
 
     if (jsonResponse["result"].isObject()) {
-        accessToken = jsonResponse["result"]["access_token"].asString();
-        if (grantType == "client_credentials") {
-            refreshToken = jsonResponse["result"]["refresh_token"].asString();
+        const Json::Value& result = jsonResponse["result"];
+        std::chrono::seconds expiresIn = result.isMember("expires_in")
+            ? std::chrono::seconds(result["expires_in"].asInt64())
+            : DEFAULT_EXPIRES_IN;
+        // Both grants rotate the refresh token
+        if (result.isMember("refresh_token")) {
+            refreshTokenValue = result["refresh_token"].asString();
         }
+        publish(result["access_token"].asString(), expiresIn);
         return true;
     }
 
     std::cerr << "Unexpected response format." << std::endl;
     return false;
-}
\ No newline at end of file
+}
@@ -3,24 +3,82 @@
 
 #include <string>
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <thread>
+#include <vector>
 
+class AsyncHttpClient;
+
+// Owns the OAuth token lifecycle. After authenticate() succeeds a background
+// thread refreshes the token ahead of its expiry (with retry), so the request
+// paths only read the published token and never wait on auth unless it has
+// actually expired.
 class AuthManager {
 public:
-    AuthManager(const std::string& clientId, const std::string& clientSecret, const std::string& apiUrl);
+    using Clock = std::chrono::steady_clock;
+
+    struct Token {
+        std::string accessToken;
+        std::string authorizationHeader;  // "Bearer <access token>"
+        Clock::time_point expiresAt;
+    };
+
+    struct RefreshOptions {
+        double refreshAtFraction = 0.8;                   // refresh once this much of the lifetime has passed
+        std::chrono::seconds minRefreshMargin{30};        // but never later than this before expiry
+        std::chrono::milliseconds initialRetryDelay{500};
+        std::chrono::milliseconds maxRetryDelay{30000};
+    };
 
+    AuthManager(const std::string& clientId, const std::string& clientSecret,
+                const std::string& apiUrl = "https://test.deribit.com/api/v2/public/auth");
+    ~AuthManager();
+
+    // Obtains the first token and starts the background refresher
     bool authenticate();
+    // Forces a synchronous refresh, falling back to client credentials
     bool refreshToken();
-    std::string getAccessToken();
+    // Returns immediately while the published token is valid; otherwise
+    // refreshes synchronously
+    bool ensureValidToken();
+    void stop();
+
+    // Takes effect from the next scheduled refresh
+    void setRefreshOptions(const RefreshOptions& options);
+
+    // One atomic load, no auth lock. Tokens are immutable once published and
+    // the returned one stays alive for as long as the caller holds it.
+    std::shared_ptr<const Token> currentToken() const;
+    std::string getAccessToken() const;
+    // JSON-RPC public/auth message for authenticating a websocket session,
+    // which cannot reuse the REST bearer token
+    std::string webSocketAuthRequest(int requestId) const;
 
 private:
     const std::string clientId;
     const std::string clientSecret;
     const std::string apiUrl;
-    std::string accessToken;
-    std::string refreshToken;
-    std::mutex tokenMutex;
+    std::unique_ptr<AsyncHttpClient> restClient;  // shared by the refresher and synchronous refreshes
+
+    std::atomic<std::shared_ptr<const Token>> publishedToken;
+
+    // Serializes auth requests and guards refreshTokenValue
+    std::mutex authMutex;
+    std::string refreshTokenValue;
+
+    RefreshOptions refreshOptions;
+    std::condition_variable refreshCV;
+    std::thread refreshThread;
+    bool running = false;
 
     bool makeAuthRequest(const std::string& grantType, const std::string& token = "");
+    bool renewLocked();
+    void publish(const std::string& accessToken, std::chrono::seconds expiresIn);
+    Clock::time_point nextRefreshTime(const Token& token) const;
+    void refreshLoop();
 };
 
 #endif
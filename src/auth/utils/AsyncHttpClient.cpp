@@ -0,0 +1,388 @@
+#include "AsyncHttpClient.h"
+#include "../../../include/IoContext.h"
+#include "../../include/Logger.h"
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/http.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <deque>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <sys/socket.h>
+#include <vector>
+
+namespace asio = boost::asio;
+namespace http = boost::beast::http;
+using tcp = asio::ip::tcp;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Exchange {
+    http::request<http::string_body> message;
+    AsyncHttpClient::Callback done;
+    Clock::time_point deadline;
+};
+
+void complete(Exchange& exchange, AsyncHttpClient::Response& response) {
+    try {
+        exchange.done(response);
+    } catch (const std::exception& e) {
+        Logger::error("HTTP response handler failed: ", e.what());
+    }
+}
+
+void fail(Exchange& exchange, const std::string& error) {
+    AsyncHttpClient::Response response;
+    response.error = error;
+    complete(exchange, response);
+}
+
+} // namespace
+
+// Everything below is touched on the I/O thread only
+struct AsyncHttpClient::State {
+    asio::io_context& context;
+    Options options;
+    asio::ssl::context tls{asio::ssl::context::tls_client};
+    bool secure = true;
+    std::string host;
+    std::string port;
+
+    std::deque<std::shared_ptr<Exchange>> waiting;
+    std::vector<std::shared_ptr<Connection>> connections;
+    bool stopped = false;
+
+    State(asio::io_context& context, const Options& options) : context(context), options(options) {}
+
+    void enqueue(std::shared_ptr<Exchange> exchange);
+    void failWaiting(const std::string& error);
+    void stop();
+};
+
+class AsyncHttpClient::Connection : public std::enable_shared_from_this<Connection> {
+public:
+    explicit Connection(std::shared_ptr<State> state)
+        : state(std::move(state)),
+          resolver(this->state->context),
+          wakeTimer(this->state->context),
+          watchdog(this->state->context) {}
+
+    void start() {
+        asio::co_spawn(state->context, run(), asio::detached);
+    }
+    void wake() { wakeTimer.cancel(); }
+    void shutdown() {
+        wake();
+        close();
+    }
+
+private:
+    std::shared_ptr<State> state;
+    tcp::resolver resolver;
+    std::unique_ptr<asio::ssl::stream<tcp::socket>> tlsStream;
+    std::unique_ptr<tcp::socket> plainSocket;
+    boost::beast::flat_buffer buffer;
+    asio::steady_timer wakeTimer;
+    asio::steady_timer watchdog;
+    uint64_t generation = 0;  // ties a watchdog expiry to the operation it guards
+    bool timedOut = false;
+    bool connected = false;
+
+    tcp::socket& socket() { return tlsStream ? tlsStream->next_layer() : *plainSocket; }
+
+    asio::awaitable<void> run();
+    asio::awaitable<bool> connect(std::string& error);
+    asio::awaitable<void> pipeline(std::vector<std::shared_ptr<Exchange>>& batch);
+    void arm(Clock::time_point deadline);
+    void disarm();
+    bool stillOpen();
+    void close();
+};
+
+void AsyncHttpClient::State::enqueue(std::shared_ptr<Exchange> exchange) {
+    if (stopped) {
+        fail(*exchange, "HTTP client closed");
+        return;
+    }
+    waiting.push_back(std::move(exchange));
+    // Idle connections race for the work; busy ones pick it up after their batch
+    for (auto& connection : connections) {
+        connection->wake();
+    }
+}
+
+void AsyncHttpClient::State::failWaiting(const std::string& error) {
+    std::deque<std::shared_ptr<Exchange>> failed;
+    failed.swap(waiting);
+    for (auto& exchange : failed) {
+        fail(*exchange, error);
+    }
+}
+
+void AsyncHttpClient::State::stop() {
+    stopped = true;
+    for (auto& connection : connections) {
+        connection->shutdown();
+    }
+    // Connections keep the state alive until their coroutines finish
+    connections.clear();
+    failWaiting("HTTP client closed");
+}
+
+asio::awaitable<void> AsyncHttpClient::Connection::run() {
+    auto self = shared_from_this();
+    std::vector<std::shared_ptr<Exchange>> batch;
+    while (!state->stopped) {
+        if (state->waiting.empty()) {
+            boost::system::error_code ignored;
+            wakeTimer.expires_at(Clock::time_point::max());
+            co_await wakeTimer.async_wait(asio::redirect_error(asio::use_awaitable, ignored));
+            continue;
+        }
+
+        // A server may drop a keep-alive connection while it is idle
+        if (!stillOpen()) {
+            std::string error;
+            if (!co_await connect(error)) {
+                // Rather than queueing behind an origin that cannot be reached
+                Logger::warning("Failed to connect to ", state->host, ":", state->port, ": ", error);
+                state->failWaiting(error);
+                continue;
+            }
+        }
+
+        batch.clear();
+        Clock::time_point now = Clock::now();
+        while (batch.size() < state->options.pipelineDepth && !state->waiting.empty()) {
+            std::shared_ptr<Exchange> exchange = std::move(state->waiting.front());
+            state->waiting.pop_front();
+            if (exchange->deadline <= now) {
+                fail(*exchange, "Request timed out before it was sent");
+            } else {
+                batch.push_back(std::move(exchange));
+            }
+        }
+        if (!batch.empty()) {
+            co_await pipeline(batch);
+        }
+    }
+    close();
+}
+
+asio::awaitable<bool> AsyncHttpClient::Connection::connect(std::string& error) {
+    close();
+    buffer.clear();
+    if (state->secure) {
+        tlsStream = std::make_unique<asio::ssl::stream<tcp::socket>>(state->context, state->tls);
+        plainSocket.reset();
+    } else {
+        plainSocket = std::make_unique<tcp::socket>(state->context);
+        tlsStream.reset();
+    }
+
+    arm(Clock::now() + state->options.connectTimeout);
+    try {
+        auto endpoints = co_await resolver.async_resolve(state->host, state->port, asio::use_awaitable);
+        co_await asio::async_connect(socket(), endpoints, asio::use_awaitable);
+        socket().set_option(tcp::no_delay(true));
+        if (tlsStream) {
+            // SNI, which most TLS front ends need to pick the certificate
+            if (!SSL_set_tlsext_host_name(tlsStream->native_handle(), state->host.c_str())) {
+                throw boost::system::system_error(
+                    boost::system::error_code(static_cast<int>(::ERR_get_error()), asio::error::get_ssl_category()));
+            }
+            tlsStream->set_verify_callback(asio::ssl::host_name_verification(state->host));
+            co_await tlsStream->async_handshake(asio::ssl::stream_base::client, asio::use_awaitable);
+        }
+        connected = true;
+    } catch (const boost::system::system_error& e) {
+        error = timedOut ? "Connect timed out" : e.code().message();
+        close();
+    }
+    disarm();
+    co_return connected;
+}
+
+asio::awaitable<void> AsyncHttpClient::Connection::pipeline(std::vector<std::shared_ptr<Exchange>>& batch) {
+    Clock::time_point deadline = Clock::time_point::max();
+    for (auto& exchange : batch) {
+        deadline = std::min(deadline, exchange->deadline);
+    }
+    arm(deadline);
+
+    size_t answered = 0;
+    std::string error;
+    try {
+        // All requests go out before the first response is read
+        for (auto& exchange : batch) {
+            if (tlsStream) {
+                co_await http::async_write(*tlsStream, exchange->message, asio::use_awaitable);
+            } else {
+                co_await http::async_write(*plainSocket, exchange->message, asio::use_awaitable);
+            }
+        }
+        while (answered < batch.size()) {
+            http::response<http::string_body> message;
+            if (tlsStream) {
+                co_await http::async_read(*tlsStream, buffer, message, asio::use_awaitable);
+            } else {
+                co_await http::async_read(*plainSocket, buffer, message, asio::use_awaitable);
+            }
+            bool keepAlive = message.keep_alive();
+            Response response;
+            response.status = static_cast<int>(message.result_int());
+            response.body = std::move(message.body());
+            complete(*batch[answered++], response);
+            if (!keepAlive) {
+                error = "Connection closed by server";
+                break;
+            }
+        }
+    } catch (const boost::system::system_error& e) {
+        error = timedOut ? "Request timed out" : e.code().message();
+    }
+    disarm();
+
+    if (!error.empty()) {
+        close();
+        for (size_t i = answered; i < batch.size(); ++i) {
+            fail(*batch[i], error);
+        }
+    }
+}
+
+void AsyncHttpClient::Connection::arm(Clock::time_point deadline) {
+    timedOut = false;
+    uint64_t armed = ++generation;
+    watchdog.expires_at(deadline);
+    watchdog.async_wait([self = shared_from_this(), armed](const boost::system::error_code& ec) {
+        // Closing the socket aborts whatever the coroutine is waiting on
+        if (!ec && armed == self->generation) {
+            self->timedOut = true;
+            self->close();
+        }
+    });
+}
+
+void AsyncHttpClient::Connection::disarm() {
+    ++generation;
+    watchdog.cancel();
+}
+
+bool AsyncHttpClient::Connection::stillOpen() {
+    if (!connected) {
+        return false;
+    }
+    // Nothing is due on an idle connection: end of stream, a TLS close_notify
+    // or an error all mean the server is done with it
+    char byte;
+    ssize_t peeked = ::recv(socket().native_handle(), &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+    return peeked < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+void AsyncHttpClient::Connection::close() {
+    boost::system::error_code ignored;
+    resolver.cancel();
+    if (tlsStream) {
+        tlsStream->next_layer().close(ignored);
+    }
+    if (plainSocket) {
+        plainSocket->close(ignored);
+    }
+    connected = false;
+}
+
+AsyncHttpClient::AsyncHttpClient(const std::string& origin) : AsyncHttpClient(origin, Options()) {}
+
+AsyncHttpClient::AsyncHttpClient(const std::string& origin, const Options& options)
+    : AsyncHttpClient(IoContext::instance().context(), origin, options) {}
+
+AsyncHttpClient::AsyncHttpClient(asio::io_context& context, const std::string& origin, const Options& options)
+    : state(std::make_shared<State>(context, options)) {
+    std::string authority = origin;
+    if (authority.rfind("https://", 0) == 0) {
+        authority.erase(0, 8);
+    } else if (authority.rfind("http://", 0) == 0) {
+        authority.erase(0, 7);
+        state->secure = false;
+    }
+    authority = authority.substr(0, authority.find('/'));
+    size_t colon = authority.find(':');
+    state->host = authority.substr(0, colon);
+    state->port = colon != std::string::npos ? authority.substr(colon + 1) : (state->secure ? "443" : "80");
+
+    state->tls.set_default_verify_paths();
+    state->tls.set_verify_mode(asio::ssl::verify_peer);
+
+    for (size_t i = 0; i < std::max<size_t>(options.connections, 1); ++i) {
+        state->connections.push_back(std::make_shared<Connection>(state));
+    }
+    asio::post(state->context, [state = state] {
+        for (auto& connection : state->connections) {
+            connection->start();
+        }
+    });
+}
+
+AsyncHttpClient::~AsyncHttpClient() {
+    asio::post(state->context, [state = state] { state->stop(); });
+}
+
+asio::awaitable<AsyncHttpClient::Response> AsyncHttpClient::request(Request request) {
+    co_return co_await asio::async_initiate<decltype(asio::use_awaitable), void(Response)>(
+        [this, &request](auto handler) {
+            // std::function needs a copyable callback
+            auto shared = std::make_shared<decltype(handler)>(std::move(handler));
+            post(std::move(request), [shared](Response& response) { (*shared)(std::move(response)); });
+        },
+        asio::use_awaitable);
+}
+
+void AsyncHttpClient::post(Request request, Callback callback) {
+    auto exchange = std::make_shared<Exchange>();
+    exchange->message.method(http::verb::post);
+    exchange->message.target(request.target);
+    exchange->message.version(11);
+    exchange->message.set(http::field::host, state->host);
+    exchange->message.keep_alive(true);
+    for (const auto& [key, value] : request.headers) {
+        exchange->message.set(key, value);
+    }
+    exchange->message.body() = std::move(request.body);
+    exchange->message.prepare_payload();
+    exchange->done = std::move(callback);
+    exchange->deadline = Clock::now() + (request.timeout.count() > 0 ? request.timeout : state->options.defaultTimeout);
+
+    asio::post(state->context, [state = state, exchange = std::move(exchange)]() mutable {
+        state->enqueue(std::move(exchange));
+    });
+}
+
+std::future<AsyncHttpClient::Response> AsyncHttpClient::post(Request request) {
+    auto promise = std::make_shared<std::promise<Response>>();
+    std::future<Response> result = promise->get_future();
+    post(std::move(request), [promise](Response& response) { promise->set_value(std::move(response)); });
+    return result;
+}
+
+bool AsyncHttpClient::splitUrl(const std::string& url, std::string& origin, std::string& target) {
+    size_t scheme = url.find("://");
+    if (scheme == std::string::npos) {
+        return false;
+    }
+    size_t path = url.find('/', scheme + 3);
+    origin = url.substr(0, path);
+    target = path != std::string::npos ? url.substr(path) : "/";
+    return true;
+}
@@ -0,0 +1,75 @@
+#ifndef ASYNC_HTTP_CLIENT_H
+#define ASYNC_HTTP_CLIENT_H
+
+// Boost 1.74's awaitable.hpp uses std::exchange without including <utility>
+#include <utility>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/io_context.hpp>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+
+// HTTP/1.1 client for one origin such as https://test.deribit.com, built on
+// asio and C++20 coroutines. Requests are queued to a few keep-alive
+// connections; each writes up to pipelineDepth of them back to back and then
+// reads the responses in order, so once connected a request costs neither a
+// handshake nor a round trip of its own. No calling thread is blocked:
+// coroutines co_await request(), other threads pass a callback or take a
+// future. I/O and callbacks run on the io_context's thread.
+//
+// Requests written to a connection that fails or times out fail with it and
+// are never sent again, since the exchange may already have acted on them.
+class AsyncHttpClient {
+public:
+    struct Options {
+        size_t connections = 2;
+        size_t pipelineDepth = 8;
+        std::chrono::milliseconds connectTimeout{5000};
+        std::chrono::milliseconds defaultTimeout{5000};
+    };
+
+    // Requests are POSTs, like HttpClient's
+    struct Request {
+        std::string target;  // path and query, e.g. /api/v2/private/buy
+        std::string body;
+        std::map<std::string, std::string> headers;
+        std::chrono::milliseconds timeout{0};  // 0 uses Options::defaultTimeout
+    };
+
+    struct Response {
+        int status = 0;  // 0 when no response arrived
+        std::string body;
+        std::string error;
+    };
+
+    using Callback = std::function<void(Response&)>;
+
+    // Runs on the shared IoContext
+    explicit AsyncHttpClient(const std::string& origin);
+    AsyncHttpClient(const std::string& origin, const Options& options);
+    AsyncHttpClient(boost::asio::io_context& context, const std::string& origin, const Options& options);
+    // Closes the connections without waiting; requests not yet answered fail
+    ~AsyncHttpClient();
+
+    AsyncHttpClient(const AsyncHttpClient&) = delete;
+    AsyncHttpClient& operator=(const AsyncHttpClient&) = delete;
+
+    // For coroutines on the client's io_context
+    boost::asio::awaitable<Response> request(Request request);
+    // From any thread; the callback runs on the I/O thread and must not block
+    void post(Request request, Callback callback);
+    std::future<Response> post(Request request);
+
+    // Splits e.g. https://test.deribit.com/api/v2/public/auth into its origin and target
+    static bool splitUrl(const std::string& url, std::string& origin, std::string& target);
+
+private:
+    struct State;
+    class Connection;
+    std::shared_ptr<State> state;
+};
+
+#endif
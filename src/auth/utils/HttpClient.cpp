@@ -8,7 +8,12 @@ static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* use
 }
 
 std::string HttpClient::post(const std::string& url, const std::string& body, 
-                             const std::map<std::string, std::string>& headers) {
+                             const std::map<std::string, std::string>& headers, long timeoutMs) {
+    return post(url, body.data(), body.size(), headers, timeoutMs);
+}
+
+std::string HttpClient::post(const std::string& url, const char* body, size_t length,
+                             const std::map<std::string, std::string>& headers, long timeoutMs) {
     CURL* curl;
     CURLcode res;
     std::string response;
@@ -22,10 +27,16 @@ std::string HttpClient::post(const std::string& url, const std::string& body,
 
         curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
         curl_easy_setopt(curl, CURLOPT_POST, 1L);
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(length));
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body);
         curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerList);
         curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
         curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+        if (timeoutMs > 0) {
+            // Signals cannot be used for timeouts from multiple threads
+            curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+            curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeoutMs);
+        }
 
         res = curl_easy_perform(curl);
         curl_easy_cleanup(curl);
@@ -6,7 +6,12 @@
 
 class HttpClient {
 public:
-    std::string post(const std::string& url, const std::string& body, const std::map<std::string, std::string>& headers);
+    // timeoutMs of 0 waits indefinitely
+    std::string post(const std::string& url, const std::string& body, const std::map<std::string, std::string>& headers,
+                     long timeoutMs = 0);
+    // Sends the body without copying it into a std::string
+    std::string post(const std::string& url, const char* body, size_t length,
+                     const std::map<std::string, std::string>& headers, long timeoutMs = 0);
 };
 
 #endif
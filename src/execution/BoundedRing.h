@@ -0,0 +1,119 @@
+// execution/BoundedRing.h
+#ifndef BOUNDED_RING_H
+#define BOUNDED_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+enum class RingConsumers { Single, Multiple };
+
+// Bounded multi-producer ring (Vyukov's sequence-per-slot scheme). All slots
+// are allocated up front; producers claim a slot with one CAS on the tail and
+// publish it through the slot sequence, so no side takes a lock. With a
+// single consumer the head is advanced with a plain store; with several
+// (work stealing) consumers claim a slot with a CAS on the head the same way
+// producers do. Capacity is rounded up to a power of two.
+template <typename T, RingConsumers Consumers>
+class BoundedRing {
+public:
+    explicit BoundedRing(size_t requestedCapacity)
+        : capacity(roundUp(requestedCapacity)),
+          mask(capacity - 1),
+          slots(std::make_unique<Slot[]>(capacity)) {
+        for (size_t i = 0; i < capacity; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedRing(const BoundedRing&) = delete;
+    BoundedRing& operator=(const BoundedRing&) = delete;
+
+    // Returns false when the ring is full
+    bool tryPush(const T& value) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        Slot* slot;
+        if (!claim(tail, position, 0, slot)) {
+            return false;
+        }
+        slot->value = value;
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false when the ring is empty. From one thread at a time unless
+    // Consumers is Multiple.
+    bool tryPop(T& value) {
+        size_t position = head.load(std::memory_order_relaxed);
+        Slot* slot;
+        if (!claim(head, position, 1, slot)) {
+            return false;
+        }
+        value = slot->value;
+        slot->sequence.store(position + capacity, std::memory_order_release);
+        return true;
+    }
+
+    // Both are approximate while other threads are active
+    bool empty() const { return size() == 0; }
+
+    size_t size() const {
+        size_t produced = tail.load(std::memory_order_acquire);
+        size_t consumed = head.load(std::memory_order_acquire);
+        return produced > consumed ? produced - consumed : 0;
+    }
+
+    size_t getCapacity() const { return capacity; }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t roundUp(size_t value) {
+        size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    // Claims the slot at counter, which is ready once its sequence equals
+    // position + lag: 0 for producers, 1 for consumers
+    bool claim(std::atomic<size_t>& counter, size_t& position, size_t lag, Slot*& slot) {
+        while (true) {
+            slot = &slots[position & mask];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + lag);
+            if (difference == 0) {
+                if (lag == 1 && Consumers == RingConsumers::Single) {
+                    // The only consumer owns the head
+                    counter.store(position + 1, std::memory_order_relaxed);
+                    return true;
+                }
+                if (counter.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = counter.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    const size_t capacity;
+    const size_t mask;
+    std::unique_ptr<Slot[]> slots;
+    alignas(64) std::atomic<size_t> tail{0};
+    alignas(64) std::atomic<size_t> head{0};
+};
+
+template <typename T>
+using MpscRing = BoundedRing<T, RingConsumers::Single>;
+template <typename T>
+using MpmcRing = BoundedRing<T, RingConsumers::Multiple>;
+
+#endif
@@ -0,0 +1,49 @@
+// execution/ExecutionBackend.h
+#ifndef EXECUTION_BACKEND_H
+#define EXECUTION_BACKEND_H
+
+#include "../orders/models/order.h"
+#include <functional>
+
+// Where execution workers send orders. The live backend talks to the exchange;
+// a simulated one can be swapped in without touching the callers. place and
+// cancel block for the round trip and leave the acknowledged state in the
+// order. The async variants return once the request is sent and run the
+// completion when that state is in the order; execution workers use those so
+// they never wait on the exchange.
+class ExecutionBackend {
+public:
+    // (order state after the fill, fill amount, fill price)
+    using FillCallback = std::function<void(const Order&, double, double)>;
+    // Runs once, on whichever thread received the answer; must not block
+    using Completion = std::function<void()>;
+
+    virtual ~ExecutionBackend() = default;
+
+    virtual void place(Order& order) = 0;
+    // Leaves the order unchanged if the cancel is rejected
+    virtual void cancel(Order& order) = 0;
+    // The order must stay alive and untouched until the completion runs. By
+    // default they call the blocking variant and complete inline, which suits
+    // backends that answer locally.
+    virtual void placeAsync(Order& order, Completion done) {
+        place(order);
+        done();
+    }
+    virtual void cancelAsync(Order& order, Completion done) {
+        cancel(order);
+        done();
+    }
+    // Amends price and amount in place; returns false if unsupported or
+    // rejected, so the caller can fall back to cancel-and-replace
+    virtual bool amend(Order& order, double amount, double price) {
+        (void)order; (void)amount; (void)price;
+        return false;
+    }
+
+    // For fills that arrive after the acknowledgement, e.g. on resting orders.
+    // Backends whose fills come from elsewhere (the live FillFeed) ignore it.
+    virtual void setFillCallback(FillCallback callback) { (void)callback; }
+};
+
+#endif
@@ -1,143 +1,323 @@
 #include "ExecutionManager.h"
 #include "../include/Logger.h"
-#include "utils/HttpClient.h"
-#include <json/json.h>
+#include "RestExecutionBackend.h"
+#include "ThreadTuning.h"
+#include <algorithm>
 #include <chrono>
 
-ExecutionManager::ExecutionManager(AuthManager& authManager) : running(false), authManager(authManager) {}
+namespace {
+int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+ExecutionManager::ExecutionManager(AuthManager& authManager, OrderPool& orderPool)
+    : authManager(authManager), orderPool(orderPool),
+      running(false), backend(std::make_shared<RestExecutionBackend>(authManager)) {
+    createWorkers();
+}
 
 ExecutionManager::~ExecutionManager() {
     stop();
 }
 
+void ExecutionManager::createWorkers() {
+    workers.clear();
+    size_t count = std::max<size_t>(options.workerThreads, 1);
+    workers.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        workers.push_back(std::make_unique<Worker>(i, options.queueCapacity));
+    }
+}
+
+void ExecutionManager::setOptions(const Options& newOptions) {
+    if (running) {
+        Logger::warning("Execution options can only be changed while stopped");
+        return;
+    }
+    for (const auto& worker : workers) {
+        if (!worker->orderedQueue.empty() || !worker->stealableQueue.empty()) {
+            Logger::warning("Execution options not changed: requests are still queued");
+            return;
+        }
+    }
+    options = newOptions;
+    createWorkers();
+}
+
+void ExecutionManager::setBackend(std::shared_ptr<ExecutionBackend> newBackend) {
+    if (running) {
+        Logger::warning("Execution backend can only be changed while stopped");
+        return;
+    }
+    backend = newBackend ? std::move(newBackend) : std::make_shared<RestExecutionBackend>(authManager);
+    backend->setFillCallback(fillCallback);
+}
+
 void ExecutionManager::start() {
+    if (running) {
+        return;
+    }
     running = true;
-    executionThread = std::thread(&ExecutionManager::executionLoop, this);
-    Logger::info("Execution manager started");
+    for (auto& worker : workers) {
+        worker->thread = std::thread(&ExecutionManager::workerLoop, this, std::ref(*worker));
+    }
+    Logger::info("Execution manager started with ", workers.size(), " workers");
 }
 
 void ExecutionManager::stop() {
     if (running) {
         running = false;
-        queueCV.notify_one();
-        if (executionThread.joinable()) {
-            executionThread.join();
+        for (auto& worker : workers) {
+            {
+                std::lock_guard<std::mutex> lock(worker->parkMutex);
+                worker->parked.store(false);
+            }
+            worker->parkCV.notify_one();
+        }
+        for (auto& worker : workers) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+        // Answers still on the way report into this manager
+        {
+            std::unique_lock<std::mutex> lock(drainMutex);
+            drainCV.wait(lock, [this]() { return inFlight.load(std::memory_order_acquire) == 0; });
         }
-        Logger::info("Execution manager stopped");
+
+        QueueLatencyStats stats = getQueueLatencyStats();
+        Logger::info("Execution manager stopped; queue latency over ", stats.count, " requests: mean ",
+                     stats.meanMicros, " us, p99 ", stats.p99Micros, " us, max ", stats.maxMicros, " us");
+    }
+}
+
+bool ExecutionManager::addOrder(OrderHandle handle) {
+    Worker& worker = *workers[orderPool.get(handle).instrumentId % workers.size()];
+    if (!enqueue(worker, true, {handle, Action::Place, steadyNowNs()})) {
+        Logger::warning("Execution shard ", worker.index, " full, order not queued: ", handle);
+        return false;
     }
+    return true;
 }
 
-void ExecutionManager::addOrder(Order& order) {
+bool ExecutionManager::addCancel(OrderHandle handle) {
+    size_t index = nextStealableWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+    if (!enqueue(*workers[index], false, {handle, Action::Cancel, steadyNowNs()})) {
+        Logger::warning("Execution queue full, cancel not queued: ", handle);
+        return false;
+    }
+    return true;
+}
+
+void ExecutionManager::halt() {
+    // Workers only park with empty queues, so there is nobody to wake
+    halted.store(true, std::memory_order_release);
+}
+
+void ExecutionManager::resume() {
+    halted.store(false, std::memory_order_release);
+}
+
+bool ExecutionManager::enqueue(Worker& worker, bool ordered, const QueuedOrder& queued) {
+    bool pushed = ordered ? worker.orderedQueue.tryPush(queued) : worker.stealableQueue.tryPush(queued);
+    if (!pushed) {
+        return false;
+    }
+
+    // Pairs with the fence in park(): either the worker sees the new entry
+    // before sleeping or we see its parked flag here
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (worker.parked.load(std::memory_order_relaxed)) {
+        wake(worker);
+    } else if (!ordered) {
+        // The owner is busy; hand stealable work to a sleeping worker instead
+        for (auto& other : workers) {
+            if (other->parked.load(std::memory_order_relaxed)) {
+                wake(*other);
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+void ExecutionManager::wake(Worker& worker) {
     {
-        std::lock_guard<std::mutex> lock(queueMutex);
-        orderQueue.push(order);
+        std::lock_guard<std::mutex> lock(worker.parkMutex);
+        worker.parked.store(false, std::memory_order_relaxed);
     }
-    queueCV.notify_one();
-    Logger::info("Order added to execution queue: ", order.orderId);
+    worker.parkCV.notify_one();
 }
 
 void ExecutionManager::setFillCallback(FillCallback callback) {
     fillCallback = callback;
+    backend->setFillCallback(fillCallback);
 }
 
-void ExecutionManager::executionLoop() {
-    while (running) {
-        std::unique_lock<std::mutex> lock(queueMutex);
-        queueCV.wait(lock, [this]() {
-            return !orderQueue.empty() || !running;
-        });
-
-        if (!running) break;
+void ExecutionManager::setExecutionReportCallback(ExecutionReportCallback callback) {
+    executionReportCallback = callback;
+}
 
-        while (!orderQueue.empty()) {
-            Order order = orderQueue.front();
-            orderQueue.pop();
-            lock.unlock();
+void ExecutionManager::workerLoop(Worker& worker) {
+    if (worker.index < options.cpuAffinity.size() && !pinCurrentThread(options.cpuAffinity[worker.index])) {
+        Logger::warning("Failed to pin execution worker ", worker.index, " to CPU ", options.cpuAffinity[worker.index]);
+    }
 
-            handleExecution(order);
+    QueuedOrder queued;
+    while (waitForOrder(worker, queued)) {
+        recordQueueLatency(worker, steadyNowNs() - queued.enqueuedNs);
 
-            lock.lock();
+        OrderHandle handle = queued.handle;
+        Order& order = orderPool.get(handle);
+        inFlight.fetch_add(1, std::memory_order_relaxed);
+        if (queued.action == Action::Cancel) {
+            backend->cancelAsync(order, [this, handle]() { report(handle); });
+        } else if (halted.load(std::memory_order_acquire)) {
+            order.status = OrderStatus::Rejected;
+            order.rejectionReason = RejectReason::Halted;
+            report(handle);
+        } else {
+            backend->placeAsync(order, [this, handle]() { onPlaced(handle); });
         }
     }
 }
 
-void ExecutionManager::handleExecution(Order& order) {
-    try {
-        auto start = std::chrono::high_resolution_clock::now(); // Start time
-        // Prepare API request for placing the order
-        std::string endpoint = "private/" + order.side;
-        Json::Value request;
-        request["jsonrpc"] = "2.0";
-        request["id"] = 1;
-        request["method"] = endpoint;
+void ExecutionManager::onPlaced(OrderHandle handle) {
+    // The halt landed while the request was out
+    Order& order = orderPool.get(handle);
+    if (halted.load(std::memory_order_acquire) && !isTerminal(order.status) && !order.orderId.empty()) {
+        backend->cancelAsync(order, [this, handle]() { report(handle); });
+        return;
+    }
+    report(handle);
+}
+
+void ExecutionManager::report(OrderHandle handle) {
+    if (executionReportCallback) {
+        executionReportCallback(handle);
+    } else {
+        orderPool.release(handle);
+    }
+    if (inFlight.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(drainMutex);
+        drainCV.notify_all();
+    }
+}
 
-        Json::Value params;
-        params["instrument_name"] = order.instrumentName;
-        params["amount"] = order.amount;
-        params["type"] = order.type;
-        if (order.type == "limit") {
-            params["price"] = order.price;
-        }
-        request["params"] = params;
-
-        // Convert JSON to string
-        Json::StreamWriterBuilder writer;
-        std::string payload = Json::writeString(writer, request);
-
-        // Send the request using HttpClient
-        HttpClient client;
-        std::string response = client.post("https://test.deribit.com/api/v2/" + endpoint, payload, {
-            {"Authorization", "Bearer " + authManager.getAccessToken()},
-            {"Content-Type", "application/json"}
-        });
-
-        // Parse the response
-        Json::CharReaderBuilder reader;
-        Json::Value jsonResponse;
-        std::string errs;
-        std::istringstream responseStream(response);
-        if (!Json::parseFromStream(reader, responseStream, &jsonResponse, &errs)) {
-            Logger::error("Failed to parse order response: ", errs);
-            order.status = "failed";
-            return;
+bool ExecutionManager::tryTakeWork(Worker& worker, QueuedOrder& queued) {
+    // Own shard first so ordered work is never starved by stealing
+    if (worker.orderedQueue.tryPop(queued) || worker.stealableQueue.tryPop(queued)) {
+        return true;
+    }
+    for (size_t offset = 1; offset < workers.size(); ++offset) {
+        Worker& victim = *workers[(worker.index + offset) % workers.size()];
+        if (victim.stealableQueue.tryPop(queued)) {
+            return true;
         }
+    }
+    return false;
+}
 
-        // Update order status based on response
-        updateOrderStatus(order, jsonResponse);
+bool ExecutionManager::waitForOrder(Worker& worker, QueuedOrder& queued) {
+    uint32_t spins = 0;
+    while (true) {
+        if (tryTakeWork(worker, queued)) {
+            return true;
+        }
+        if (!running.load(std::memory_order_acquire)) {
+            // Drain what was accepted before stop() so no pool slot leaks
+            return tryTakeWork(worker, queued);
+        }
 
-        // Process fills if the order was filled
-        if (order.status == "filled" || order.status == "partially_filled") {
-            double filledAmount = order.side == "buy" ? order.filledAmount : -order.filledAmount;
-            riskManager->updatePosition(order.instrumentName, filledAmount, order.averageFilledPrice);
+        switch (options.waitStrategy) {
+            case WaitStrategy::BusyPoll:
+                cpuRelax();
+                continue;
+            case WaitStrategy::SpinThenPark:
+                if (spins++ < options.spinIterations) {
+                    cpuRelax();
+                    continue;
+                }
+                break;
+            case WaitStrategy::Block:
+                break;
         }
 
-        auto end = std::chrono::high_resolution_clock::now(); // End time
-        std::chrono::duration<double, std::milli> latency = end - start;
-        Logger::info("Order placement latency: ", latency.count(), " ms");
+        park(worker);
+        spins = 0;
+    }
+}
+
+void ExecutionManager::park(Worker& worker) {
+    std::unique_lock<std::mutex> lock(worker.parkMutex);
+    worker.parked.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
 
+    bool hasWork = !worker.orderedQueue.empty();
+    for (size_t i = 0; i < workers.size() && !hasWork; ++i) {
+        hasWork = !workers[i]->stealableQueue.empty();
     }
-    catch (const std::exception& e) {
-        Logger::error("Error executing order ", order.orderId, ": ", e.what());
-        order.status = "failed";
+    if (hasWork || !running.load(std::memory_order_acquire)) {
+        worker.parked.store(false, std::memory_order_relaxed);
+        return;
     }
+
+    worker.parkCV.wait(lock, [this, &worker]() {
+        return !worker.parked.load(std::memory_order_relaxed) || !running.load(std::memory_order_acquire);
+    });
+    worker.parked.store(false, std::memory_order_relaxed);
 }
 
-void ExecutionManager::processFills() {
-    std::lock_guard<std::mutex> lock(queueMutex);
-    
-    while (!fillQueue.empty()) {
-        Fill& fill = fillQueue.front();
-        
-        if (fillCallback) {
-            Order filledOrder;
-            filledOrder.orderId = fill.orderId;
-            filledOrder.status = "filled";
-            filledOrder.filledAmount = fill.amount;
-            filledOrder.averageFilledPrice = fill.price;
-            
-            fillCallback(filledOrder, fill.amount, fill.price);
+void ExecutionManager::recordQueueLatency(Worker& worker, int64_t latencyNs) {
+    uint64_t latency = latencyNs > 0 ? static_cast<uint64_t>(latencyNs) : 0;
+    size_t bucket = 0;
+    while (bucket + 1 < LATENCY_BUCKETS && (uint64_t(1) << bucket) <= latency) {
+        ++bucket;
+    }
+
+    // Single writer per worker, so relaxed load/store pairs are enough
+    worker.latencyHistogram[bucket].fetch_add(1, std::memory_order_relaxed);
+    worker.latencySumNs.fetch_add(latency, std::memory_order_relaxed);
+    if (latency > worker.latencyMaxNs.load(std::memory_order_relaxed)) {
+        worker.latencyMaxNs.store(latency, std::memory_order_relaxed);
+    }
+    worker.latencyCount.fetch_add(1, std::memory_order_release);
+}
+
+ExecutionManager::QueueLatencyStats ExecutionManager::getQueueLatencyStats() const {
+    QueueLatencyStats stats{};
+    uint64_t sumNs = 0;
+    uint64_t maxNs = 0;
+    std::array<uint64_t, LATENCY_BUCKETS> histogram{};
+    for (const auto& worker : workers) {
+        stats.count += worker->latencyCount.load(std::memory_order_acquire);
+        sumNs += worker->latencySumNs.load(std::memory_order_relaxed);
+        maxNs = std::max(maxNs, worker->latencyMaxNs.load(std::memory_order_relaxed));
+        for (size_t bucket = 0; bucket < LATENCY_BUCKETS; ++bucket) {
+            histogram[bucket] += worker->latencyHistogram[bucket].load(std::memory_order_relaxed);
+        }
+    }
+    if (stats.count == 0) {
+        return stats;
+    }
+    stats.meanMicros = sumNs / 1000.0 / stats.count;
+    stats.maxMicros = maxNs / 1000.0;
+
+    uint64_t seen = 0;
+    uint64_t p50Rank = (stats.count + 1) / 2;
+    uint64_t p99Rank = (stats.count * 99 + 99) / 100;
+    for (size_t bucket = 0; bucket < LATENCY_BUCKETS; ++bucket) {
+        uint64_t previous = seen;
+        seen += histogram[bucket];
+        double upperMicros = static_cast<double>(uint64_t(1) << bucket) / 1000.0;
+        if (previous < p50Rank && seen >= p50Rank) {
+            stats.p50Micros = upperMicros;
+        }
+        if (previous < p99Rank && seen >= p99Rank) {
+            stats.p99Micros = upperMicros;
         }
-        
-        fillQueue.pop();
     }
-}
\ No newline at end of file
+    return stats;
+}
@@ -1,45 +1,141 @@
 #ifndef EXECUTION_MANAGER_H
 #define EXECUTION_MANAGER_H
 
-#include "../orders/models/Order.h"
+#include "../orders/models/order.h"
+#include "../orders/models/OrderPool.h"
 #include "../auth/AuthManager.h"
-#include <queue>
+#include "ExecutionBackend.h"
+#include "BoundedRing.h"
+#include <array>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
 #include <functional>
 #include <thread>
 #include <atomic>
 
 class ExecutionManager {
 public:
-    using FillCallback = std::function<void(const Order&, double, double)>;
+    // For backends that generate fills locally; live fills arrive through FillFeed
+    using FillCallback = ExecutionBackend::FillCallback;
+    // Invoked once the exchange has answered for a queued order, on the thread
+    // that received the answer (the REST client's I/O thread for the live
+    // backend); the receiver takes ownership of the pool slot and must not block.
+    using ExecutionReportCallback = std::function<void(OrderHandle)>;
 
-    ExecutionManager(AuthManager& authManager);
+    enum class WaitStrategy {
+        Block,         // park on a condition variable whenever the queues are empty
+        SpinThenPark,  // spin for spinIterations, then park
+        BusyPoll       // never sleep; pair with cpuAffinity on isolated cores
+    };
+
+    struct Options {
+        size_t workerThreads = 4;
+        size_t queueCapacity = 4096;  // per worker, for each of its two queues
+        WaitStrategy waitStrategy = WaitStrategy::SpinThenPark;
+        uint32_t spinIterations = 20000;
+        std::vector<int> cpuAffinity;  // worker i is pinned to cpuAffinity[i] when present
+    };
+
+    // Time from enqueue to a worker picking the request up, over all workers
+    struct QueueLatencyStats {
+        uint64_t count;
+        double meanMicros;
+        double p50Micros;  // percentiles are power-of-two bucket upper bounds
+        double p99Micros;
+        double maxMicros;
+    };
+
+    ExecutionManager(AuthManager& authManager, OrderPool& orderPool);
     ~ExecutionManager();
 
+    // Takes effect on the next start()
+    void setOptions(const Options& options);
+    // Replaces the default REST backend; only while stopped
+    void setBackend(std::shared_ptr<ExecutionBackend> backend);
     void start();
     void stop();
-    void addOrder(Order& order);
+
+    // Places are sharded by instrument onto one worker each, so requests for an
+    // instrument are sent in the order they were queued while instruments run in
+    // parallel. Workers send without waiting for the answer, which completes
+    // through the execution report callback. Returns false when the shard is
+    // full; the caller keeps the slot.
+    bool addOrder(OrderHandle handle);
+    // Cancels of acknowledged orders carry no ordering constraint, so any idle
+    // worker may steal them. Same ownership rules as addOrder.
+    bool addCancel(OrderHandle handle);
+
+    // While halted, workers reject every placement they take, queued or new,
+    // without sending it; cancels still go out. A placement that was already
+    // on the wire is cancelled as soon as it comes back resting.
+    void halt();
+    void resume();
+    bool isHalted() const { return halted.load(std::memory_order_relaxed); }
+
+    QueueLatencyStats getQueueLatencyStats() const;
     void setFillCallback(FillCallback callback);
+    void setExecutionReportCallback(ExecutionReportCallback callback);
 
 private:
     AuthManager& authManager;
-    struct Fill {
-        std::string orderId;
-        double price;
-        double amount;
-        std::chrono::system_clock::time_point timestamp;
+    OrderPool& orderPool;
+    enum class Action : uint8_t { Place, Cancel };
+
+    struct QueuedOrder {
+        OrderHandle handle;
+        Action action;
+        int64_t enqueuedNs;
+    };
+
+    static constexpr size_t LATENCY_BUCKETS = 40;  // bucket i holds latencies below 2^i ns
+
+    struct Worker {
+        Worker(size_t index, size_t queueCapacity)
+            : index(index), orderedQueue(queueCapacity), stealableQueue(queueCapacity) {}
+
+        const size_t index;
+        MpscRing<QueuedOrder> orderedQueue;     // this worker's instrument shard
+        MpmcRing<QueuedOrder> stealableQueue;   // drained by whichever worker is idle
+        std::thread thread;
+
+        // Only touched when the worker parks, never on the busy-poll path
+        std::atomic<bool> parked{false};
+        std::mutex parkMutex;
+        std::condition_variable parkCV;
+
+        // Written by this worker only
+        std::atomic<uint64_t> latencyCount{0};
+        std::atomic<uint64_t> latencySumNs{0};
+        std::atomic<uint64_t> latencyMaxNs{0};
+        std::array<std::atomic<uint64_t>, LATENCY_BUCKETS> latencyHistogram{};
     };
 
-    std::queue<Order> orderQueue;
-    std::queue<Fill> fillQueue;
-    std::mutex queueMutex;
-    std::condition_variable queueCV;
+    Options options;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<size_t> nextStealableWorker{0};
+
     std::atomic<bool> running;
-    std::thread executionThread;
+    std::atomic<bool> halted{false};
+    // Requests sent but not yet reported; stop() waits for them to drain
+    std::atomic<size_t> inFlight{0};
+    std::mutex drainMutex;
+    std::condition_variable drainCV;
+    std::shared_ptr<ExecutionBackend> backend;
     FillCallback fillCallback;
+    ExecutionReportCallback executionReportCallback;
 
-    void executionLoop();
-    void processFills();
-    void handleExecution(Order& order);
+    void createWorkers();
+    bool enqueue(Worker& worker, bool ordered, const QueuedOrder& queued);
+    void wake(Worker& worker);
+    void workerLoop(Worker& worker);
+    void onPlaced(OrderHandle handle);
+    void report(OrderHandle handle);
+    bool waitForOrder(Worker& worker, QueuedOrder& queued);
+    bool tryTakeWork(Worker& worker, QueuedOrder& queued);
+    void park(Worker& worker);
+    static void recordQueueLatency(Worker& worker, int64_t latencyNs);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,287 @@
+#include "FillFeed.h"
+#include "../include/Logger.h"
+#include <websocketpp/config/asio_tls_client.hpp>
+#include <websocketpp/client.hpp>
+#include <algorithm>
+#include <sstream>
+
+namespace {
+using Client = websocketpp::client<websocketpp::config::asio_tls_client>;
+
+constexpr int AUTH_REQUEST_ID = 1;
+constexpr int SUBSCRIBE_REQUEST_ID = 2;
+constexpr int CANCEL_ALL_REQUEST_ID = 3;
+// Plus the index into backfillCurrencies
+constexpr int BACKFILL_REQUEST_ID = 100;
+constexpr int BACKFILL_PAGE_SIZE = 1000;
+constexpr std::chrono::milliseconds INITIAL_RECONNECT_DELAY{500};
+constexpr std::chrono::milliseconds MAX_RECONNECT_DELAY{30000};
+
+std::string subscribeRequest() {
+    return R"({"jsonrpc":"2.0","id":)" + std::to_string(SUBSCRIBE_REQUEST_ID) +
+           R"(,"method":"private/subscribe","params":{"channels":)"
+           R"(["user.trades.any.any.raw","user.orders.any.any.raw"]}})";
+}
+
+const std::string CANCEL_ALL_REQUEST =
+    R"({"jsonrpc":"2.0","id":)" + std::to_string(CANCEL_ALL_REQUEST_ID) + R"(,"method":"private/cancel_all","params":{}})";
+}
+
+FillFeed::FillFeed(AuthManager& authManager, const std::string& url)
+    : authManager(authManager), url(url) {}
+
+FillFeed::~FillFeed() {
+    stop();
+}
+
+void FillFeed::setFillCallback(FillCallback callback) {
+    fillCallback = callback;
+}
+
+void FillFeed::setOrderUpdateCallback(OrderUpdateCallback callback) {
+    orderUpdateCallback = callback;
+}
+
+void FillFeed::setBackfillCurrencies(std::vector<std::string> currencies) {
+    backfillCurrencies = std::move(currencies);
+}
+
+void FillFeed::start() {
+    if (running.exchange(true)) {
+        return;
+    }
+    // Trades before this are covered by the recovery reconciliation
+    lastTradeTimestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    feedThread = std::thread(&FillFeed::run, this);
+    Logger::info("Fill feed started");
+}
+
+void FillFeed::stop() {
+    {
+        std::lock_guard<std::mutex> lock(stopMutex);
+        if (!running.exchange(false)) {
+            return;
+        }
+        if (stopClient) {
+            stopClient();
+        }
+    }
+    stopCV.notify_all();
+    if (feedThread.joinable()) {
+        feedThread.join();
+    }
+    Logger::info("Fill feed stopped");
+}
+
+bool FillFeed::cancelAll() {
+    std::lock_guard<std::mutex> lock(stopMutex);
+    if (!subscribed || !sendOnSession) {
+        return false;
+    }
+    return sendOnSession(CANCEL_ALL_REQUEST);
+}
+
+void FillFeed::run() {
+    auto reconnectDelay = INITIAL_RECONNECT_DELAY;
+
+    while (running) {
+        Client client;
+        try {
+            client.clear_access_channels(websocketpp::log::alevel::all);
+            client.init_asio();
+            client.set_tls_init_handler([](websocketpp::connection_hdl) {
+                return websocketpp::lib::make_shared<boost::asio::ssl::context>(boost::asio::ssl::context::tlsv12_client);
+            });
+            client.set_open_handler([this, &client](websocketpp::connection_hdl hdl) {
+                // Private channels need the session itself to be authenticated
+                client.send(hdl, authManager.webSocketAuthRequest(AUTH_REQUEST_ID), websocketpp::frame::opcode::text);
+            });
+            client.set_message_handler([this, &client](websocketpp::connection_hdl hdl, Client::message_ptr msg) {
+                std::vector<std::string> replies;
+                handleMessage(msg->get_payload(), replies);
+                for (const std::string& reply : replies) {
+                    client.send(hdl, reply, websocketpp::frame::opcode::text);
+                }
+            });
+
+            websocketpp::lib::error_code ec;
+            Client::connection_ptr connection = client.get_connection(url, ec);
+            if (ec) {
+                Logger::error("Fill feed connection error: ", ec.message());
+            } else {
+                {
+                    std::lock_guard<std::mutex> lock(stopMutex);
+                    if (!running) break;
+                    stopClient = [&client]() { client.stop(); };
+                    sendOnSession = [connection](const std::string& payload) {
+                        return !connection->send(payload.data(), payload.size(), websocketpp::frame::opcode::text);
+                    };
+                }
+                client.connect(connection);
+                client.run();
+            }
+        } catch (const std::exception& e) {
+            Logger::error("Error in fill feed: ", e.what());
+        }
+
+        std::unique_lock<std::mutex> lock(stopMutex);
+        stopClient = nullptr;
+        sendOnSession = nullptr;
+        if (subscribed.exchange(false)) {
+            // We were live, so this is a fresh disconnect rather than a failing retry
+            reconnectDelay = INITIAL_RECONNECT_DELAY;
+        }
+        if (!running) break;
+
+        Logger::warning("Fill feed disconnected, reconnecting in ", reconnectDelay.count(), " ms");
+        stopCV.wait_for(lock, reconnectDelay, [this]() { return !running; });
+        reconnectDelay = std::min(reconnectDelay * 2, MAX_RECONNECT_DELAY);
+    }
+}
+
+void FillFeed::handleMessage(const std::string& payload, std::vector<std::string>& replies) {
+    Json::CharReaderBuilder reader;
+    Json::Value message;
+    std::string errs;
+    std::istringstream messageStream(payload);
+    if (!Json::parseFromStream(reader, messageStream, &message, &errs)) {
+        Logger::warning("Fill feed: unparseable message: ", errs);
+        return;
+    }
+
+    if (message["method"].asString() == "subscription") {
+        const Json::Value& params = message["params"];
+        const std::string& channel = params["channel"].asString();
+        if (channel.compare(0, 12, "user.trades.") == 0) {
+            handleTrades(params["data"]);
+        } else if (channel.compare(0, 12, "user.orders.") == 0) {
+            handleOrders(params["data"]);
+        }
+        return;
+    }
+
+    if (message.isMember("error")) {
+        Logger::error("Fill feed request ", message["id"].asInt(), " failed: ", message["error"]["message"].asString());
+        return;
+    }
+
+    int id = message["id"].asInt();
+    switch (id) {
+        case AUTH_REQUEST_ID:
+            replies.push_back(subscribeRequest());
+            return;
+        case SUBSCRIBE_REQUEST_ID:
+            subscribed = true;
+            Logger::info("Fill feed subscribed to user trades and orders, backfilling from ", lastTradeTimestampMs);
+            // Live notifications flow from here on; fetch what happened before
+            for (size_t i = 0; i < backfillCurrencies.size(); ++i) {
+                requestBackfill(i, lastTradeTimestampMs, replies);
+            }
+            return;
+        case CANCEL_ALL_REQUEST_ID:
+            Logger::warning("Mass cancel confirmed: ", message["result"].asInt(), " orders cancelled");
+            return;
+        default:
+            if (id >= BACKFILL_REQUEST_ID && static_cast<size_t>(id - BACKFILL_REQUEST_ID) < backfillCurrencies.size()) {
+                handleBackfill(static_cast<size_t>(id - BACKFILL_REQUEST_ID), message["result"], replies);
+            }
+            return;
+    }
+}
+
+void FillFeed::requestBackfill(size_t currency, int64_t startTimestampMs, std::vector<std::string>& replies) const {
+    Json::Value request;
+    request["jsonrpc"] = "2.0";
+    request["id"] = BACKFILL_REQUEST_ID + static_cast<int>(currency);
+    request["method"] = "private/get_user_trades_by_currency";
+    request["params"]["currency"] = backfillCurrencies[currency];
+    request["params"]["start_timestamp"] = static_cast<Json::Int64>(startTimestampMs);
+    request["params"]["count"] = BACKFILL_PAGE_SIZE;
+    request["params"]["sorting"] = "asc";
+
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "";
+    replies.push_back(Json::writeString(writer, request));
+}
+
+void FillFeed::handleBackfill(size_t currency, const Json::Value& result, std::vector<std::string>& replies) {
+    const Json::Value& trades = result["trades"];
+    // Inclusive of the start timestamp, so the first trades may be ones already booked
+    handleTrades(trades);
+    if (!result["has_more"].asBool() || trades.empty()) {
+        Logger::info("Fill feed backfilled ", backfillCurrencies[currency], " trades");
+        return;
+    }
+    int64_t pageEnd = trades[trades.size() - 1]["timestamp"].asInt64();
+    if (pageEnd <= trades[0]["timestamp"].asInt64()) {
+        // A whole page in one millisecond; paging by time cannot get past it
+        Logger::warning("Fill feed: more than ", BACKFILL_PAGE_SIZE, " ", backfillCurrencies[currency],
+                        " trades at ", pageEnd, ", backfill stopped there");
+        return;
+    }
+    requestBackfill(currency, pageEnd, replies);
+}
+
+void FillFeed::handleTrades(const Json::Value& trades) {
+    auto receivedAt = std::chrono::steady_clock::now();
+    for (const auto& trade : trades) {
+        const std::string& tradeId = trade["trade_id"].asString();
+        if (!seenTrades.insert(tradeId)) {
+            continue;
+        }
+
+        Fill fill;
+        fill.tradeId = tradeId;
+        fill.orderId = trade["order_id"].asString();
+        fill.instrumentId = InstrumentRegistry::instance().intern(trade["instrument_name"].asString());
+        if (!parseOrderSide(trade["direction"].asString(), fill.side)) {
+            Logger::warning("Fill feed: trade ", tradeId, " has no direction, skipped");
+            continue;
+        }
+        fill.price = trade["price"].asDouble();
+        fill.amount = trade["amount"].asDouble();
+        fill.exchangeTimestampMs = trade["timestamp"].asInt64();
+        fill.receivedAt = receivedAt;
+        lastTradeTimestampMs = std::max(lastTradeTimestampMs, fill.exchangeTimestampMs);
+
+        if (fillCallback) {
+            fillCallback(fill);
+        }
+    }
+}
+
+bool FillFeed::parseOrder(const Json::Value& state, Order& order) {
+    if (!parseOrderStatus(state["order_state"].asString(), order.status)) {
+        return false;
+    }
+    order.orderId = state["order_id"].asString();
+    order.label = state["label"].asString();
+    order.instrumentId = InstrumentRegistry::instance().intern(state["instrument_name"].asString());
+    parseOrderSide(state["direction"].asString(), order.side);
+    parseOrderType(state["order_type"].asString(), order.type);
+    order.amount = state["amount"].asDouble();
+    // Market orders report "market_price" instead of a number
+    order.price = state["price"].isNumeric() ? state["price"].asDouble() : 0.0;
+    order.filledAmount = state["filled_amount"].asDouble();
+    order.averageFilledPrice = state["average_price"].asDouble();
+    return true;
+}
+
+void FillFeed::handleOrders(const Json::Value& orders) {
+    // The raw channel sends one order per notification; grouped ones send arrays
+    auto handleOrder = [this](const Json::Value& state) {
+        Order order{};
+        if (parseOrder(state, order) && orderUpdateCallback) {
+            orderUpdateCallback(order);
+        }
+    };
+
+    if (orders.isArray()) {
+        for (const auto& state : orders) {
+            handleOrder(state);
+        }
+    } else {
+        handleOrder(orders);
+    }
+}
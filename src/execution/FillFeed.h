@@ -0,0 +1,94 @@
+// execution/FillFeed.h
+#ifndef FILL_FEED_H
+#define FILL_FEED_H
+
+#include "../auth/AuthManager.h"
+#include "../orders/models/order.h"
+#include "../../include/RecentIdSet.h"
+#include <json/json.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Private websocket session subscribed to user.trades and user.orders. Fills
+// and order updates are decoded on the feed thread and handed straight to the
+// callbacks, so resting orders update positions as soon as the exchange
+// reports them. The exchange does not replay notifications missed while the
+// session was down, so every (re)subscribe also pages through
+// private/get_user_trades_by_currency from the newest trade seen so far.
+// Those trades go through the same trade ID deduplication and callback as
+// live ones, so the overlap with the live channel is booked once.
+class FillFeed {
+public:
+    struct Fill {
+        FixedString<32> tradeId;
+        FixedString<32> orderId;
+        InstrumentId instrumentId;
+        OrderSide side;
+        double price;
+        double amount;
+        int64_t exchangeTimestampMs;
+        std::chrono::steady_clock::time_point receivedAt;
+    };
+
+    using FillCallback = std::function<void(const Fill&)>;
+    using OrderUpdateCallback = std::function<void(const Order&)>;
+
+    static constexpr size_t TRADE_ID_HISTORY = 65536;
+
+    explicit FillFeed(AuthManager& authManager, const std::string& url = "wss://test.deribit.com/ws/api/v2");
+    ~FillFeed();
+
+    // Callbacks run on the feed thread; set them before start()
+    void setFillCallback(FillCallback callback);
+    void setOrderUpdateCallback(OrderUpdateCallback callback);
+    // Currencies whose trades are backfilled after each subscribe; set before start()
+    void setBackfillCurrencies(std::vector<std::string> currencies);
+
+    void start();
+    void stop();
+    bool isSubscribed() const { return subscribed; }
+    // Sends private/cancel_all on the live, authenticated session, so it skips
+    // the connection and TLS setup a REST request would pay. Returns false
+    // when there is no such session; the result is logged when it arrives.
+    bool cancelAll();
+
+    // An order object as user.orders and the private/get_open_orders_* calls
+    // report it; false for states Order cannot represent
+    static bool parseOrder(const Json::Value& state, Order& order);
+
+private:
+    AuthManager& authManager;
+    const std::string url;
+    FillCallback fillCallback;
+    OrderUpdateCallback orderUpdateCallback;
+
+    std::atomic<bool> running{false};
+    std::atomic<bool> subscribed{false};
+    std::thread feedThread;
+    std::mutex stopMutex;
+    std::condition_variable stopCV;
+    std::function<void()> stopClient;  // stops the active connection's event loop
+    std::function<bool(const std::string&)> sendOnSession;  // guarded by stopMutex
+
+    RecentIdSet seenTrades{TRADE_ID_HISTORY};  // feed thread only
+    std::vector<std::string> backfillCurrencies{"BTC", "ETH"};
+    // Exchange time of the newest trade seen, or of start() before any;
+    // the next backfill starts here. Feed thread only once started.
+    int64_t lastTradeTimestampMs = 0;
+
+    void run();
+    // Appends what to send back on the socket to replies
+    void handleMessage(const std::string& payload, std::vector<std::string>& replies);
+    void handleTrades(const Json::Value& trades);
+    void requestBackfill(size_t currency, int64_t startTimestampMs, std::vector<std::string>& replies) const;
+    void handleBackfill(size_t currency, const Json::Value& result, std::vector<std::string>& replies);
+    void handleOrders(const Json::Value& orders);
+};
+
+#endif
@@ -0,0 +1,256 @@
+#include "PaperExecutionBackend.h"
+#include "../include/Logger.h"
+#include <algorithm>
+#include <string>
+
+PaperExecutionBackend::PaperExecutionBackend(MarketDataManager& marketDataManager, const Options& options)
+    : marketDataManager(marketDataManager), options(options) {
+    fillThread = std::thread(&PaperExecutionBackend::fillLoop, this);
+    bookListener = marketDataManager.addBookUpdateListener([this](InstrumentId instrument, const OrderBook& book) {
+        onBookUpdate(instrument, book);
+    });
+}
+
+PaperExecutionBackend::~PaperExecutionBackend() {
+    marketDataManager.removeBookUpdateListener(bookListener);
+    {
+        std::lock_guard<std::mutex> lock(fillMutex);
+        running = false;
+    }
+    fillCV.notify_all();
+    if (fillThread.joinable()) {
+        fillThread.join();
+    }
+}
+
+void PaperExecutionBackend::setFillCallback(FillCallback callback) {
+    std::lock_guard<std::mutex> lock(fillMutex);
+    fillCallback = callback;
+}
+
+std::chrono::microseconds PaperExecutionBackend::sample(std::chrono::microseconds base) {
+    if (options.latency.jitter.count() <= 0) {
+        return base;
+    }
+    thread_local std::mt19937 generator{std::random_device{}()};
+    std::uniform_int_distribution<long long> jitter(-options.latency.jitter.count(), options.latency.jitter.count());
+    return std::max(std::chrono::microseconds::zero(), base + std::chrono::microseconds(jitter(generator)));
+}
+
+const OrderBook* PaperExecutionBackend::bookFor(InstrumentId instrument) {
+    return marketDataManager.getOrderBook(instrument);
+}
+
+double PaperExecutionBackend::matchAggressive(Order& order, const OrderBook& book, double& notional) {
+    double remaining = order.remainingAmount();
+    double filled = 0;
+    bool isMarket = order.type == OrderType::Market;
+    double limit = order.price;
+
+    // The local book is not depleted, so repeated matches may reuse the same
+    // liquidity; acceptable for a single strategy's simulated flow
+    auto take = [&](double price, double quantity) {
+        double amount = std::min(quantity, remaining - filled);
+        filled += amount;
+        notional += amount * price;
+        return filled < remaining;
+    };
+    if (order.isBuy()) {
+        book.forEachAsk([&](double price, double quantity) {
+            return (isMarket || price <= limit) && take(price, quantity);
+        });
+    } else {
+        book.forEachBid([&](double price, double quantity) {
+            return (isMarket || price >= limit) && take(price, quantity);
+        });
+    }
+    return filled;
+}
+
+double PaperExecutionBackend::passiveLevelQuantity(const Order& order, const OrderBook& book) const {
+    return order.isBuy() ? book.getBidQuantity(order.price) : book.getAskQuantity(order.price);
+}
+
+void PaperExecutionBackend::applyFill(Order& order, double amount, double price) {
+    double notional = order.filledAmount * order.averageFilledPrice + amount * price;
+    order.filledAmount += amount;
+    order.averageFilledPrice = notional / order.filledAmount;
+    order.status = order.remainingAmount() > 0 ? OrderStatus::PartiallyFilled : OrderStatus::Filled;
+}
+
+void PaperExecutionBackend::place(Order& order) {
+    std::this_thread::sleep_for(sample(options.latency.orderToAck));
+
+    order.orderId = "PAPER-" + std::to_string(nextOrderId++);
+    order.filledAmount = 0;
+    order.averageFilledPrice = 0;
+
+    const OrderBook* book = bookFor(order.instrumentId);
+    if (!book) {
+        Logger::warning("Paper order rejected: no book for ", order.instrumentName());
+        order.status = OrderStatus::Rejected;
+        order.rejectionReason = RejectReason::Exchange;
+        return;
+    }
+
+    // Immediate fills are part of the acknowledgement, as in a REST reply
+    double notional = 0;
+    double filled = matchAggressive(order, *book, notional);
+    if (filled > 0) {
+        applyFill(order, filled, notional / filled);
+    }
+
+    if (order.type == OrderType::Market) {
+        // Unfilled market remainder is cancelled
+        if (order.remainingAmount() > 0) {
+            order.status = OrderStatus::Cancelled;
+        }
+        return;
+    }
+    if (order.remainingAmount() <= 0) {
+        return;
+    }
+
+    if (filled == 0) {
+        order.status = OrderStatus::Open;
+    }
+    double levelQuantity = passiveLevelQuantity(order, *book);
+    std::lock_guard<std::mutex> lock(restingMutex);
+    restingOrders[order.instrumentId].push_back({order, levelQuantity, levelQuantity});
+}
+
+void PaperExecutionBackend::cancel(Order& order) {
+    std::this_thread::sleep_for(sample(options.latency.orderToAck));
+
+    std::lock_guard<std::mutex> lock(restingMutex);
+    auto& resting = restingOrders[order.instrumentId];
+    auto it = std::find_if(resting.begin(), resting.end(), [&order](const RestingOrder& entry) {
+        return entry.order.orderId == order.orderId;
+    });
+    if (it == resting.end()) {
+        Logger::warning("Paper cancel rejected: order ", order.orderId, " is not open");
+        return;
+    }
+
+    order = it->order;
+    order.status = OrderStatus::Cancelled;
+    resting.erase(it);
+}
+
+bool PaperExecutionBackend::amend(Order& order, double amount, double price) {
+    std::this_thread::sleep_for(sample(options.latency.orderToAck));
+
+    const OrderBook* book = bookFor(order.instrumentId);
+    std::lock_guard<std::mutex> lock(restingMutex);
+    auto& resting = restingOrders[order.instrumentId];
+    auto it = std::find_if(resting.begin(), resting.end(), [&order](const RestingOrder& entry) {
+        return entry.order.orderId == order.orderId;
+    });
+    if (it == resting.end() || !book || amount <= it->order.filledAmount) {
+        return false;
+    }
+
+    // Like the exchange: a new price or a larger size loses queue priority,
+    // a smaller size keeps it
+    bool losesPriority = price != it->order.price || amount > it->order.amount;
+    it->order.amount = amount;
+    it->order.price = price;
+    if (losesPriority) {
+        it->levelQuantity = passiveLevelQuantity(it->order, *book);
+        it->queueAhead = it->levelQuantity;
+    }
+    order = it->order;
+    return true;
+}
+
+void PaperExecutionBackend::onBookUpdate(InstrumentId instrument, const OrderBook& book) {
+    std::lock_guard<std::mutex> lock(restingMutex);
+    auto found = restingOrders.find(instrument);
+    if (found == restingOrders.end() || found->second.empty()) {
+        return;
+    }
+
+    auto& resting = found->second;
+    for (auto& entry : resting) {
+        Order& order = entry.order;
+
+        // The opposite side traded through our price
+        double notional = 0;
+        double crossed = matchAggressive(order, book, notional);
+        if (crossed > 0) {
+            double price = notional / crossed;
+            applyFill(order, crossed, price);
+            scheduleFill(order, crossed, price);
+            continue;
+        }
+
+        double levelQuantity = passiveLevelQuantity(order, book);
+        double decrease = entry.levelQuantity - levelQuantity;
+        entry.levelQuantity = levelQuantity;
+        if (decrease <= 0) {
+            continue;  // additions queue behind us
+        }
+
+        if (options.queueModel == QueueModel::Proportional) {
+            entry.queueAhead -= decrease * entry.queueAhead / (levelQuantity + decrease);
+            continue;
+        }
+
+        double consumedAhead = std::min(decrease, entry.queueAhead);
+        entry.queueAhead -= consumedAhead;
+        double amount = std::min(decrease - consumedAhead, order.remainingAmount());
+        if (amount > 0) {
+            applyFill(order, amount, order.price);
+            scheduleFill(order, amount, order.price);
+        }
+    }
+
+    resting.erase(std::remove_if(resting.begin(), resting.end(), [](const RestingOrder& entry) {
+        return entry.order.status == OrderStatus::Filled;
+    }), resting.end());
+}
+
+size_t PaperExecutionBackend::restingOrderCount() const {
+    std::lock_guard<std::mutex> lock(restingMutex);
+    size_t count = 0;
+    for (const auto& [instrument, resting] : restingOrders) {
+        count += resting.size();
+    }
+    return count;
+}
+
+void PaperExecutionBackend::scheduleFill(const Order& order, double amount, double price) {
+    {
+        std::lock_guard<std::mutex> lock(fillMutex);
+        scheduledFills.push({std::chrono::steady_clock::now() + sample(options.latency.ackToFill), order, amount, price});
+    }
+    fillCV.notify_one();
+}
+
+void PaperExecutionBackend::fillLoop() {
+    std::unique_lock<std::mutex> lock(fillMutex);
+    while (running) {
+        if (scheduledFills.empty()) {
+            fillCV.wait(lock);
+            continue;
+        }
+
+        auto due = scheduledFills.top().due;
+        if (fillCV.wait_until(lock, due) != std::cv_status::timeout && std::chrono::steady_clock::now() < due) {
+            continue;  // woken early: a sooner fill may have been scheduled
+        }
+
+        ScheduledFill fill = scheduledFills.top();
+        scheduledFills.pop();
+        FillCallback callback = fillCallback;
+        lock.unlock();
+        if (callback) {
+            try {
+                callback(fill.order, fill.amount, fill.price);
+            } catch (const std::exception& e) {
+                Logger::error("Error in paper fill callback: ", e.what());
+            }
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,97 @@
+// execution/PaperExecutionBackend.h
+#ifndef PAPER_EXECUTION_BACKEND_H
+#define PAPER_EXECUTION_BACKEND_H
+
+#include "ExecutionBackend.h"
+#include "../market/MarketDataManager.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Simulated exchange matching against the local OrderBook, fed live or from a
+// replay. Aggressive orders take liquidity level by level; passive orders rest
+// with an estimated queue position that shrinks as the level's quantity
+// decreases, and fill once their queue is consumed or the opposite side trades
+// through them. Fills go through the FillCallback after the ack-to-fill delay.
+class PaperExecutionBackend : public ExecutionBackend {
+public:
+    struct LatencyModel {
+        std::chrono::microseconds orderToAck{1000};
+        std::chrono::microseconds ackToFill{500};
+        std::chrono::microseconds jitter{0};  // uniform +/- on both delays
+    };
+
+    enum class QueueModel {
+        // Every decrease at our level is taken from ahead of us, and anything
+        // beyond the queue ahead trades against us
+        Optimistic,
+        // Decreases are spread evenly over the level, so the queue ahead only
+        // shrinks in proportion and passive fills need the price to trade through
+        Proportional
+    };
+
+    struct Options {
+        LatencyModel latency;
+        QueueModel queueModel = QueueModel::Proportional;
+    };
+
+    PaperExecutionBackend(MarketDataManager& marketDataManager, const Options& options);
+    ~PaperExecutionBackend() override;
+
+    void place(Order& order) override;
+    void cancel(Order& order) override;
+    bool amend(Order& order, double amount, double price) override;
+    void setFillCallback(FillCallback callback) override;
+
+    // Hooked to MarketDataManager's book updates; public so replays can drive it
+    void onBookUpdate(InstrumentId instrument, const OrderBook& book);
+
+    size_t restingOrderCount() const;
+
+private:
+    struct RestingOrder {
+        Order order;
+        double queueAhead;     // estimated quantity in front of us at our price
+        double levelQuantity;  // our level's quantity at the last update
+    };
+
+    struct ScheduledFill {
+        std::chrono::steady_clock::time_point due;
+        Order order;
+        double amount;
+        double price;
+        bool operator>(const ScheduledFill& other) const { return due > other.due; }
+    };
+
+    MarketDataManager& marketDataManager;
+    const Options options;
+    MarketDataManager::ListenerId bookListener;
+
+    std::unordered_map<InstrumentId, std::vector<RestingOrder>> restingOrders;
+    mutable std::mutex restingMutex;
+    std::atomic<uint64_t> nextOrderId{1};
+
+    FillCallback fillCallback;
+    std::priority_queue<ScheduledFill, std::vector<ScheduledFill>, std::greater<ScheduledFill>> scheduledFills;
+    std::mutex fillMutex;
+    std::condition_variable fillCV;
+    bool running = true;
+    std::thread fillThread;
+
+    std::chrono::microseconds sample(std::chrono::microseconds base);
+    const OrderBook* bookFor(InstrumentId instrument);
+    // Takes liquidity up to the order's limit; returns the filled amount
+    double matchAggressive(Order& order, const OrderBook& book, double& notional);
+    double passiveLevelQuantity(const Order& order, const OrderBook& book) const;
+    void applyFill(Order& order, double amount, double price);
+    void scheduleFill(const Order& order, double amount, double price);
+    void fillLoop();
+};
+
+#endif
@@ -0,0 +1,154 @@
+#include "RestExecutionBackend.h"
+#include "../include/Logger.h"
+#include <json/json.h>
+#include <chrono>
+#include <future>
+#include <sstream>
+
+namespace {
+
+// One connection keeps the shards' per-instrument order on the wire; deeper
+// pipelining makes up for the second connection
+AsyncHttpClient::Options executionClientOptions() {
+    AsyncHttpClient::Options options;
+    options.connections = 1;
+    options.pipelineDepth = 32;
+    return options;
+}
+
+}
+
+RestExecutionBackend::RestExecutionBackend(AuthManager& authManager)
+    : authManager(authManager), restClient("https://test.deribit.com", executionClientOptions()) {
+    orderEncoder.prepareAll();
+}
+
+void RestExecutionBackend::place(Order& order) {
+    wait([this, &order](Completion done) { placeAsync(order, std::move(done)); });
+}
+
+void RestExecutionBackend::cancel(Order& order) {
+    wait([this, &order](Completion done) { cancelAsync(order, std::move(done)); });
+}
+
+void RestExecutionBackend::wait(const std::function<void(Completion)>& send) {
+    std::promise<void> answered;
+    std::future<void> answer = answered.get_future();
+    send([&answered]() { answered.set_value(); });
+    answer.wait();
+}
+
+void RestExecutionBackend::placeAsync(Order& order, Completion done) {
+    auto start = std::chrono::high_resolution_clock::now(); // Start time
+    // Serialize the order into a stack buffer from the instrument template
+    OrderEncoder::Buffer payload;
+    if (!orderEncoder.encodePlace(order, nextRequestId++, payload)) {
+        Logger::error("Failed to encode order for ", order.instrumentName());
+        order.status = OrderStatus::Failed;
+        done();
+        return;
+    }
+
+    post(order.isBuy() ? "/api/v2/private/buy" : "/api/v2/private/sell", payload,
+         [this, &order, done = std::move(done), start](AsyncHttpClient::Response& response) {
+        try {
+            Json::Value jsonResponse;
+            if (!parseResponse(response.body, jsonResponse, "order")) {
+                order.status = OrderStatus::Failed;
+            } else {
+                // Update order status based on response; positions are booked by the report callback
+                updateOrderStatus(order, jsonResponse);
+            }
+        }
+        catch (const std::exception& e) {
+            Logger::error("Error executing order ", order.orderId, ": ", e.what());
+            order.status = OrderStatus::Failed;
+        }
+
+        auto end = std::chrono::high_resolution_clock::now(); // End time
+        std::chrono::duration<double, std::milli> latency = end - start;
+        Logger::info("Order placement latency: ", latency.count(), " ms");
+        done();
+    });
+}
+
+void RestExecutionBackend::cancelAsync(Order& order, Completion done) {
+    OrderEncoder::Buffer payload;
+    if (!orderEncoder.encodeCancel(order.orderId.view(), nextRequestId++, payload)) {
+        Logger::error("Failed to encode cancel for ", order.orderId);
+        done();
+        return;
+    }
+
+    post("/api/v2/private/cancel", payload, [this, &order, done = std::move(done)](AsyncHttpClient::Response& response) {
+        try {
+            Json::Value jsonResponse;
+            if (parseResponse(response.body, jsonResponse, "cancel")) {
+                applyCancel(order, jsonResponse);
+            }
+        }
+        catch (const std::exception& e) {
+            Logger::error("Error cancelling order ", order.orderId, ": ", e.what());
+        }
+        done();
+    });
+}
+
+void RestExecutionBackend::post(const char* target, const OrderEncoder::Buffer& payload,
+                                AsyncHttpClient::Callback callback) {
+    std::shared_ptr<const AuthManager::Token> token = authManager.currentToken();
+    AsyncHttpClient::Request request;
+    request.target = target;
+    request.body.assign(payload.data, payload.length);
+    request.headers = {
+        {"Authorization", token ? token->authorizationHeader : std::string()},
+        {"Content-Type", "application/json"}
+    };
+    restClient.post(std::move(request), [target, callback = std::move(callback)](AsyncHttpClient::Response& response) {
+        if (!response.error.empty()) {
+            Logger::error("Request to ", target, " failed: ", response.error);
+        }
+        callback(response);
+    });
+}
+
+bool RestExecutionBackend::parseResponse(const std::string& body, Json::Value& response, const char* what) {
+    Json::CharReaderBuilder reader;
+    std::string errs;
+    std::istringstream responseStream(body);
+    if (!Json::parseFromStream(reader, responseStream, &response, &errs)) {
+        Logger::error("Failed to parse ", what, " response: ", errs);
+        return false;
+    }
+    return true;
+}
+
+void RestExecutionBackend::updateOrderStatus(Order& order, const Json::Value& response) {
+    if (response["result"].isObject()) {
+        const Json::Value& state = response["result"].isMember("order") ? response["result"]["order"] : response["result"];
+        order.orderId = state["order_id"].asString();
+        if (!parseOrderStatus(state["order_state"].asString(), order.status)) {
+            order.status = OrderStatus::Open;
+        }
+        order.filledAmount = state["filled_amount"].asDouble();
+        order.averageFilledPrice = state["average_price"].asDouble();
+    } else {
+        order.status = OrderStatus::Rejected;
+        order.rejectionReason = RejectReason::Exchange;
+        Logger::warning("Order rejected: ", response["error"]["message"].asString());
+    }
+}
+
+void RestExecutionBackend::applyCancel(Order& order, const Json::Value& response) {
+    // A failed cancel leaves the order as it was; it may have filled meanwhile
+    if (!response["result"].isObject()) {
+        Logger::warning("Cancel rejected for ", order.orderId, ": ", response["error"]["message"].asString());
+        return;
+    }
+    const Json::Value& state = response["result"];
+    if (!parseOrderStatus(state["order_state"].asString(), order.status)) {
+        order.status = OrderStatus::Cancelled;
+    }
+    order.filledAmount = state["filled_amount"].asDouble();
+    order.averageFilledPrice = state["average_price"].asDouble();
+}
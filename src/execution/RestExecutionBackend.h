@@ -0,0 +1,40 @@
+// execution/RestExecutionBackend.h
+#ifndef REST_EXECUTION_BACKEND_H
+#define REST_EXECUTION_BACKEND_H
+
+#include "ExecutionBackend.h"
+#include "../auth/AuthManager.h"
+#include "../auth/utils/AsyncHttpClient.h"
+#include "../orders/OrderEncoder.h"
+#include <atomic>
+#include <json/json.h>
+
+// Sends orders to Deribit over the REST API. The async calls hand the request
+// to the HTTP client and complete from its callback on the I/O thread. All
+// requests share one pipelined connection, so orders for an instrument reach
+// the exchange in the order the execution shard sent them.
+class RestExecutionBackend : public ExecutionBackend {
+public:
+    explicit RestExecutionBackend(AuthManager& authManager);
+
+    // Wait for the async variants; never call them on the I/O thread
+    void place(Order& order) override;
+    void cancel(Order& order) override;
+    void placeAsync(Order& order, Completion done) override;
+    void cancelAsync(Order& order, Completion done) override;
+
+private:
+    AuthManager& authManager;
+    AsyncHttpClient restClient;
+    OrderEncoder orderEncoder;
+    std::atomic<uint64_t> nextRequestId{1};
+
+    // The callback gets an empty body on failure
+    void post(const char* target, const OrderEncoder::Buffer& payload, AsyncHttpClient::Callback callback);
+    static bool parseResponse(const std::string& body, Json::Value& response, const char* what);
+    void updateOrderStatus(Order& order, const Json::Value& response);
+    void applyCancel(Order& order, const Json::Value& response);
+    static void wait(const std::function<void(Completion)>& send);
+};
+
+#endif
@@ -0,0 +1,41 @@
+// execution/ThreadTuning.h
+#ifndef THREAD_TUNING_H
+#define THREAD_TUNING_H
+
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Pins the calling thread to one CPU. Returns false where unsupported or when
+// the CPU is not available to this process.
+inline bool pinCurrentThread(int cpu) {
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// Spin-wait hint: yields pipeline resources to the sibling hyperthread and
+// avoids a memory-order flush when the awaited cache line finally changes
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+#endif
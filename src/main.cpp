@@ -1,8 +1,12 @@
+#include <future>
 #include <iostream>
 #include <thread>
 #include "auth/AuthManager.h"
 #include "market/MarketDataManager.h"
+#include "market/ReferenceData.h"
 #include "orders/OrderManager.h"
+#include "orders/KillSwitch.h"
+#include "risk/VolSurface.h"
 #include "websocket/WebSocketServer.h"
 #include "include/Logger.h"
 
@@ -12,7 +16,9 @@ void placeOrder(OrderManager& orderManager);
 void cancelOrder(OrderManager& orderManager);
 void modifyOrder(OrderManager& orderManager);
 void viewOrderBook(MarketDataManager& marketDataManager);
-void viewPositions(MarketDataManager& marketDataManager);
+void viewPositions(OrderManager& orderManager);
+void haltTrading(KillSwitch& killSwitch);
+void resumeTrading(KillSwitch& killSwitch);
 
 int main() {
     try {
@@ -33,6 +39,13 @@ int main() {
         }
         Logger::info("Authentication successful");
 
+        // Before anything interns an instrument, so IDs match the cached ones
+        Logger::info("Loading instrument reference data...");
+        ReferenceData referenceData;
+        if (!referenceData.load()) {
+            Logger::warning("Continuing without reference data; instruments are classified by name");
+        }
+
         Logger::info("Initializing WebSocket server...");
         WebSocketServer webSocketServer;
 
@@ -59,11 +72,26 @@ int main() {
         }
 
         Logger::info("Initializing order manager...");
-        OrderManager orderManager(authManager);
+        OrderManager orderManager(authManager, marketDataManager);
+        Logger::info("Recovering order state...");
+        orderManager.recover();
+        orderManager.getPnlEngine().startPublishing(webSocketServer);
+
+        Logger::info("Starting volatility surface...");
+        VolSurface volSurface(orderManager.getRiskManager());
+        volSurface.attach(marketDataManager);
+        volSurface.startPublishing(webSocketServer);
+
+        Logger::info("Arming kill switch...");
+        KillSwitch::Options killSwitchOptions;
+        killSwitchOptions.controlSocketPath = "trading_system.sock";
+        KillSwitch killSwitch(orderManager, killSwitchOptions);
+        killSwitch.watch(marketDataManager);
+        killSwitch.start();
 
         // CLI Loop
         int choice = 0;
-        while (choice != 6) {
+        while (choice != 8) {
             showMenu();
             std::cin >> choice;
 
@@ -81,9 +109,15 @@ int main() {
                     viewOrderBook(marketDataManager);
                     break;
                 case 5:
-                    viewPositions(marketDataManager);
+                    viewPositions(orderManager);
                     break;
                 case 6:
+                    haltTrading(killSwitch);
+                    break;
+                case 7:
+                    resumeTrading(killSwitch);
+                    break;
+                case 8:
                     Logger::info("Exiting the system. Goodbye!");
                     break;
                 default:
@@ -110,22 +144,32 @@ void showMenu() {
     std::cout << "3. Modify an Order\n";
     std::cout << "4. View Order Book\n";
     std::cout << "5. View Current Positions\n";
-    std::cout << "6. Exit\n";
+    std::cout << "6. Halt Trading (kill switch)\n";
+    std::cout << "7. Resume Trading\n";
+    std::cout << "8. Exit\n";
     std::cout << "Enter your choice: ";
 }
 
 // CLI Options Implementation
 void placeOrder(OrderManager& orderManager) {
     Order order;
+    std::string instrument, side, type;
     std::cout << "Enter instrument name (e.g., BTC-PERPETUAL): ";
-    std::cin >> order.instrumentName;
+    std::cin >> instrument;
     std::cout << "Enter side (buy/sell): ";
-    std::cin >> order.side;
+    std::cin >> side;
     std::cout << "Enter amount: ";
     std::cin >> order.amount;
     std::cout << "Enter type (market/limit): ";
-    std::cin >> order.type;
-    if (order.type == "limit") {
+    std::cin >> type;
+
+    order.instrumentId = InstrumentRegistry::instance().intern(instrument);
+    if (order.instrumentId == INVALID_INSTRUMENT || !parseOrderSide(side, order.side) ||
+        !parseOrderType(type, order.type)) {
+        std::cout << "Invalid order parameters.\n";
+        return;
+    }
+    if (order.type == OrderType::Limit) {
         std::cout << "Enter price: ";
         std::cin >> order.price;
     }
@@ -172,17 +216,63 @@ void viewOrderBook(MarketDataManager& marketDataManager) {
     std::cout << "Enter instrument name (e.g., BTC-PERPETUAL): ";
     std::cin >> instrument;
 
-    if (!marketDataManager.getOrderBook(instrument)) {
+    // The streamed book when subscribed; REST only for instruments without one.
+    // The CLI thread may wait for the answer.
+    std::promise<bool> answered;
+    std::future<bool> answer = answered.get_future();
+    MarketDataManager::BookSnapshot snapshot;
+    marketDataManager.getBookSnapshot(instrument, 10, [&](bool fetched, MarketDataManager::BookSnapshot& result) {
+        snapshot = std::move(result);
+        answered.set_value(fetched);
+    });
+    if (!answer.get()) {
         std::cout << "Failed to fetch order book.\n";
+        return;
+    }
+
+    std::cout << "Orderbook for " << instrument << (snapshot.live ? " (live):" : " (REST):") << std::endl;
+    std::cout << "Asks:" << std::endl;
+    for (const auto& [price, amount] : snapshot.asks) {
+        std::cout << "Price: " << price << ", Size: " << amount << std::endl;
+    }
+    std::cout << "Bids:" << std::endl;
+    for (const auto& [price, amount] : snapshot.bids) {
+        std::cout << "Price: " << price << ", Size: " << amount << std::endl;
     }
 }
 
-void viewPositions(MarketDataManager& marketDataManager) {
+void viewPositions(OrderManager& orderManager) {
     std::string currency;
     std::cout << "Enter currency (e.g., BTC): ";
     std::cin >> currency;
 
-    if (!marketDataManager.getPositions(currency)) {
-        std::cout << "Failed to fetch positions.\n";
+    // From the local risk and PnL state, kept current by the fill feed
+    std::vector<OrderManager::PositionSnapshot> positions = orderManager.getPositions(currency);
+    std::cout << "Open positions for currency: " << currency << std::endl;
+    for (const auto& position : positions) {
+        std::cout << "Instrument: " << InstrumentRegistry::instance().name(position.instrument) << std::endl;
+        std::cout << "Size: " << position.size << std::endl;
+        std::cout << "Average Price: " << position.averagePrice << std::endl;
+        std::cout << "Direction: " << (position.size > 0 ? "buy" : "sell") << std::endl;
+        std::cout << "Unrealized PnL: " << position.unrealizedPnl << std::endl;
+        std::cout << "-----------------------------" << std::endl;
+    }
+    std::cout << "Open orders: " << orderManager.getOpenOrderCount() << std::endl;
+}
+
+void haltTrading(KillSwitch& killSwitch) {
+    if (killSwitch.trigger(KillSwitch::Reason::Manual)) {
+        std::cout << "Trading halted, all open orders are being cancelled.\n";
+    } else {
+        std::cout << "Trading is already halted (" << toString(killSwitch.reason()) << ").\n";
     }
-}
\ No newline at end of file
+}
+
+void resumeTrading(KillSwitch& killSwitch) {
+    if (!killSwitch.isHalted()) {
+        std::cout << "Trading is not halted.\n";
+        return;
+    }
+    killSwitch.reset();
+    std::cout << "Trading resumed.\n";
+}
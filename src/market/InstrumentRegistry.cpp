@@ -0,0 +1,49 @@
+#include "InstrumentRegistry.h"
+#include <mutex>
+
+InstrumentRegistry& InstrumentRegistry::instance() {
+    static InstrumentRegistry registry;
+    return registry;
+}
+
+InstrumentId InstrumentRegistry::find(std::string_view name) const {
+    std::shared_lock<std::shared_mutex> lock(idsMutex);
+    auto it = ids.find(name);
+    return it != ids.end() ? it->second : INVALID_INSTRUMENT;
+}
+
+InstrumentId InstrumentRegistry::intern(std::string_view name) {
+    InstrumentId existing = find(name);
+    if (existing != INVALID_INSTRUMENT) {
+        return existing;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(idsMutex);
+    auto it = ids.find(name);
+    if (it != ids.end()) {
+        return it->second;
+    }
+
+    size_t next = count.load(std::memory_order_relaxed);
+    if (next >= MAX_INSTRUMENTS || name.size() >= sizeof(Name)) {
+        return INVALID_INSTRUMENT;
+    }
+
+    InstrumentId id = static_cast<InstrumentId>(next);
+    names[id].assign(name);
+    ids.emplace(names[id].view(), id);
+    count.store(next + 1, std::memory_order_release);
+    return id;
+}
+
+InstrumentId InstrumentRegistry::define(std::string_view name, const InstrumentInfo& info) {
+    InstrumentId id = intern(name);
+    if (id == INVALID_INSTRUMENT) {
+        return id;
+    }
+    auto snapshot = std::make_unique<const InstrumentInfo>(info);
+    std::unique_lock<std::shared_mutex> lock(idsMutex);
+    infos[id].store(snapshot.get(), std::memory_order_release);
+    infoSnapshots.push_back(std::move(snapshot));
+    return id;
+}
@@ -0,0 +1,104 @@
+// market/InstrumentRegistry.h
+#ifndef INSTRUMENT_REGISTRY_H
+#define INSTRUMENT_REGISTRY_H
+
+#include "../../include/FixedString.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using InstrumentId = uint32_t;
+constexpr InstrumentId INVALID_INSTRUMENT = UINT32_MAX;
+
+enum class InstrumentClass : uint8_t { Perpetual, Future, Option, Spot };
+constexpr size_t INSTRUMENT_CLASS_COUNT = 4;
+
+// From the Deribit name: BTC-PERPETUAL, BTC-27DEC24, BTC-27DEC24-60000-C, BTC_USDC
+inline InstrumentClass classifyInstrument(std::string_view name) {
+    size_t dashes = 0;
+    for (char c : name) {
+        dashes += c == '-';
+    }
+    if (dashes == 0) {
+        return InstrumentClass::Spot;
+    }
+    if (dashes >= 3) {
+        return InstrumentClass::Option;
+    }
+    return name.substr(name.find('-') + 1) == "PERPETUAL" ? InstrumentClass::Perpetual : InstrumentClass::Future;
+}
+
+inline const char* toString(InstrumentClass instrumentClass) {
+    switch (instrumentClass) {
+        case InstrumentClass::Perpetual: return "perpetual";
+        case InstrumentClass::Future: return "future";
+        case InstrumentClass::Option: return "option";
+        default: return "spot";
+    }
+}
+
+// Exchange reference data for one instrument, from public/get_instruments
+struct InstrumentInfo {
+    InstrumentClass instrumentClass = InstrumentClass::Spot;
+    bool inverse = false;  // settled in the base currency, as BTC-PERPETUAL is
+    bool call = false;     // options only
+    double tickSize = 0;
+    double contractSize = 0;
+    double minTradeAmount = 0;
+    double strike = 0;   // options only
+    int64_t expiry = 0;  // ms since epoch; 0 for perpetuals and spot
+    FixedString<16> baseCurrency;
+    FixedString<16> quoteCurrency;
+    FixedString<16> settlementCurrency;
+};
+
+// Process-wide instrument interning. Each instrument name maps to a dense ID
+// below MAX_INSTRUMENTS so per-instrument state can live in flat arrays.
+// IDs are never reused; name and reference data lookup by ID are lock-free.
+class InstrumentRegistry {
+public:
+    static constexpr size_t MAX_INSTRUMENTS = 4096;
+    using Name = FixedString<48>;
+
+    static InstrumentRegistry& instance();
+
+    // Returns the existing ID or assigns the next one; INVALID_INSTRUMENT when
+    // the table is full or the name does not fit in Name
+    InstrumentId intern(std::string_view name);
+    // Returns INVALID_INSTRUMENT for names that were never interned
+    InstrumentId find(std::string_view name) const;
+
+    // Interns the name and publishes its reference data, replacing any earlier
+    InstrumentId define(std::string_view name, const InstrumentInfo& info);
+
+    // Empty for INVALID_INSTRUMENT and IDs not yet assigned
+    const Name& name(InstrumentId id) const {
+        static const Name unknown;
+        return id < size() ? names[id] : unknown;
+    }
+    // Null until reference data is defined for the instrument
+    const InstrumentInfo* info(InstrumentId id) const {
+        return id < MAX_INSTRUMENTS ? infos[id].load(std::memory_order_acquire) : nullptr;
+    }
+    size_t size() const { return count.load(std::memory_order_acquire); }
+
+private:
+    InstrumentRegistry() = default;
+
+    Name names[MAX_INSTRUMENTS];
+    std::atomic<const InstrumentInfo*> infos[MAX_INSTRUMENTS] = {};
+    // Replaced reference data stays alive, since readers may still hold it;
+    // it changes rarely. Guarded by idsMutex.
+    std::vector<std::unique_ptr<const InstrumentInfo>> infoSnapshots;
+    std::atomic<size_t> count{0};
+    // Keys view into names[], which never moves, so lookups do not allocate
+    std::unordered_map<std::string_view, InstrumentId> ids;
+    mutable std::shared_mutex idsMutex;
+};
+
+#endif
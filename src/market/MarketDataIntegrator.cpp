@@ -1,94 +1,449 @@
 #include "MarketDataIntegrator.h"
 #include "../include/Logger.h"
+#include <algorithm>
+#include <limits>
 
-MarketDataIntegrator::MarketDataIntegrator( MarketDataManager& mdManager, ExecutionManager& execManager)
-    : marketDataManager(mdManager), executionManager(execManager), running(false) {}
+MarketDataIntegrator::MarketDataIntegrator(MarketDataManager& mdManager, ExecutionManager& execManager,
+                                           OrderPool& orderPool)
+    : marketDataManager(mdManager), executionManager(execManager), orderPool(orderPool), running(false),
+      triggers(std::make_unique<InstrumentTriggers[]>(InstrumentRegistry::MAX_INSTRUMENTS)) {
+    bookListener = marketDataManager.addBookUpdateListener([this](InstrumentId instrument, const OrderBook& book) {
+        onBookUpdate(instrument, book);
+    });
+}
+
+MarketDataIntegrator::~MarketDataIntegrator() {
+    marketDataManager.removeBookUpdateListener(bookListener);
+}
 
 void MarketDataIntegrator::start() {
     running = true;
-    watchThread = std::thread(&MarketDataIntegrator::watchLoop, this);
     Logger::info("Market data integrator started");
 }
 
 void MarketDataIntegrator::stop() {
     running = false;
-    if (watchThread.joinable()) {
-        watchThread.join();
-    }
     Logger::info("Market data integrator stopped");
 }
 
-void MarketDataIntegrator::addOrderForPriceWatch(const Order& order) {
-    std::lock_guard<std::mutex> lock(watchMutex);
-    OrderWatch watch{
-        order,
-        order.price,
-        std::chrono::system_clock::now()
+void MarketDataIntegrator::addOrderForPriceWatch(OrderHandle handle) {
+    addConditionalOrder(handle, Trigger());
+}
+
+bool MarketDataIntegrator::addConditionalOrder(OrderHandle handle, const Trigger& trigger) {
+    Watch watch;
+    watch.trigger = trigger;
+    return addWatches({{handle, watch}});
+}
+
+bool MarketDataIntegrator::addOcoOrders(OrderHandle first, const Trigger& firstTrigger, OrderHandle second,
+                                        const Trigger& secondTrigger) {
+    if (first == second) {
+        Logger::error("Cannot watch order ", first, ": an OCO pair needs two orders");
+        orderPool.release(first);
+        return false;
+    }
+    Watch firstWatch;
+    firstWatch.trigger = firstTrigger;
+    firstWatch.ocoPeer = second;
+    Watch secondWatch;
+    secondWatch.trigger = secondTrigger;
+    secondWatch.ocoPeer = first;
+    return addWatches({{first, firstWatch}, {second, secondWatch}});
+}
+
+bool MarketDataIntegrator::addBracketOrder(OrderHandle entry, const Trigger& entryTrigger, OrderHandle takeProfit,
+                                           OrderHandle stopLoss, const Trigger& stopLossTrigger) {
+    if (entry == takeProfit || entry == stopLoss || takeProfit == stopLoss) {
+        Logger::error("Cannot watch order ", entry, ": a bracket needs three distinct orders");
+        orderPool.release(entry);
+        if (takeProfit != entry) {
+            orderPool.release(takeProfit);
+        }
+        if (stopLoss != entry && stopLoss != takeProfit) {
+            orderPool.release(stopLoss);
+        }
+        return false;
+    }
+    Watch entryWatch;
+    entryWatch.trigger = entryTrigger;
+    entryWatch.takeProfit = takeProfit;
+    entryWatch.stopLoss = stopLoss;
+    Watch takeProfitWatch;
+    takeProfitWatch.armed = false;
+    takeProfitWatch.ocoPeer = stopLoss;
+    takeProfitWatch.bracketEntry = entry;
+    Watch stopLossWatch;
+    stopLossWatch.trigger = stopLossTrigger;
+    stopLossWatch.armed = false;
+    stopLossWatch.ocoPeer = takeProfit;
+    stopLossWatch.bracketEntry = entry;
+    return addWatches({{entry, entryWatch}, {takeProfit, takeProfitWatch}, {stopLoss, stopLossWatch}});
+}
+
+bool MarketDataIntegrator::addWatches(std::initializer_list<WatchRequest> requests) {
+    OrderHandle first = requests.begin()->first;
+    auto reject = [&](const char* error) {
+        Logger::error("Cannot watch order ", first, ": ", error);
+        for (const auto& request : requests) {
+            orderPool.release(request.first);
+        }
+        return false;
+    };
+
+    InstrumentId instrument = orderPool.get(first).instrumentId;
+    if (instrument >= InstrumentRegistry::MAX_INSTRUMENTS) {
+        return reject("unknown instrument");
+    }
+    for (const auto& [handle, watch] : requests) {
+        if (orderPool.get(handle).instrumentId != instrument) {
+            return reject("linked orders must share an instrument");
+        }
+        if (watch.trigger.type == TriggerType::Stop && watch.trigger.triggerPrice <= 0) {
+            return reject("stop orders need a trigger price");
+        }
+        if (watch.trigger.type == TriggerType::TrailingStop && watch.trigger.trailingOffset <= 0) {
+            return reject("trailing stops need a positive offset");
+        }
+    }
+
+    // Check against the current book right away rather than waiting for the next change
+    const OrderBook* book = marketDataManager.getOrderBook(instrument);
+    double bestBid = book ? book->getBestBid() : 0.0;
+    double bestAsk = book ? book->getBestAsk() : 0.0;
+
+    InstrumentTriggers& entry = triggers[instrument];
+    std::vector<OrderHandle> fired;
+    {
+        std::lock_guard<std::mutex> lock(entry.mutex);
+        if (bestBid > 0 || bestAsk > 0) {
+            entry.lastBid = bestBid;
+            entry.lastAsk = bestAsk;
+        }
+        for (const auto& [handle, watch] : requests) {
+            if (entry.watches.count(handle)) {
+                // Still owned by the existing watch, so only free the others
+                Logger::error("Cannot watch order ", handle, ": already watched");
+                for (const auto& request : requests) {
+                    if (!entry.watches.count(request.first)) {
+                        orderPool.release(request.first);
+                    }
+                }
+                return false;
+            }
+            if (watch.armed && watch.trigger.type == TriggerType::TrailingStop &&
+                trailingReference(entry, orderPool.get(handle).isBuy()) <= 0) {
+                return reject("no market price to trail");
+            }
+        }
+
+        for (const auto& [handle, watch] : requests) {
+            entry.watches[handle] = watch;
+            watchedCount.fetch_add(1, std::memory_order_relaxed);
+            if (watch.armed) {
+                arm(entry, handle, watch);
+            }
+        }
+        collectTriggered(entry, fired);
+    }
+    Logger::info("Added order to price watch: ", first);
+    release(entry, fired);
+    return true;
+}
+
+void MarketDataIntegrator::removeOrderFromWatch(OrderHandle handle) {
+    InstrumentId instrument = orderPool.get(handle).instrumentId;
+    if (instrument >= InstrumentRegistry::MAX_INSTRUMENTS) {
+        return;
+    }
+
+    InstrumentTriggers& entry = triggers[instrument];
+    bool removed = false;
+    {
+        std::lock_guard<std::mutex> lock(entry.mutex);
+        if (entry.watches.count(handle)) {
+            dropWatch(entry, handle);
+            removed = true;
+        } else {
+            auto unsent = std::find(entry.unsent.begin(), entry.unsent.end(), handle);
+            if (unsent != entry.unsent.end()) {
+                entry.unsent.erase(unsent);
+                finishBracket(entry, handle);
+                entry.count.fetch_sub(1, std::memory_order_relaxed);
+                watchedCount.fetch_sub(1, std::memory_order_relaxed);
+                orderPool.release(handle);
+                removed = true;
+            }
+        }
+    }
+    if (removed) {
+        Logger::info("Removed order from price watch: ", handle);
+    }
+}
+
+void MarketDataIntegrator::onBookUpdate(InstrumentId instrument, const OrderBook& book) {
+    if (!running || instrument >= InstrumentRegistry::MAX_INSTRUMENTS) {
+        return;
+    }
+    InstrumentTriggers& entry = triggers[instrument];
+    if (entry.count.load(std::memory_order_acquire) == 0) {
+        return;
+    }
+
+    double bestBid = book.getBestBid();
+    double bestAsk = book.getBestAsk();
+    std::vector<OrderHandle> fired;
+    {
+        std::lock_guard<std::mutex> lock(entry.mutex);
+        // Depth-only updates cannot cross a trigger
+        if (bestBid == entry.lastBid && bestAsk == entry.lastAsk && entry.unsent.empty()) {
+            return;
+        }
+        entry.lastBid = bestBid;
+        entry.lastAsk = bestAsk;
+        fired.swap(entry.unsent);
+        entry.count.fetch_sub(fired.size(), std::memory_order_relaxed);
+        collectTriggered(entry, fired);
+    }
+    release(entry, fired);
+}
+
+void MarketDataIntegrator::collectTriggered(InstrumentTriggers& entry, std::vector<OrderHandle>& fired) {
+    double bestBid = entry.lastBid;
+    double bestAsk = entry.lastAsk;
+    auto onAsk = [&](OrderHandle handle, double) {
+        onTriggered(entry, handle, bestAsk, fired);
+    };
+    auto onBid = [&](OrderHandle handle, double) {
+        onTriggered(entry, handle, bestBid, fired);
     };
-    watchedOrders[order.orderId] = watch;
-    Logger::info("Added order to price watch: ", order.orderId);
+    // An empty side (price 0) has nothing to trade against
+    if (bestAsk > 0) {
+        entry.buyTriggers.popCrossed(bestAsk, onAsk);
+        entry.buyStops.popCrossed(bestAsk, onAsk);
+        entry.buyTrailingStops.update(-bestAsk, onAsk);
+    }
+    if (bestBid > 0) {
+        entry.sellTriggers.popCrossed(bestBid, onBid);
+        entry.sellStops.popCrossed(bestBid, onBid);
+        entry.sellTrailingStops.update(bestBid, onBid);
+    }
 }
 
-void MarketDataIntegrator::removeOrderFromWatch(const std::string& orderId) {
-    std::lock_guard<std::mutex> lock(watchMutex);
-    watchedOrders.erase(orderId);
-    Logger::info("Removed order from price watch: ", orderId);
+void MarketDataIntegrator::onTriggered(InstrumentTriggers& entry, OrderHandle handle, double reference,
+                                       std::vector<OrderHandle>& fired) {
+    auto it = entry.watches.find(handle);
+    Watch watch = it->second;
+    entry.watches.erase(it);
+    entry.count.fetch_sub(1, std::memory_order_relaxed);
+
+    // Price watches and stop-markets execute at the price that triggered them;
+    // stop-limits keep their limit
+    Order& order = orderPool.get(handle);
+    if (watch.trigger.type == TriggerType::Price || order.type == OrderType::Market) {
+        order.price = reference;
+    }
+    fired.push_back(handle);
+
+    if (watch.ocoPeer != INVALID_ORDER_HANDLE && entry.watches.count(watch.ocoPeer)) {
+        dropWatch(entry, watch.ocoPeer);
+    }
+
+    // Exits wait for the entry's fills; the entry's handle stays valid until its final report
+    if (entry.watches.count(watch.takeProfit) || entry.watches.count(watch.stopLoss)) {
+        FiredBracket& bracket = entry.firedBrackets[handle];
+        bracket.takeProfit = watch.takeProfit;
+        bracket.stopLoss = watch.stopLoss;
+        firedBracketCount.fetch_add(1, std::memory_order_release);
+    }
 }
 
-void MarketDataIntegrator::watchLoop() {
-    while (running) {
-        try{
-            checkPriceConditions();
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+void MarketDataIntegrator::onOrderReport(OrderHandle handle, bool final) {
+    if (firedBracketCount.load(std::memory_order_acquire) == 0) {
+        return;
+    }
+    const Order& order = orderPool.get(handle);
+    if (order.instrumentId >= InstrumentRegistry::MAX_INSTRUMENTS) {
+        return;
+    }
+
+    // The last prices seen may be stale: book updates are skipped while nothing is armed
+    const OrderBook* book = marketDataManager.getOrderBook(order.instrumentId);
+    double bestBid = book ? book->getBestBid() : 0.0;
+    double bestAsk = book ? book->getBestAsk() : 0.0;
+
+    InstrumentTriggers& entry = triggers[order.instrumentId];
+    std::vector<OrderHandle> fired;
+    {
+        std::lock_guard<std::mutex> lock(entry.mutex);
+        auto it = entry.firedBrackets.find(handle);
+        if (it == entry.firedBrackets.end()) {
+            return;
         }
-        catch(const std::exception& e) {
-            Logger::error("Error in market data watch loop: ", e.what());
+        if (bestBid > 0 || bestAsk > 0) {
+            entry.lastBid = bestBid;
+            entry.lastAsk = bestAsk;
+        }
+        FiredBracket& bracket = it->second;
+        double filled = order.filledAmount;
+        if (filled > bracket.armedAmount) {
+            for (OrderHandle exit : {bracket.takeProfit, bracket.stopLoss}) {
+                auto pending = entry.watches.find(exit);
+                if (exit == INVALID_ORDER_HANDLE || pending == entry.watches.end()) {
+                    continue;
+                }
+                orderPool.get(exit).amount = filled;
+                if (!pending->second.armed) {
+                    pending->second.armed = true;
+                    arm(entry, exit, pending->second);
+                }
+            }
+            Logger::info("Bracket exits for order ", handle, " armed for ", filled);
+            bracket.armedAmount = filled;
+        }
+
+        if (final) {
+            finishBracket(entry, handle);
         }
+        collectTriggered(entry, fired);
+    }
+    release(entry, fired);
+}
+
+double MarketDataIntegrator::trailingReference(const InstrumentTriggers& entry, bool buy) {
+    // Fall back to the other side while one side of the book is empty
+    if (buy) {
+        return entry.lastAsk > 0 ? entry.lastAsk : entry.lastBid;
+    }
+    return entry.lastBid > 0 ? entry.lastBid : entry.lastAsk;
+}
+
+void MarketDataIntegrator::arm(InstrumentTriggers& entry, OrderHandle handle, const Watch& watch) {
+    const Order& order = orderPool.get(handle);
+    const Trigger& trigger = watch.trigger;
+    switch (trigger.type) {
+        case TriggerType::Price:
+            // Market orders cross any price, so they fire on the next evaluation
+            if (order.isBuy()) {
+                entry.buyTriggers.add(handle, order.type == OrderType::Market ?
+                                      std::numeric_limits<double>::infinity() : order.price);
+            } else {
+                entry.sellTriggers.add(handle, order.type == OrderType::Market ? 0.0 : order.price);
+            }
+            break;
+        case TriggerType::Stop:
+            if (order.isBuy()) {
+                entry.buyStops.add(handle, trigger.triggerPrice);
+            } else {
+                entry.sellStops.add(handle, trigger.triggerPrice);
+            }
+            break;
+        case TriggerType::TrailingStop:
+            if (order.isBuy()) {
+                entry.buyTrailingStops.add(handle, trigger.trailingOffset, -trailingReference(entry, true));
+            } else {
+                entry.sellTrailingStops.add(handle, trigger.trailingOffset, trailingReference(entry, false));
+            }
+            break;
+    }
+    entry.count.fetch_add(1, std::memory_order_release);
+}
+
+void MarketDataIntegrator::disarm(InstrumentTriggers& entry, OrderHandle handle, const Watch& watch) {
+    bool buy = orderPool.get(handle).isBuy();
+    bool removed = false;
+    switch (watch.trigger.type) {
+        case TriggerType::Price:
+            removed = buy ? entry.buyTriggers.remove(handle) : entry.sellTriggers.remove(handle);
+            break;
+        case TriggerType::Stop:
+            removed = buy ? entry.buyStops.remove(handle) : entry.sellStops.remove(handle);
+            break;
+        case TriggerType::TrailingStop:
+            removed = buy ? entry.buyTrailingStops.remove(handle) : entry.sellTrailingStops.remove(handle);
+            break;
+    }
+    if (removed) {
+        entry.count.fetch_sub(1, std::memory_order_relaxed);
     }
 }
 
-void MarketDataIntegrator::checkPriceConditions() {
-    std::lock_guard<std::mutex> lock(watchMutex);
-    
-    auto it = watchedOrders.begin();
-    while (it != watchedOrders.end()) {
-        const auto& orderId = it->first;
-        const auto& watch = it->second;
-        
-        auto orderBook = marketDataManager.getOrderBook(watch.order.instrumentName);
-        if(!orderBook) {
-            ++it;
+void MarketDataIntegrator::finishBracket(InstrumentTriggers& entry, OrderHandle handle) {
+    auto it = entry.firedBrackets.find(handle);
+    if (it == entry.firedBrackets.end()) {
+        return;
+    }
+    FiredBracket bracket = it->second;
+    entry.firedBrackets.erase(it);
+    firedBracketCount.fetch_sub(1, std::memory_order_relaxed);
+
+    // Exits that never armed had no position to protect
+    for (OrderHandle exit : {bracket.takeProfit, bracket.stopLoss}) {
+        auto pending = entry.watches.find(exit);
+        if (exit == INVALID_ORDER_HANDLE || pending == entry.watches.end()) {
             continue;
         }
-        
-        double currentPrice = watch.order.side == "buy" ? 
-            orderBook->getBestAsk() : orderBook->getBestBid();
-            
-        if (isPriceConditionMet(watch.order, currentPrice)) {
-            // Update order price to current market price
-            Order executionOrder = watch.order;
-            executionOrder.price = currentPrice;
-            
-            // Send to execution
-            executionManager.addOrder(executionOrder);
-            Logger::info("Price condition met for order: ", orderId, " at price: ", currentPrice);
-            
-            // Remove from watch
-            it = watchedOrders.erase(it);
+        if (pending->second.armed) {
+            pending->second.bracketEntry = INVALID_ORDER_HANDLE;
         } else {
-            ++it;
+            dropWatch(entry, exit);
         }
     }
 }
 
-bool MarketDataIntegrator::isPriceConditionMet(const Order& order, double currentPrice) {
-    if (order.type == "market") {
-        return true;
+void MarketDataIntegrator::dropWatch(InstrumentTriggers& entry, OrderHandle handle) {
+    auto it = entry.watches.find(handle);
+    Watch watch = it->second;
+    entry.watches.erase(it);
+    if (watch.armed) {
+        disarm(entry, handle, watch);
     }
-    
-    if (order.side == "buy") {
-        return currentPrice <= order.price;
-    } else {
-        return currentPrice >= order.price;
+
+    // Handles are reused once released, so no link may outlive the order
+    auto peer = entry.watches.find(watch.ocoPeer);
+    if (watch.ocoPeer != INVALID_ORDER_HANDLE && peer != entry.watches.end()) {
+        peer->second.ocoPeer = INVALID_ORDER_HANDLE;
     }
-}
\ No newline at end of file
+    auto unlinkFrom = [handle](auto& parent) {
+        if (parent.takeProfit == handle) {
+            parent.takeProfit = INVALID_ORDER_HANDLE;
+        }
+        if (parent.stopLoss == handle) {
+            parent.stopLoss = INVALID_ORDER_HANDLE;
+        }
+    };
+    if (watch.bracketEntry != INVALID_ORDER_HANDLE) {
+        auto parent = entry.watches.find(watch.bracketEntry);
+        auto firedParent = entry.firedBrackets.find(watch.bracketEntry);
+        if (parent != entry.watches.end()) {
+            unlinkFrom(parent->second);
+        } else if (firedParent != entry.firedBrackets.end()) {
+            unlinkFrom(firedParent->second);
+        }
+    }
+    watchedCount.fetch_sub(1, std::memory_order_relaxed);
+    orderPool.release(handle);
+
+    for (OrderHandle exit : {watch.takeProfit, watch.stopLoss}) {
+        if (exit != INVALID_ORDER_HANDLE && entry.watches.count(exit)) {
+            dropWatch(entry, exit);
+        }
+    }
+}
+
+void MarketDataIntegrator::release(InstrumentTriggers& entry, const std::vector<OrderHandle>& fired) {
+    for (OrderHandle handle : fired) {
+        double price = orderPool.get(handle).price;
+
+        // Execution now owns the slot; if its queue is full, keep the triggered
+        // order and retry on the next book update
+        if (!executionManager.addOrder(handle)) {
+            std::lock_guard<std::mutex> lock(entry.mutex);
+            entry.unsent.push_back(handle);
+            entry.count.fetch_add(1, std::memory_order_release);
+            continue;
+        }
+        watchedCount.fetch_sub(1, std::memory_order_relaxed);
+        Logger::info("Price condition met for order: ", handle, " at price: ", price);
+    }
+}
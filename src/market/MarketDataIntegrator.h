@@ -3,38 +3,131 @@
 #define MARKET_DATA_INTEGRATOR_H
 
 #include "MarketDataManager.h"
+#include "TriggerLadder.h"
 #include "../execution/ExecutionManager.h"
-#include "../orders/models/Order.h"
-#include <map>
+#include "../orders/models/order.h"
+#include "../orders/models/OrderPool.h"
+#include <atomic>
+#include <functional>
+#include <initializer_list>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
+// Releases watched orders to execution when the market reaches them. Each
+// instrument keeps trigger ladders sorted by price, evaluated on the market
+// data thread whenever its top of book changes, so only crossed triggers are
+// touched and nothing polls. Besides plain price watches this runs stops,
+// stop-limits, trailing stops, one-cancels-other pairs and brackets locally,
+// without waiting on exchange-side triggers.
 class MarketDataIntegrator {
 public:
-    MarketDataIntegrator(MarketDataManager& mdManager, ExecutionManager& execManager);
-    
+    enum class TriggerType : uint8_t {
+        // Limit orders fire once the market reaches their price, market orders
+        // at once; both are sent at the triggering price
+        Price,
+        // Fires once the market trades through triggerPrice: buys when the best
+        // ask rises to it, sells when the best bid falls to it. Market orders
+        // become stop-markets, limit orders stop-limits that keep their price.
+        Stop,
+        // A stop that trails the best price seen since it was armed (the lowest
+        // ask for buys, the highest bid for sells) by trailingOffset
+        TrailingStop
+    };
+
+    struct Trigger {
+        TriggerType type = TriggerType::Price;
+        double triggerPrice = 0;    // Stop
+        double trailingOffset = 0;  // TrailingStop
+    };
+
+    MarketDataIntegrator(MarketDataManager& mdManager, ExecutionManager& execManager, OrderPool& orderPool);
+    ~MarketDataIntegrator();
+
     void start();
     void stop();
-    void addOrderForPriceWatch(const Order& order);
-    void removeOrderFromWatch(const std::string& orderId);
+    // Each add takes ownership of the pooled orders until they are triggered or
+    // removed. The bool overloads release the orders and return false when the
+    // request is invalid; linked orders must share an instrument.
+    void addOrderForPriceWatch(OrderHandle handle);
+    bool addConditionalOrder(OrderHandle handle, const Trigger& trigger);
+    // Whichever order fires first removes the other
+    bool addOcoOrders(OrderHandle first, const Trigger& firstTrigger, OrderHandle second, const Trigger& secondTrigger);
+    // The take-profit (a price watch at its limit) and the stop-loss are armed
+    // as an OCO pair once the entry's reports show it filled, sized to the
+    // filled amount and grown with later fills. An entry that finishes without
+    // a fill drops them, as does removing the entry before it fires.
+    bool addBracketOrder(OrderHandle entry, const Trigger& entryTrigger, OrderHandle takeProfit,
+                         OrderHandle stopLoss, const Trigger& stopLossTrigger);
+    void removeOrderFromWatch(OrderHandle handle);
+    // Execution report or order update for a pooled order, before its slot is
+    // released; final when the report is the last one for the slot
+    void onOrderReport(OrderHandle handle, bool final);
+    size_t watchedOrderCount() const { return watchedCount.load(std::memory_order_relaxed); }
 
 private:
     MarketDataManager& marketDataManager;
     ExecutionManager& executionManager;
+    OrderPool& orderPool;
     std::atomic<bool> running;
-    std::thread watchThread;
-    
-    struct OrderWatch {
-        Order order;
-        double targetPrice;
-        std::chrono::system_clock::time_point timestamp;
+    MarketDataManager::ListenerId bookListener;
+
+    struct Watch {
+        Trigger trigger;
+        bool armed = true;  // false for bracket exits until their entry fills
+        OrderHandle ocoPeer = INVALID_ORDER_HANDLE;
+        OrderHandle takeProfit = INVALID_ORDER_HANDLE;  // bracket entries only
+        OrderHandle stopLoss = INVALID_ORDER_HANDLE;
+        OrderHandle bracketEntry = INVALID_ORDER_HANDLE;  // pending bracket exits only
+    };
+
+    // A bracket entry handed to execution, waiting for its fills
+    struct FiredBracket {
+        OrderHandle takeProfit = INVALID_ORDER_HANDLE;
+        OrderHandle stopLoss = INVALID_ORDER_HANDLE;
+        double armedAmount = 0;  // the exits' current size
+    };
+
+    struct InstrumentTriggers {
+        std::mutex mutex;
+        // Price watches: buys fire when the best ask falls to the trigger, sells when the bid rises to it
+        TriggerLadder<std::greater<double>> buyTriggers;
+        TriggerLadder<std::less<double>> sellTriggers;
+        // Stops: buys fire when the best ask rises to the trigger, sells when the bid falls to it
+        TriggerLadder<std::less<double>> buyStops;
+        TriggerLadder<std::greater<double>> sellStops;
+        TrailingLadder buyTrailingStops;  // on the negated ask
+        TrailingLadder sellTrailingStops;
+        std::unordered_map<OrderHandle, Watch> watches;
+        std::unordered_map<OrderHandle, FiredBracket> firedBrackets;  // by entry
+        std::vector<OrderHandle> unsent;  // triggered while the execution queue was full
+        double lastBid = 0;
+        double lastAsk = 0;
+        std::atomic<size_t> count{0};  // armed plus unsent; lets book updates skip idle instruments unlocked
     };
-    
-    std::map<std::string, OrderWatch> watchedOrders;
-    std::mutex watchMutex;
-    
-    void watchLoop();
-    void checkPriceConditions();
-    bool isPriceConditionMet(const Order& order, double currentPrice);
+
+    // Indexed by InstrumentId
+    std::unique_ptr<InstrumentTriggers[]> triggers;
+    std::atomic<size_t> watchedCount{0};
+    std::atomic<size_t> firedBracketCount{0};  // lets reports for other orders skip the lock
+
+    using WatchRequest = std::pair<OrderHandle, Watch>;
+    bool addWatches(std::initializer_list<WatchRequest> requests);
+    void onBookUpdate(InstrumentId instrument, const OrderBook& book);
+
+    // The helpers below expect the instrument's mutex to be held
+    void collectTriggered(InstrumentTriggers& entry, std::vector<OrderHandle>& fired);
+    void onTriggered(InstrumentTriggers& entry, OrderHandle handle, double reference, std::vector<OrderHandle>& fired);
+    // Stops waiting on a fired entry's fills; exits still unarmed are dropped
+    void finishBracket(InstrumentTriggers& entry, OrderHandle handle);
+    void arm(InstrumentTriggers& entry, OrderHandle handle, const Watch& watch);
+    void disarm(InstrumentTriggers& entry, OrderHandle handle, const Watch& watch);
+    // Unlinks and frees a watched order, with its pending bracket exits
+    void dropWatch(InstrumentTriggers& entry, OrderHandle handle);
+    static double trailingReference(const InstrumentTriggers& entry, bool buy);
+
+    void release(InstrumentTriggers& entry, const std::vector<OrderHandle>& fired);
 };
 
-#endif
\ No newline at end of file
+#endif
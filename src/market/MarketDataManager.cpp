@@ -1,211 +1,89 @@
 #include "MarketDataManager.h"
-#include <iostream>
-#include <sstream>
-#include <curl/curl.h>
-#include "MarketDataManager.h"
 #include "../include/Logger.h"
 #include <json/json.h>
-
-// Constructor
-MarketDataManager::MarketDataManager(AuthManager& authManager) : authManager(authManager) {}
+#include <algorithm>
+#include <sstream>
 
 // Helper function to perform HTTP POST requests
-std::string MarketDataManager::postRequest(const std::string& endpoint, const std::string& payload) {
-    std::string apiUrl = "https://test.deribit.com/api/v2/" + endpoint;
-    CURL* curl = curl_easy_init();
-    std::string response;
-
-    if (curl) {
-        // Set curl options
-        curl_easy_setopt(curl, CURLOPT_URL, apiUrl.c_str());
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload.c_str());
-        
-        // Callback to capture the response
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, [](char* ptr, size_t size, size_t nmemb, std::string* data) {
-            data->append(ptr, size * nmemb);
-            return size * nmemb;
-        });
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-
-        // Include Bearer token for authentication
-        struct curl_slist* headers = nullptr;
-        std::string bearerToken = "Authorization: Bearer " + authManager.getAccessToken();
-        headers = curl_slist_append(headers, "Content-Type: application/json");
-        headers = curl_slist_append(headers, bearerToken.c_str());
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-
-        // Perform request
-        CURLcode res = curl_easy_perform(curl);
-        if (res != CURLE_OK) {
-            std::cerr << "CURL Error: " << curl_easy_strerror(res) << std::endl;
+void MarketDataManager::postRequest(const std::string& endpoint, const std::string& payload,
+                                    AsyncHttpClient::Callback callback) {
+    AsyncHttpClient::Request request;
+    request.target = "/api/v2/" + endpoint;
+    request.body = payload;
+    request.headers = {
+        {"Authorization", "Bearer " + authManager.getAccessToken()},
+        {"Content-Type", "application/json"}
+    };
+
+    restClient.post(std::move(request), [endpoint, callback = std::move(callback)](AsyncHttpClient::Response& response) {
+        if (!response.error.empty()) {
+            Logger::error("Request to ", endpoint, " failed: ", response.error);
         }
-
-        // Cleanup
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-    }
-
-    return response;
+        callback(response);
+    });
 }
 
-// Fetch the orderbook for a specific instrument
-bool MarketDataManager::getOrderBook(const std::string& instrumentName) {
-    // Construct API request
-    std::string endpoint = "public/get_order_book";
-
-    Json::Value request;
-    request["jsonrpc"] = "2.0";
-    request["id"] = 3;
-    request["method"] = endpoint;
-
-    Json::Value params;
-    params["instrument_name"] = instrumentName;
-    request["params"] = params;
-
-    // Convert JSON to string
-    Json::StreamWriterBuilder writer;
-    std::string payload = Json::writeString(writer, request);
-
-    // Make the API call
-    std::string response = postRequest(endpoint, payload);
-
-    // Parse the response
-    Json::CharReaderBuilder reader;
-    Json::Value jsonResponse;
-    std::string errs;
-
-    std::istringstream responseStream(response);
-    if (!Json::parseFromStream(reader, responseStream, &jsonResponse, &errs)) {
-        std::cerr << "Error parsing order book response: " << errs << std::endl;
-        return false;
-    }
-
-    if (jsonResponse["result"].isObject()) {
-        Json::Value result = jsonResponse["result"];
-
-        // Display orderbook details
-        std::cout << "Orderbook for " << instrumentName << ":" << std::endl;
-
-        std::cout << "Asks:" << std::endl;
-        for (const auto& ask : result["asks"]) {
-            std::cout << "Price: " << ask[0].asDouble() << ", Size: " << ask[1].asDouble() << std::endl;
-        }
-
-        std::cout << "Bids:" << std::endl;
-        for (const auto& bid : result["bids"]) {
-            std::cout << "Price: " << bid[0].asDouble() << ", Size: " << bid[1].asDouble() << std::endl;
-        }
-        return true;
-    } else {
-        std::cerr << "Failed to retrieve order book: "
-                  << jsonResponse["error"]["message"].asString() << std::endl;
-        return false;
+void MarketDataManager::getBookSnapshot(const std::string& instrument, size_t depth, BookSnapshotCallback callback) {
+    if (const OrderBook* book = getOrderBook(instrument)) {
+        BookSnapshot snapshot;
+        book->copyTop(depth, snapshot.bids, snapshot.asks);
+        snapshot.live = true;
+        callback(true, snapshot);
+        return;
     }
+    fetchBookSnapshot(instrument, depth, std::move(callback));
 }
 
-
-bool MarketDataManager::getPositions(const std::string& currency) {
-    // Construct API request
-    std::string endpoint = "private/get_positions";
-
+void MarketDataManager::fetchBookSnapshot(const std::string& instrument, size_t depth, BookSnapshotCallback callback) {
     Json::Value request;
     request["jsonrpc"] = "2.0";
-    request["id"] = 4;
-    request["method"] = endpoint;
-
-    Json::Value params;
-    params["currency"] = currency;
-    request["params"] = params;
+    request["id"] = 3;
+    request["method"] = "public/get_order_book";
+    request["params"]["instrument_name"] = instrument;
+    request["params"]["depth"] = static_cast<Json::UInt64>(depth);
 
-    // Convert JSON to string
     Json::StreamWriterBuilder writer;
-    std::string payload = Json::writeString(writer, request);
-
-    // Make the API call
-    std::string response = postRequest(endpoint, payload);
-
-    // Parse the response
-    Json::CharReaderBuilder reader;
-    Json::Value jsonResponse;
-    std::string errs;
-
-    std::istringstream responseStream(response);
-    if (!Json::parseFromStream(reader, responseStream, &jsonResponse, &errs)) {
-        std::cerr << "Error parsing positions response: " << errs << std::endl;
-        return false;
-    }
-
-    if (jsonResponse["result"].isArray()) {
-        Json::Value positions = jsonResponse["result"];
-
-        // Display positions
-        std::cout << "Open positions for currency: " << currency << std::endl;
-        for (const auto& position : positions) {
-            std::cout << "Instrument: " << position["instrument_name"].asString() << std::endl;
-            std::cout << "Size: " << position["size"].asDouble() << std::endl;
-            std::cout << "Average Price: " << position["average_price"].asDouble() << std::endl;
-            std::cout << "Direction: " << position["direction"].asString() << std::endl;
-            std::cout << "-----------------------------" << std::endl;
+    writer["indentation"] = "";
+    postRequest("public/get_order_book", Json::writeString(writer, request),
+                [instrument, depth, callback = std::move(callback)](AsyncHttpClient::Response& response) {
+        BookSnapshot snapshot;
+        Json::CharReaderBuilder reader;
+        Json::Value jsonResponse;
+        std::string errs;
+        std::istringstream responseStream(response.body);
+        if (!Json::parseFromStream(reader, responseStream, &jsonResponse, &errs) || !jsonResponse["result"].isObject()) {
+            Logger::error("Failed to fetch order book for ", instrument, ": ",
+                          errs.empty() ? jsonResponse["error"]["message"].asString() : errs);
+            callback(false, snapshot);
+            return;
         }
 
-        return true;
-    } else {
-        std::cerr << "Failed to retrieve positions: "
-                  << jsonResponse["error"]["message"].asString() << std::endl;
-        return false;
-    }
-}
-
-
-void MarketDataManager::startMarketDataStreaming(WebSocketServer& webSocketServer) {
-    using Client = websocketpp::client<websocketpp::config::asio_tls_client>;
-    Client client;
-
-    try {
-        client.init_asio();
-        client.set_tls_init_handler([](websocketpp::connection_hdl) {
-            return websocketpp::lib::make_shared<boost::asio::ssl::context>(boost::asio::ssl::context::tlsv1);
-        });
-
-        client.set_message_handler([&webSocketServer](websocketpp::connection_hdl, Client::message_ptr msg) {
-            // Parse the message and broadcast to clients
-            Json::Value jsonResponse;
-            std::string errs;
-            std::istringstream responseStream(msg->get_payload());
-
-            Json::CharReaderBuilder reader;
-            if (Json::parseFromStream(reader, responseStream, &jsonResponse, &errs)) {
-                if (jsonResponse["params"]["channel"].isString()) {
-                    std::string channel = jsonResponse["params"]["channel"].asString();
-                    std::string instrument = channel.substr(channel.find('.') + 1);
-
-                    webSocketServer.broadcastToSubscribers(instrument, msg->get_payload());
+        // Levels are [price, amount], best first
+        auto copyLevels = [depth](const Json::Value& levels, std::vector<std::pair<double, double>>& out) {
+            out.clear();
+            for (const auto& level : levels) {
+                if (out.size() == depth) {
+                    break;
+                }
+                if (level.isArray() && level.size() >= 2) {
+                    out.emplace_back(level[0].asDouble(), level[1].asDouble());
                 }
             }
-        });
-
-        websocketpp::lib::error_code ec;
-        Client::connection_ptr con = client.get_connection("wss://test.deribit.com/ws/api/v2", ec);
-        if (ec) {
-            std::cerr << "Connection error: " << ec.message() << std::endl;
-            return;
-        }
-
-        client.connect(con);
-        client.run();
-    } catch (const std::exception& e) {
-        std::cerr << "Error in market data streaming: " << e.what() << std::endl;
-    }
+        };
+        copyLevels(jsonResponse["result"]["bids"], snapshot.bids);
+        copyLevels(jsonResponse["result"]["asks"], snapshot.asks);
+        snapshot.live = false;
+        callback(true, snapshot);
+    });
 }
 
 // market/MarketDataManager.cpp updates
-void MarketDataManager::handleOrderBookUpdate(const std::string& instrument, const Json::Value& data) {
-    std::lock_guard<std::mutex> lock(orderBooksMutex);
-    
-    // Get or create order book for instrument
-    auto& orderBook = orderBooks[instrument];
+void MarketDataManager::handleOrderBookUpdate(InstrumentId instrument, const Json::Value& data) {
+    OrderBook* orderBook = books[instrument].live.load(std::memory_order_acquire);
     if (!orderBook) {
-        orderBook = std::make_shared<OrderBook>(instrument);
+        // First update for an instrument nobody subscribed to locally
+        std::lock_guard<std::mutex> lock(subscriptionMutex);
+        orderBook = publishBook(instrument);
     }
 
     // Update bids
@@ -229,6 +107,42 @@ void MarketDataManager::handleOrderBookUpdate(const std::string& instrument, con
             }
         }
     }
+
+    listenerEpoch.fetch_add(1, std::memory_order_acq_rel);
+    std::shared_ptr<const ListenerList> listeners = bookUpdateListeners.load(std::memory_order_acquire);
+    for (const auto& [id, listener] : *listeners) {
+        listener(instrument, *orderBook);
+    }
+    listenerEpoch.fetch_add(1, std::memory_order_release);
+}
+
+MarketDataManager::ListenerId MarketDataManager::addBookUpdateListener(BookUpdateListener listener) {
+    std::lock_guard<std::mutex> lock(listenersMutex);
+    auto updated = std::make_shared<ListenerList>(*bookUpdateListeners.load(std::memory_order_acquire));
+    ListenerId id = nextListenerId++;
+    updated->emplace_back(id, std::move(listener));
+    bookUpdateListeners.store(std::move(updated), std::memory_order_release);
+    return id;
+}
+
+void MarketDataManager::removeBookUpdateListener(ListenerId id) {
+    {
+        std::lock_guard<std::mutex> lock(listenersMutex);
+        auto updated = std::make_shared<ListenerList>(*bookUpdateListeners.load(std::memory_order_acquire));
+        auto it = std::find_if(updated->begin(), updated->end(), [id](const auto& entry) { return entry.first == id; });
+        if (it == updated->end()) {
+            return;
+        }
+        updated->erase(it);
+        bookUpdateListeners.store(std::move(updated), std::memory_order_release);
+    }
+    // An update that loaded the old list may still be calling it
+    uint64_t epoch = listenerEpoch.load(std::memory_order_acquire);
+    if (epoch & 1) {
+        while (listenerEpoch.load(std::memory_order_acquire) == epoch) {
+            std::this_thread::yield();
+        }
+    }
 }
 
 void MarketDataManager::processWebSocketMessage(const std::string& message) {
@@ -242,8 +156,13 @@ void MarketDataManager::processWebSocketMessage(const std::string& message) {
         if (data["method"].asString() == "subscription" && 
             data["params"]["channel"].asString().find("book.") == 0) {
             
-            std::string instrument = data["params"]["channel"].asString().substr(5);
-            handleOrderBookUpdate(instrument, data["params"]["data"]);
+            // book.BTC-PERPETUAL.100ms
+            const std::string& channel = data["params"]["channel"].asString();
+            std::string_view instrument = std::string_view(channel).substr(5);
+            InstrumentId instrumentId = InstrumentRegistry::instance().intern(instrument.substr(0, instrument.find('.')));
+            if (instrumentId != INVALID_INSTRUMENT) {
+                handleOrderBookUpdate(instrumentId, data["params"]["data"]);
+            }
         }
     }
     auto end = std::chrono::high_resolution_clock::now(); // End time
@@ -251,9 +170,30 @@ void MarketDataManager::processWebSocketMessage(const std::string& message) {
     Logger::info("Market data processing latency: ", latency.count(), " ms");
 }
 
-std::shared_ptr<OrderBook> MarketDataManager::getOrderBook(const std::string& instrument) {
-    std::lock_guard<std::mutex> lock(orderBooksMutex);
-    return orderBooks[instrument];
+const OrderBook* MarketDataManager::getOrderBook(InstrumentId instrument) const {
+    if (instrument >= InstrumentRegistry::MAX_INSTRUMENTS) {
+        return nullptr;
+    }
+    return books[instrument].live.load(std::memory_order_acquire);
+}
+
+const OrderBook* MarketDataManager::getOrderBook(const std::string& instrument) const {
+    return getOrderBook(InstrumentRegistry::instance().find(instrument));
+}
+
+OrderBook* MarketDataManager::publishBook(InstrumentId instrument) {
+    BookSlot& slot = books[instrument];
+    if (OrderBook* live = slot.live.load(std::memory_order_relaxed)) {
+        return live;
+    }
+    if (slot.book) {
+        // Retired by an unsubscribe; its levels are stale
+        slot.book->clear();
+    } else {
+        slot.book = std::make_unique<OrderBook>(InstrumentRegistry::instance().name(instrument).str());
+    }
+    slot.live.store(slot.book.get(), std::memory_order_release);
+    return slot.book.get();
 }
 
 void MarketDataManager::stopMarketDataStreaming() {
@@ -267,7 +207,8 @@ void MarketDataManager::stopMarketDataStreaming() {
 MarketDataManager::MarketDataManager(AuthManager& authManager) 
     : authManager(authManager), 
       webSocketServer(nullptr),
-      keepStreaming(false) {
+      keepStreaming(false),
+      books(std::make_unique<BookSlot[]>(InstrumentRegistry::MAX_INSTRUMENTS)) {
 }
 
 MarketDataManager::~MarketDataManager() {
@@ -305,8 +246,8 @@ void MarketDataManager::streamMarketData() {
     while (keepStreaming) {
         try {
             // Ensure authentication is valid
-            if (!authManager.refreshToken()) {
-                Logger::error("Failed to refresh authentication token");
+            if (!authManager.ensureValidToken()) {
+                Logger::error("No valid authentication token");
                 break;
             }
 
@@ -317,10 +258,10 @@ void MarketDataManager::streamMarketData() {
             subscriptionMsg["method"] = "public/subscribe";
 
             Json::Value channels(Json::arrayValue);
-            {
-                std::lock_guard<std::mutex> lock(orderBooksMutex);
-                for (const auto& [instrument, _] : orderBooks) {
-                    channels.append("book." + instrument + ".100ms"); // 100ms updates
+            const InstrumentRegistry& registry = InstrumentRegistry::instance();
+            for (InstrumentId instrument = 0; instrument < registry.size(); ++instrument) {
+                if (books[instrument].live.load(std::memory_order_acquire)) {
+                    channels.append("book." + registry.name(instrument).str() + ".100ms"); // 100ms updates
                 }
             }
 
@@ -344,9 +285,15 @@ void MarketDataManager::streamMarketData() {
 }
 
 void MarketDataManager::subscribeToInstrument(const std::string& instrument) {
-    std::lock_guard<std::mutex> lock(orderBooksMutex);
-    if (!orderBooks[instrument]) {
-        orderBooks[instrument] = std::make_shared<OrderBook>(instrument);
+    InstrumentId instrumentId = InstrumentRegistry::instance().intern(instrument);
+    if (instrumentId == INVALID_INSTRUMENT) {
+        Logger::error("Cannot subscribe to ", instrument, ": instrument table is full");
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(subscriptionMutex);
+    if (!books[instrumentId].live.load(std::memory_order_relaxed)) {
+        publishBook(instrumentId);
         Logger::info("Created new order book for instrument: ", instrument);
         
         // If streaming is active, send subscription request
@@ -358,14 +305,21 @@ void MarketDataManager::subscribeToInstrument(const std::string& instrument) {
             
             Json::StreamWriterBuilder writer;
             std::string payload = Json::writeString(writer, subscriptionMsg);
-            webSocketServer->broadcastToSubscribers(instrument, payload);
+            webSocketServer->broadcastToSubscribers(instrumentId, payload);
         }
     }
 }
 
 void MarketDataManager::unsubscribeFromInstrument(const std::string& instrument) {
-    std::lock_guard<std::mutex> lock(orderBooksMutex);
-    orderBooks.erase(instrument);
+    InstrumentId instrumentId = InstrumentRegistry::instance().find(instrument);
+    if (instrumentId == INVALID_INSTRUMENT) {
+        return;
+    }
+    {
+        // Readers holding the book keep a valid, no longer updated pointer
+        std::lock_guard<std::mutex> lock(subscriptionMutex);
+        books[instrumentId].live.store(nullptr, std::memory_order_release);
+    }
     Logger::info("Removed order book for instrument: ", instrument);
     
     if (keepStreaming && webSocketServer) {
@@ -376,6 +330,6 @@ void MarketDataManager::unsubscribeFromInstrument(const std::string& instrument)
         
         Json::StreamWriterBuilder writer;
         std::string payload = Json::writeString(writer, unsubscribeMsg);
-        webSocketServer->broadcastToSubscribers(instrument, payload);
+        webSocketServer->broadcastToSubscribers(instrumentId, payload);
     }
 }
\ No newline at end of file
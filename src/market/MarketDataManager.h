@@ -3,13 +3,19 @@
 #define MARKETDATAMANAGER_H
 
 #include "auth/AuthManager.h"
+#include "auth/utils/AsyncHttpClient.h"
 #include "websocket/WebSocketServer.h"
 #include "models/orderBook.h"
+#include "InstrumentRegistry.h"
+#include <json/json.h>
 #include <string>
 #include <thread>
 #include <atomic>
-#include <unordered_map>
+#include <mutex>
 #include <memory>
+#include <functional>
+#include <utility>
+#include <vector>
 
 class MarketDataManager {
 public:
@@ -19,25 +25,72 @@ public:
     void startMarketDataStreaming(WebSocketServer& webSocketServer);
     void stopMarketDataStreaming();
     
-    // New methods for order book management
-    std::shared_ptr<OrderBook> getOrderBook(const std::string& instrument);
+    // Wait-free: one atomic load from a slot indexed by InstrumentId. Null
+    // when the instrument has no live book. Books are kept until the manager
+    // is destroyed, so a pointer stays valid after an unsubscribe; the book
+    // just stops updating.
+    const OrderBook* getOrderBook(InstrumentId instrument) const;
+    // Adds the registry's name lookup
+    const OrderBook* getOrderBook(const std::string& instrument) const;
+    struct BookSnapshot {
+        std::vector<std::pair<double, double>> bids;  // price, amount; best first
+        std::vector<std::pair<double, double>> asks;
+        bool live = false;  // false when fetched over REST
+    };
+    // fetched is false when the REST fetch failed
+    using BookSnapshotCallback = std::function<void(bool fetched, BookSnapshot& snapshot)>;
+    // The top depth levels of the streamed local book, passed to the callback
+    // before this returns. Only an instrument without one is fetched over
+    // REST, so reads of subscribed books cost microseconds and no rate-limit
+    // credits; the callback for a fetch runs on the I/O thread and must not block.
+    void getBookSnapshot(const std::string& instrument, size_t depth, BookSnapshotCallback callback);
+    // Always from the exchange, e.g. to check the local book against it
+    void fetchBookSnapshot(const std::string& instrument, size_t depth, BookSnapshotCallback callback);
+    // Publish or retire one instrument's book without blocking readers or
+    // the updates of any other book
     void subscribeToInstrument(const std::string& instrument);
     void unsubscribeFromInstrument(const std::string& instrument);
 
+    // Runs on the market data thread after each applied book update. The
+    // list is copied on write, so listeners may come and go while streaming;
+    // once remove returns the listener is not running and never runs again.
+    // Never remove a listener from inside one.
+    using BookUpdateListener = std::function<void(InstrumentId, const OrderBook&)>;
+    using ListenerId = uint64_t;
+    ListenerId addBookUpdateListener(BookUpdateListener listener);
+    void removeBookUpdateListener(ListenerId id);
+
 private:
     AuthManager& authManager;
+    AsyncHttpClient restClient{"https://test.deribit.com"};
     WebSocketServer* webSocketServer;
     std::atomic<bool> keepStreaming;
     std::thread streamingThread;
 
     
     
-    // Order book management
-    std::unordered_map<std::string, std::shared_ptr<OrderBook>> orderBooks;
-    mutable std::mutex orderBooksMutex;
+    // Each book is written by the market data thread alone, under its own
+    // lock; the registry lock below is only taken to create, publish or
+    // retire a book, never to find one.
+    struct BookSlot {
+        std::atomic<OrderBook*> live{nullptr};  // published while subscribed
+        std::unique_ptr<OrderBook> book;        // created once, on first use
+    };
+    std::unique_ptr<BookSlot[]> books;  // indexed by InstrumentId
+    std::mutex subscriptionMutex;
+    using ListenerList = std::vector<std::pair<ListenerId, BookUpdateListener>>;
+    std::atomic<std::shared_ptr<const ListenerList>> bookUpdateListeners{std::make_shared<const ListenerList>()};
+    std::mutex listenersMutex;  // serializes writers
+    ListenerId nextListenerId = 1;  // guarded by listenersMutex
+    // Odd while the market data thread is calling listeners
+    std::atomic<uint64_t> listenerEpoch{0};
 
     void streamMarketData();
-    void handleOrderBookUpdate(const std::string& instrument, const Json::Value& data);
+    // The callback runs on the I/O thread and gets an empty body on failure
+    void postRequest(const std::string& endpoint, const std::string& payload, AsyncHttpClient::Callback callback);
+    // Publishes the instrument's book, creating it if needed; call with subscriptionMutex held
+    OrderBook* publishBook(InstrumentId instrument);
+    void handleOrderBookUpdate(InstrumentId instrument, const Json::Value& data);
     void processWebSocketMessage(const std::string& message);
 };
 
@@ -0,0 +1,253 @@
+#include "ReferenceData.h"
+#include "../auth/utils/AsyncHttpClient.h"
+#include "../include/Logger.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <type_traits>
+
+namespace {
+
+constexpr char CACHE_MAGIC[8] = {'I', 'N', 'S', 'T', 'R', 'E', 'F', '1'};
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t recordSize;  // a layout change invalidates older files
+    uint32_t count;
+    int64_t writtenAtMs;
+};
+
+struct CacheRecord {
+    InstrumentRegistry::Name name;
+    InstrumentInfo info;
+};
+
+static_assert(std::is_trivially_copyable<CacheRecord>::value, "Cache records are copied as raw bytes");
+
+int64_t toMillis(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+}
+
+ReferenceData::ReferenceData() : ReferenceData(Options()) {}
+
+ReferenceData::ReferenceData(const Options& options) : options(options) {}
+
+bool ReferenceData::load() {
+    int cached = loadCache();
+    if (cached >= 0 && std::chrono::system_clock::now() - cacheWrittenAt < options.maxCacheAge) {
+        return true;
+    }
+
+    int fetched = fetch();
+    if (fetched > 0) {
+        saveCache();
+        return true;
+    }
+    if (cached >= 0) {
+        Logger::warning("Instrument reference data could not be refreshed, using the cache from ",
+                        toMillis(cacheWrittenAt));
+        return true;
+    }
+    Logger::error("No instrument reference data available");
+    return false;
+}
+
+int ReferenceData::loadCache() {
+    auto start = std::chrono::steady_clock::now();
+    int fd = open(options.cachePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(CacheHeader)) {
+        close(fd);
+        Logger::warning("Instrument cache ", options.cachePath, " is truncated, ignoring it");
+        return -1;
+    }
+    size_t size = static_cast<size_t>(status.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        Logger::warning("Could not map instrument cache ", options.cachePath, ": ", std::strerror(errno));
+        return -1;
+    }
+    const char* data = static_cast<const char*>(mapping);
+
+    CacheHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.recordSize != sizeof(CacheRecord) ||
+        size != sizeof(CacheHeader) + static_cast<size_t>(header.count) * sizeof(CacheRecord)) {
+        munmap(mapping, size);
+        Logger::warning("Instrument cache ", options.cachePath, " has an unknown layout, ignoring it");
+        return -1;
+    }
+
+    int defined = 0;
+    const char* next = data + sizeof(CacheHeader);
+    for (uint32_t i = 0; i < header.count; ++i, next += sizeof(CacheRecord)) {
+        CacheRecord record;
+        std::memcpy(&record, next, sizeof(record));
+        // Names are NUL-terminated in the file; anything else is corrupt
+        if (!std::memchr(next, '\0', sizeof(record.name)) ||
+            static_cast<size_t>(record.info.instrumentClass) >= INSTRUMENT_CLASS_COUNT) {
+            continue;
+        }
+        if (InstrumentRegistry::instance().define(record.name.view(), record.info) != INVALID_INSTRUMENT) {
+            ++defined;
+        }
+    }
+    munmap(mapping, size);
+
+    cacheWrittenAt = std::chrono::system_clock::time_point(std::chrono::milliseconds(header.writtenAtMs));
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    Logger::info("Loaded ", defined, " instruments from ", options.cachePath, " in ", elapsed.count(), " us");
+    return defined;
+}
+
+int ReferenceData::fetch() {
+    std::string origin;
+    std::string target;
+    if (!AsyncHttpClient::splitUrl(options.apiUrl, origin, target)) {
+        Logger::error("Invalid instruments URL: ", options.apiUrl);
+        return -1;
+    }
+    AsyncHttpClient client(origin);
+
+    // Every currency is requested at once; responses are applied in order so IDs stay deterministic
+    std::vector<std::future<AsyncHttpClient::Response>> pending;
+    for (const std::string& currency : options.currencies) {
+        Json::Value request;
+        request["jsonrpc"] = "2.0";
+        request["id"] = 1;
+        request["method"] = "public/get_instruments";
+        request["params"]["currency"] = currency;
+        request["params"]["expired"] = false;
+
+        Json::StreamWriterBuilder writer;
+        writer["indentation"] = "";
+        AsyncHttpClient::Request httpRequest;
+        httpRequest.target = target;
+        httpRequest.body = Json::writeString(writer, request);
+        httpRequest.headers = {{"Content-Type", "application/json"}};
+        httpRequest.timeout = std::chrono::milliseconds(options.timeoutMs);
+        pending.push_back(client.post(std::move(httpRequest)));
+    }
+
+    int defined = 0;
+    for (size_t i = 0; i < pending.size(); ++i) {
+        const std::string& currency = options.currencies[i];
+        AsyncHttpClient::Response httpResponse = pending[i].get();
+        if (!httpResponse.error.empty()) {
+            Logger::error("Failed to fetch instruments for ", currency, ": ", httpResponse.error);
+            return -1;
+        }
+        const std::string& response = httpResponse.body;
+
+        Json::CharReaderBuilder reader;
+        Json::Value jsonResponse;
+        std::string errs;
+        std::istringstream responseStream(response);
+        if (!Json::parseFromStream(reader, responseStream, &jsonResponse, &errs) || !jsonResponse["result"].isArray()) {
+            Logger::error("Failed to fetch instruments for ", currency, ": ",
+                          errs.empty() ? jsonResponse["error"]["message"].asString() : errs);
+            return -1;
+        }
+
+        std::string name;
+        for (const auto& entry : jsonResponse["result"]) {
+            InstrumentInfo info;
+            if (parseInstrument(entry, name, info) &&
+                InstrumentRegistry::instance().define(name, info) != INVALID_INSTRUMENT) {
+                ++defined;
+            }
+        }
+    }
+    Logger::info("Fetched reference data for ", defined, " instruments");
+    return defined;
+}
+
+bool ReferenceData::saveCache() const {
+    InstrumentRegistry& registry = InstrumentRegistry::instance();
+    std::vector<CacheRecord> records;
+    records.reserve(registry.size());
+    // In ID order, so the next start hands out the same IDs
+    for (InstrumentId id = 0; id < registry.size(); ++id) {
+        if (const InstrumentInfo* info = registry.info(id)) {
+            records.push_back(CacheRecord{registry.name(id), *info});
+        }
+    }
+
+    CacheHeader header;
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.recordSize = sizeof(CacheRecord);
+    header.count = static_cast<uint32_t>(records.size());
+    header.writtenAtMs = toMillis(std::chrono::system_clock::now());
+    size_t size = sizeof(CacheHeader) + records.size() * sizeof(CacheRecord);
+
+    // Written beside the cache and renamed over it, so a reader never maps half a file
+    std::string temporaryPath = options.cachePath + ".tmp";
+    int fd = open(temporaryPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0 || ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        Logger::error("Could not write instrument cache ", temporaryPath, ": ", std::strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+        }
+        return false;
+    }
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        Logger::error("Could not map instrument cache ", temporaryPath, ": ", std::strerror(errno));
+        return false;
+    }
+    char* data = static_cast<char*>(mapping);
+    std::memcpy(data, &header, sizeof(header));
+    std::memcpy(data + sizeof(header), records.data(), records.size() * sizeof(CacheRecord));
+    munmap(mapping, size);
+
+    if (std::rename(temporaryPath.c_str(), options.cachePath.c_str()) != 0) {
+        Logger::error("Could not replace instrument cache ", options.cachePath, ": ", std::strerror(errno));
+        return false;
+    }
+    Logger::info("Saved reference data for ", records.size(), " instruments to ", options.cachePath);
+    return true;
+}
+
+bool ReferenceData::parseInstrument(const Json::Value& entry, std::string& name, InstrumentInfo& info) {
+    name = entry["instrument_name"].asString();
+    const std::string& kind = entry["kind"].asString();
+    if (name.empty()) {
+        return false;
+    }
+    if (kind == "option" || kind == "option_combo") {
+        info.instrumentClass = InstrumentClass::Option;
+    } else if (kind == "future" || kind == "future_combo") {
+        info.instrumentClass = entry["settlement_period"].asString() == "perpetual" ? InstrumentClass::Perpetual
+                                                                                    : InstrumentClass::Future;
+    } else if (kind == "spot") {
+        info.instrumentClass = InstrumentClass::Spot;
+    } else {
+        return false;
+    }
+
+    info.inverse = entry["instrument_type"].asString() == "reversed";
+    info.call = entry["option_type"].asString() == "call";
+    info.tickSize = entry["tick_size"].asDouble();
+    info.contractSize = entry["contract_size"].asDouble();
+    info.minTradeAmount = entry["min_trade_amount"].asDouble();
+    info.strike = entry["strike"].asDouble();
+    // Perpetuals carry a far-future expiration_timestamp
+    bool expires = info.instrumentClass == InstrumentClass::Future || info.instrumentClass == InstrumentClass::Option;
+    info.expiry = expires ? entry["expiration_timestamp"].asInt64() : 0;
+    info.baseCurrency = entry["base_currency"].asString();
+    info.quoteCurrency = entry["quote_currency"].asString();
+    info.settlementCurrency = entry["settlement_currency"].asString();
+    return true;
+}
@@ -0,0 +1,49 @@
+// market/ReferenceData.h
+#ifndef REFERENCE_DATA_H
+#define REFERENCE_DATA_H
+
+#include "InstrumentRegistry.h"
+#include <json/json.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Loads every instrument's reference data from public/get_instruments into
+// the InstrumentRegistry, so each one has its dense ID and tick size,
+// contract size and expiry before the first book or order arrives. The result
+// is kept in a flat file of fixed-size records that is memory-mapped on the
+// next start: with a fresh cache, startup defines every instrument without a
+// request and in the order of the previous run, so IDs stay the same.
+class ReferenceData {
+public:
+    struct Options {
+        std::string apiUrl = "https://test.deribit.com/api/v2/public/get_instruments";
+        std::vector<std::string> currencies{"any"};
+        std::string cachePath = "instruments.cache";
+        // An older cache is still loaded, then refreshed from the exchange
+        std::chrono::hours maxCacheAge{24};
+        long timeoutMs = 10000;
+    };
+
+    ReferenceData();
+    explicit ReferenceData(const Options& options);
+
+    // The cache when fresh, otherwise the exchange, falling back to a stale
+    // cache when the exchange cannot be reached. Returns false only when
+    // neither worked.
+    bool load();
+    // Each returns how many instruments were defined, or -1 on failure
+    int loadCache();
+    int fetch();
+    // Writes every instrument with reference data; replaces the file atomically
+    bool saveCache() const;
+
+    // A public/get_instruments entry; false when it is not usable
+    static bool parseInstrument(const Json::Value& entry, std::string& name, InstrumentInfo& info);
+
+private:
+    Options options;
+    std::chrono::system_clock::time_point cacheWrittenAt{};
+};
+
+#endif
@@ -0,0 +1,188 @@
+// market/TriggerLadder.h
+#ifndef TRIGGER_LADDER_H
+#define TRIGGER_LADDER_H
+
+#include "../orders/models/OrderPool.h"
+#include <functional>
+#include <map>
+#include <memory>
+#include <unordered_map>
+
+// Watched orders for one instrument and one trigger direction, sorted so the
+// next order to fire is always at the front. With Compare = std::less an
+// entry fires once the reference price rises to its trigger; with
+// std::greater once it falls to it. Insert and remove are O(log n), and a
+// price change only touches the entries it actually crosses. Not thread-safe.
+template <typename Compare>
+class TriggerLadder {
+public:
+    void add(OrderHandle handle, double trigger) {
+        remove(handle);
+        index[handle] = entries.emplace(trigger, handle);
+    }
+
+    bool remove(OrderHandle handle) {
+        auto it = index.find(handle);
+        if (it == index.end()) {
+            return false;
+        }
+        entries.erase(it->second);
+        index.erase(it);
+        return true;
+    }
+
+    bool contains(OrderHandle handle) const { return index.count(handle) > 0; }
+
+    // Removes every entry crossed by the reference price and passes it to
+    // fire(handle, trigger)
+    template <typename Fire>
+    void popCrossed(double reference, Fire&& fire) {
+        Compare beyond;
+        while (!entries.empty() && !beyond(reference, entries.begin()->first)) {
+            auto front = entries.begin();
+            OrderHandle handle = front->second;
+            double trigger = front->first;
+            index.erase(handle);
+            entries.erase(front);
+            fire(handle, trigger);
+        }
+    }
+
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+private:
+    std::multimap<double, OrderHandle, Compare> entries;
+    std::unordered_map<OrderHandle, typename std::multimap<double, OrderHandle, Compare>::iterator> index;
+};
+
+// Trailing stops for one instrument and side, in sell-stop terms: each entry
+// remembers the highest reference price since it was added (its peak) and
+// fires once the reference falls offset below that peak. Buy-side trailing
+// stops use the same ladder on negated prices.
+//
+// Entries sharing a peak are grouped in a bucket sorted by offset, so each
+// bucket has a single next stop. A new high merges every bucket below it into
+// the largest of them; an entry therefore changes bucket O(log n) times over
+// its life instead of being updated on every tick, and a fall only touches
+// the entries it crosses. Not thread-safe.
+class TrailingLadder {
+public:
+    void add(OrderHandle handle, double offset, double reference) {
+        remove(handle);
+        auto found = buckets.find(reference);
+        if (found == buckets.end()) {
+            auto bucket = std::make_unique<Bucket>();
+            bucket->peak = reference;
+            found = buckets.emplace(reference, std::move(bucket)).first;
+        }
+        Bucket* bucket = found->second.get();
+        index[handle] = {bucket, bucket->byOffset.emplace(offset, handle)};
+        refreshStop(bucket);
+    }
+
+    bool remove(OrderHandle handle) {
+        auto it = index.find(handle);
+        if (it == index.end()) {
+            return false;
+        }
+        Bucket* bucket = it->second.bucket;
+        bucket->byOffset.erase(it->second.position);
+        index.erase(it);
+        refreshStop(bucket);
+        return true;
+    }
+
+    bool contains(OrderHandle handle) const { return index.count(handle) > 0; }
+
+    // Raises the peaks below the reference, then removes every entry whose
+    // stop the reference has reached and passes it to fire(handle, stop).
+    // fire may add or remove other entries.
+    template <typename Fire>
+    void update(double reference, Fire&& fire) {
+        raisePeaks(reference);
+        while (!stops.empty() && stops.begin()->first >= reference) {
+            double stop = stops.begin()->first;
+            Bucket* bucket = stops.begin()->second;
+            auto front = bucket->byOffset.begin();
+            OrderHandle handle = front->second;
+            bucket->byOffset.erase(front);
+            index.erase(handle);
+            refreshStop(bucket);
+            fire(handle, stop);
+        }
+    }
+
+    size_t size() const { return index.size(); }
+    bool empty() const { return index.empty(); }
+
+private:
+    struct Bucket;
+    using StopMap = std::multimap<double, Bucket*, std::greater<double>>;
+
+    struct Bucket {
+        double peak = 0;
+        std::multimap<double, OrderHandle> byOffset;
+        StopMap::iterator stop;
+        bool hasStop = false;
+    };
+
+    struct Location {
+        Bucket* bucket;
+        std::multimap<double, OrderHandle>::iterator position;
+    };
+
+    std::map<double, std::unique_ptr<Bucket>> buckets;  // by peak
+    StopMap stops;                                      // each bucket's next stop, highest first
+    std::unordered_map<OrderHandle, Location> index;
+
+    // Re-indexes a bucket's next stop after a change, dropping it once empty
+    void refreshStop(Bucket* bucket) {
+        if (bucket->hasStop) {
+            stops.erase(bucket->stop);
+            bucket->hasStop = false;
+        }
+        if (bucket->byOffset.empty()) {
+            buckets.erase(bucket->peak);
+            return;
+        }
+        bucket->stop = stops.emplace(bucket->peak - bucket->byOffset.begin()->first, bucket);
+        bucket->hasStop = true;
+    }
+
+    void raisePeaks(double reference) {
+        if (buckets.empty() || buckets.begin()->first >= reference) {
+            return;
+        }
+        auto end = buckets.upper_bound(reference);
+        auto largest = buckets.begin();
+        for (auto it = buckets.begin(); it != end; ++it) {
+            if (it->second->byOffset.size() > largest->second->byOffset.size()) {
+                largest = it;
+            }
+        }
+
+        // Node transfers keep the moved entries' iterators valid
+        std::unique_ptr<Bucket> target = std::move(largest->second);
+        for (auto it = buckets.begin(); it != end; ++it) {
+            Bucket* source = it->second.get();
+            if (!source) {
+                continue;
+            }
+            for (const auto& [offset, handle] : source->byOffset) {
+                index.find(handle)->second.bucket = target.get();
+            }
+            target->byOffset.merge(source->byOffset);
+            if (source->hasStop) {
+                stops.erase(source->stop);
+            }
+        }
+        buckets.erase(buckets.begin(), end);
+
+        target->peak = reference;
+        Bucket* merged = buckets.emplace(reference, std::move(target)).first->second.get();
+        refreshStop(merged);
+    }
+};
+
+#endif
@@ -48,7 +48,8 @@ double OrderBook::getMidPrice() const {
     if (bids.empty() || asks.empty()) {
         return 0.0;
     }
-    return (getBestBid() + getBestAsk()) / 2.0;
+    // Read the maps directly; the getters would re-lock bookMutex
+    return (bids.rbegin()->first + asks.begin()->first) / 2.0;
 }
 
 double OrderBook::getSpread() const {
@@ -56,7 +57,32 @@ double OrderBook::getSpread() const {
     if (bids.empty() || asks.empty()) {
         return 0.0;
     }
-    return getBestAsk() - getBestBid();
+    return asks.begin()->first - bids.rbegin()->first;
+}
+
+double OrderBook::getBidQuantity(double price) const {
+    std::lock_guard<std::mutex> lock(bookMutex);
+    auto it = bids.find(price);
+    return it != bids.end() ? it->second : 0.0;
+}
+
+double OrderBook::getAskQuantity(double price) const {
+    std::lock_guard<std::mutex> lock(bookMutex);
+    auto it = asks.find(price);
+    return it != asks.end() ? it->second : 0.0;
+}
+
+void OrderBook::copyTop(size_t depth, std::vector<std::pair<double, double>>& topBids,
+                        std::vector<std::pair<double, double>>& topAsks) const {
+    topBids.clear();
+    topAsks.clear();
+    std::lock_guard<std::mutex> lock(bookMutex);
+    for (auto it = bids.rbegin(); it != bids.rend() && topBids.size() < depth; ++it) {
+        topBids.emplace_back(it->first, it->second);
+    }
+    for (auto it = asks.begin(); it != asks.end() && topAsks.size() < depth; ++it) {
+        topAsks.emplace_back(it->first, it->second);
+    }
 }
 
 const std::map<double, double>& OrderBook::getBids() const {
@@ -5,6 +5,8 @@
 #include <map>
 #include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 class OrderBook {
 public:
@@ -21,6 +23,29 @@ public:
     double getMidPrice() const;
     double getSpread() const;
 
+    // Resting quantity at an exact price, 0 if the level is empty
+    double getBidQuantity(double price) const;
+    double getAskQuantity(double price) const;
+
+    // Visit levels best price first while the visitor returns true. The book
+    // stays locked for the duration, so keep visitors short.
+    template <typename Visitor>
+    void forEachBid(Visitor&& visit) const {
+        std::lock_guard<std::mutex> lock(bookMutex);
+        for (auto it = bids.rbegin(); it != bids.rend() && visit(it->first, it->second); ++it) {}
+    }
+
+    template <typename Visitor>
+    void forEachAsk(Visitor&& visit) const {
+        std::lock_guard<std::mutex> lock(bookMutex);
+        for (auto it = asks.begin(); it != asks.end() && visit(it->first, it->second); ++it) {}
+    }
+
+    // Copies up to depth levels per side, best first, under one lock so both
+    // sides come from the same update
+    void copyTop(size_t depth, std::vector<std::pair<double, double>>& topBids,
+                 std::vector<std::pair<double, double>>& topAsks) const;
+
     // Get full order book depth
     const std::map<double, double>& getBids() const;
     const std::map<double, double>& getAsks() const;
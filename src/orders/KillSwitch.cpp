@@ -0,0 +1,190 @@
+#include "KillSwitch.h"
+#include "../market/MarketDataManager.h"
+#include "../include/Logger.h"
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace {
+int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// A control client that stops talking is dropped after this long
+constexpr int CLIENT_TIMEOUT_SECONDS = 1;
+constexpr size_t MAX_COMMAND_LENGTH = 64;
+}
+
+KillSwitch::KillSwitch(OrderManager& orderManager) : KillSwitch(orderManager, Options()) {}
+
+KillSwitch::KillSwitch(OrderManager& orderManager, const Options& options)
+    : orderManager(orderManager), options(options) {
+    orderManager.getRiskManager().setDailyLossCallback([this](double) {
+        trigger(Reason::DailyLoss);
+    });
+}
+
+KillSwitch::~KillSwitch() {
+    stop();
+    if (watched) {
+        watched->removeBookUpdateListener(bookListener);
+    }
+    orderManager.getRiskManager().setDailyLossCallback(nullptr);
+}
+
+void KillSwitch::watch(MarketDataManager& marketDataManager) {
+    watched = &marketDataManager;
+    bookListener = marketDataManager.addBookUpdateListener([this](InstrumentId, const OrderBook&) {
+        lastBookUpdateNs.store(steadyNowNs(), std::memory_order_relaxed);
+    });
+}
+
+bool KillSwitch::start() {
+    if (running.exchange(true)) {
+        return true;
+    }
+    if (!options.controlSocketPath.empty() && !openControlSocket()) {
+        running = false;
+        return false;
+    }
+    monitorThread = std::thread(&KillSwitch::monitorLoop, this);
+    Logger::info("Kill switch armed", options.controlSocketPath.empty() ? "" : ", control socket at ",
+                 options.controlSocketPath);
+    return true;
+}
+
+void KillSwitch::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    if (monitorThread.joinable()) {
+        monitorThread.join();
+    }
+    closeControlSocket();
+}
+
+bool KillSwitch::trigger(Reason reason) {
+    Reason expected = Reason::None;
+    if (reason == Reason::None || !haltReason.compare_exchange_strong(expected, reason)) {
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    orderManager.halt();
+    std::chrono::duration<double, std::micro> latency = std::chrono::steady_clock::now() - start;
+    Logger::error("Kill switch tripped by ", toString(reason), ", halted and cancelled in ", latency.count(), " us");
+    return true;
+}
+
+void KillSwitch::reset() {
+    if (haltReason.exchange(Reason::None) == Reason::None) {
+        return;
+    }
+    orderManager.resume();
+    Logger::warning("Kill switch reset");
+}
+
+bool KillSwitch::openControlSocket() {
+    const std::string& path = options.controlSocketPath;
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        Logger::error("Kill switch socket path too long: ", path);
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        Logger::error("Kill switch socket failed: ", std::strerror(errno));
+        return false;
+    }
+    // A socket file left behind by an earlier run would make bind fail
+    unlink(path.c_str());
+    if (bind(listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        chmod(path.c_str(), S_IRUSR | S_IWUSR) != 0 || listen(listenFd, 4) != 0) {
+        Logger::error("Kill switch socket ", path, " unavailable: ", std::strerror(errno));
+        closeControlSocket();
+        return false;
+    }
+    return true;
+}
+
+void KillSwitch::closeControlSocket() {
+    if (listenFd < 0) {
+        return;
+    }
+    close(listenFd);
+    listenFd = -1;
+    unlink(options.controlSocketPath.c_str());
+}
+
+void KillSwitch::monitorLoop() {
+    int timeoutMs = static_cast<int>(options.pollInterval.count());
+    while (running.load(std::memory_order_relaxed)) {
+        // Without a control socket poll() simply sleeps for the interval
+        pollfd listener{listenFd, POLLIN, 0};
+        if (poll(&listener, 1, timeoutMs) > 0 && (listener.revents & POLLIN)) {
+            int client = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client >= 0) {
+                serveClient(client);
+                close(client);
+            }
+        }
+        checkFeed();
+    }
+}
+
+void KillSwitch::checkFeed() {
+    if (options.feedStaleAfter.count() <= 0) {
+        return;
+    }
+    int64_t last = lastBookUpdateNs.load(std::memory_order_relaxed);
+    if (last == 0 || steadyNowNs() - last < std::chrono::nanoseconds(options.feedStaleAfter).count()) {
+        return;
+    }
+    // Re-armed by the next book update, so a reset does not trip again at once
+    lastBookUpdateNs.compare_exchange_strong(last, 0, std::memory_order_relaxed);
+    trigger(Reason::FeedStale);
+}
+
+void KillSwitch::serveClient(int fd) {
+    timeval timeout{CLIENT_TIMEOUT_SECONDS, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    std::string pending;
+    char buffer[256];
+    ssize_t received;
+    while ((received = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        pending.append(buffer, static_cast<size_t>(received));
+        size_t end;
+        while ((end = pending.find('\n')) != std::string::npos) {
+            std::string reply = handleCommand(pending.substr(0, end));
+            pending.erase(0, end + 1);
+            send(fd, reply.data(), reply.size(), MSG_NOSIGNAL);
+        }
+        if (pending.size() > MAX_COMMAND_LENGTH) {
+            return;
+        }
+    }
+}
+
+std::string KillSwitch::handleCommand(const std::string& line) {
+    std::string command = line.substr(0, line.find_last_not_of(" \r\t") + 1);
+    if (command == "halt") {
+        return trigger(Reason::ControlSocket) ? "halted\n" : "already halted\n";
+    }
+    if (command == "resume") {
+        reset();
+        return "trading\n";
+    }
+    if (command == "status") {
+        return isHalted() ? std::string("halted: ") + toString(reason()) + "\n" : "trading\n";
+    }
+    return "unknown command, expected halt, resume or status\n";
+}
@@ -0,0 +1,83 @@
+// orders/KillSwitch.h
+#ifndef KILL_SWITCH_H
+#define KILL_SWITCH_H
+
+#include "OrderManager.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+class MarketDataManager;
+
+// One place to stop trading, whatever trips it: the CLI, a line on the local
+// control socket, the daily loss limit, or the market data feed going quiet.
+// A trigger halts the OrderManager and its execution workers with two atomic
+// stores, then writes private/cancel_all on the fill feed's open session. That
+// write takes the feed's session mutex and the websocket library copies the
+// message, but no order-manager lock, rate limit or in-flight limit applies,
+// and nothing is logged before it. With the feed down the cancel goes over
+// REST and is retried until it succeeds. Trading stays halted until reset().
+class KillSwitch {
+public:
+    enum class Reason : uint8_t { None, Manual, ControlSocket, DailyLoss, FeedStale };
+
+    struct Options {
+        // Unix domain socket taking "halt", "resume" and "status" lines; empty disables it
+        std::string controlSocketPath;
+        // Halt once the watched books have been silent this long; 0 disables
+        std::chrono::milliseconds feedStaleAfter{5000};
+        // How often the monitor thread looks at the feed
+        std::chrono::milliseconds pollInterval{50};
+    };
+
+    explicit KillSwitch(OrderManager& orderManager);
+    KillSwitch(OrderManager& orderManager, const Options& options);
+    ~KillSwitch();
+
+    // Staleness is only judged once the first book update has arrived
+    void watch(MarketDataManager& marketDataManager);
+    // Opens the control socket and starts the monitor thread
+    bool start();
+    void stop();
+
+    // Returns false if trading was already halted
+    bool trigger(Reason reason);
+    // Lets orders through again. A breached daily loss limit still rejects
+    // them until the PnL engine's day rolls over.
+    void reset();
+    bool isHalted() const { return haltReason.load(std::memory_order_relaxed) != Reason::None; }
+    Reason reason() const { return haltReason.load(std::memory_order_relaxed); }
+
+private:
+    OrderManager& orderManager;
+    Options options;
+    std::atomic<Reason> haltReason{Reason::None};
+    std::atomic<int64_t> lastBookUpdateNs{0};  // 0 until the feed is live again
+    std::atomic<bool> running{false};
+    std::thread monitorThread;
+    int listenFd = -1;
+    MarketDataManager* watched = nullptr;
+    uint64_t bookListener = 0;
+
+    bool openControlSocket();
+    void closeControlSocket();
+    void monitorLoop();
+    void checkFeed();
+    void serveClient(int fd);
+    std::string handleCommand(const std::string& line);
+};
+
+inline const char* toString(KillSwitch::Reason reason) {
+    switch (reason) {
+        case KillSwitch::Reason::None: return "none";
+        case KillSwitch::Reason::Manual: return "manual";
+        case KillSwitch::Reason::ControlSocket: return "control socket";
+        case KillSwitch::Reason::DailyLoss: return "daily loss limit";
+        case KillSwitch::Reason::FeedStale: return "stale market data";
+        default: return "unknown";
+    }
+}
+
+#endif
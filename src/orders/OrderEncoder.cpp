@@ -0,0 +1,287 @@
+#include "OrderEncoder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+namespace {
+
+constexpr uint64_t POW10[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+    1000000000ULL, 10000000000ULL
+};
+constexpr int MAX_DECIMALS = 10;
+
+struct BufferWriter {
+    char* pos;
+    char* end;
+    bool overflow = false;
+
+    template <size_t N>
+    void literal(const char (&text)[N]) {
+        raw(text, N - 1);
+    }
+
+    void raw(const char* text, size_t length) {
+        if (overflow || static_cast<size_t>(end - pos) < length) {
+            overflow = true;
+            return;
+        }
+        std::memcpy(pos, text, length);
+        pos += length;
+    }
+
+    // Worst case for a number is well under 32 characters
+    bool reserveNumber() {
+        if (overflow || end - pos < 32) {
+            overflow = true;
+        }
+        return !overflow;
+    }
+
+    void unsignedValue(uint64_t value) {
+        if (reserveNumber()) pos += OrderEncoder::writeUnsigned(pos, value);
+    }
+
+    void decimal(double value, int decimals) {
+        if (reserveNumber()) pos += OrderEncoder::writeDecimal(pos, value, decimals);
+    }
+
+    // JSON string contents: quotes, backslashes and control characters are escaped
+    void string(std::string_view text) {
+        static const char HEX[] = "0123456789abcdef";
+        for (char c : text) {
+            unsigned char byte = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\') {
+                char escaped[2] = {'\\', c};
+                raw(escaped, 2);
+            } else if (byte < 0x20) {
+                char escaped[6] = {'\\', 'u', '0', '0', HEX[byte >> 4], HEX[byte & 0xf]};
+                raw(escaped, 6);
+            } else {
+                raw(&c, 1);
+            }
+        }
+    }
+};
+
+} // namespace
+
+size_t OrderEncoder::writeUnsigned(char* out, uint64_t value) {
+    char digits[20];
+    size_t count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = digits[count - 1 - i];
+    }
+    return count;
+}
+
+size_t OrderEncoder::writeDecimal(char* out, double value, int decimals) {
+    if (!std::isfinite(value)) {
+        out[0] = '0';
+        return 1;
+    }
+    if (decimals < 0) decimals = 0;
+    if (decimals > MAX_DECIMALS) decimals = MAX_DECIMALS;
+
+    size_t length = 0;
+    if (value < 0) {
+        out[length++] = '-';
+        value = -value;
+    }
+
+    double scaled = std::round(value * static_cast<double>(POW10[decimals]));
+    if (scaled >= 9.0e18) {
+        // Out of fixed-point range; not reachable for real prices or sizes
+        return length + static_cast<size_t>(std::snprintf(out + length, 32, "%.17g", value));
+    }
+
+    uint64_t fixed = static_cast<uint64_t>(scaled);
+    uint64_t integerPart = fixed / POW10[decimals];
+    uint64_t fraction = fixed % POW10[decimals];
+
+    length += writeUnsigned(out + length, integerPart);
+    if (fraction != 0) {
+        int digits = decimals;
+        while (fraction % 10 == 0) {
+            fraction /= 10;
+            --digits;
+        }
+        out[length++] = '.';
+        for (int i = digits - 1; i >= 0; --i) {
+            out[length + i] = static_cast<char>('0' + fraction % 10);
+            fraction /= 10;
+        }
+        length += digits;
+    }
+    return length;
+}
+
+int OrderEncoder::decimalsFor(double increment) {
+    if (!(increment > 0)) {
+        return DEFAULT_DECIMALS;
+    }
+    for (int decimals = 0; decimals <= MAX_DECIMALS; ++decimals) {
+        double scaled = increment * static_cast<double>(POW10[decimals]);
+        if (std::abs(scaled - std::round(scaled)) < 1e-6 * scaled) {
+            return decimals;
+        }
+    }
+    return MAX_DECIMALS;
+}
+
+OrderEncoder::OrderEncoder()
+    : templates(std::make_unique<std::atomic<const InstrumentTemplate*>[]>(InstrumentRegistry::MAX_INSTRUMENTS)) {
+    for (size_t i = 0; i < InstrumentRegistry::MAX_INSTRUMENTS; ++i) {
+        templates[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+void OrderEncoder::defaultDecimals(InstrumentId instrument, int& priceDecimals, int& amountDecimals) {
+    priceDecimals = DEFAULT_DECIMALS;
+    amountDecimals = DEFAULT_DECIMALS;
+    if (const InstrumentInfo* info = InstrumentRegistry::instance().info(instrument)) {
+        priceDecimals = decimalsFor(info->tickSize);
+        amountDecimals = decimalsFor(info->minTradeAmount);
+    }
+}
+
+void OrderEncoder::prepare(InstrumentId instrument) {
+    int priceDecimals;
+    int amountDecimals;
+    defaultDecimals(instrument, priceDecimals, amountDecimals);
+    prepare(instrument, priceDecimals, amountDecimals);
+}
+
+void OrderEncoder::prepare(InstrumentId instrument, int priceDecimals, int amountDecimals) {
+    if (instrument >= InstrumentRegistry::MAX_INSTRUMENTS) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(prepareMutex);
+    buildTemplate(instrument, priceDecimals, amountDecimals);
+}
+
+size_t OrderEncoder::prepareAll() {
+    InstrumentRegistry& registry = InstrumentRegistry::instance();
+    size_t count = std::min(registry.size(), InstrumentRegistry::MAX_INSTRUMENTS);
+    size_t prepared = 0;
+    for (InstrumentId instrument = 0; instrument < count; ++instrument) {
+        if (registry.info(instrument)) {
+            prepare(instrument);
+            ++prepared;
+        }
+    }
+    return prepared;
+}
+
+const OrderEncoder::InstrumentTemplate* OrderEncoder::buildTemplate(InstrumentId instrument, int priceDecimals,
+                                                                    int amountDecimals) {
+    auto tmpl = std::make_unique<InstrumentTemplate>();
+    BufferWriter writer{tmpl->params, tmpl->params + sizeof(tmpl->params)};
+    writer.literal("\",\"params\":{\"instrument_name\":\"");
+    writer.string(InstrumentRegistry::instance().name(instrument).view());
+    writer.literal("\",\"amount\":");
+    tmpl->paramsLength = writer.overflow ? 0 : static_cast<size_t>(writer.pos - tmpl->params);
+    tmpl->priceDecimals = priceDecimals;
+    tmpl->amountDecimals = amountDecimals;
+
+    const InstrumentTemplate* published = tmpl.get();
+    built.push_back(std::move(tmpl));
+    templates[instrument].store(published, std::memory_order_release);
+    return published;
+}
+
+const OrderEncoder::InstrumentTemplate* OrderEncoder::getTemplate(InstrumentId instrument) {
+    if (instrument >= InstrumentRegistry::MAX_INSTRUMENTS) {
+        return nullptr;
+    }
+    const InstrumentTemplate* tmpl = templates[instrument].load(std::memory_order_acquire);
+    if (!tmpl) {
+        // An instrument interned after startup pays for its template on its first order
+        int priceDecimals;
+        int amountDecimals;
+        defaultDecimals(instrument, priceDecimals, amountDecimals);
+        std::lock_guard<std::mutex> lock(prepareMutex);
+        tmpl = templates[instrument].load(std::memory_order_acquire);
+        if (!tmpl) {
+            tmpl = buildTemplate(instrument, priceDecimals, amountDecimals);
+        }
+    }
+    return tmpl->paramsLength > 0 ? tmpl : nullptr;
+}
+
+bool OrderEncoder::encodePlace(const Order& order, uint64_t requestId, Buffer& out) {
+    const InstrumentTemplate* tmpl = getTemplate(order.instrumentId);
+    if (!tmpl) {
+        return false;
+    }
+
+    BufferWriter writer{out.data, out.data + MAX_REQUEST_SIZE};
+    writer.literal("{\"jsonrpc\":\"2.0\",\"id\":");
+    writer.unsignedValue(requestId);
+    if (order.isBuy()) {
+        writer.literal(",\"method\":\"private/buy");
+    } else {
+        writer.literal(",\"method\":\"private/sell");
+    }
+    writer.raw(tmpl->params, tmpl->paramsLength);
+    writer.decimal(order.amount, tmpl->amountDecimals);
+
+    if (order.type == OrderType::Limit) {
+        writer.literal(",\"type\":\"limit\",\"price\":");
+        writer.decimal(order.price, tmpl->priceDecimals);
+    } else {
+        writer.literal(",\"type\":\"market\"");
+    }
+    if (!isValidLabel(order.label.view())) {
+        return false;
+    }
+    if (!order.label.empty()) {
+        writer.literal(",\"label\":\"");
+        writer.string(order.label.view());
+        writer.literal("\"");
+    }
+    writer.literal("}}");
+
+    out.length = writer.overflow ? 0 : static_cast<size_t>(writer.pos - out.data);
+    return !writer.overflow;
+}
+
+bool OrderEncoder::encodeEdit(InstrumentId instrument, std::string_view orderId, double amount, double price,
+                              uint64_t requestId, Buffer& out) {
+    const InstrumentTemplate* tmpl = getTemplate(instrument);
+    int priceDecimals = tmpl ? tmpl->priceDecimals : DEFAULT_DECIMALS;
+    int amountDecimals = tmpl ? tmpl->amountDecimals : DEFAULT_DECIMALS;
+
+    BufferWriter writer{out.data, out.data + MAX_REQUEST_SIZE};
+    writer.literal("{\"jsonrpc\":\"2.0\",\"id\":");
+    writer.unsignedValue(requestId);
+    writer.literal(",\"method\":\"private/edit\",\"params\":{\"order_id\":\"");
+    writer.string(orderId);
+    writer.literal("\",\"amount\":");
+    writer.decimal(amount, amountDecimals);
+    writer.literal(",\"price\":");
+    writer.decimal(price, priceDecimals);
+    writer.literal("}}");
+
+    out.length = writer.overflow ? 0 : static_cast<size_t>(writer.pos - out.data);
+    return !writer.overflow;
+}
+
+bool OrderEncoder::encodeCancel(std::string_view orderId, uint64_t requestId, Buffer& out) {
+    BufferWriter writer{out.data, out.data + MAX_REQUEST_SIZE};
+    writer.literal("{\"jsonrpc\":\"2.0\",\"id\":");
+    writer.unsignedValue(requestId);
+    writer.literal(",\"method\":\"private/cancel\",\"params\":{\"order_id\":\"");
+    writer.string(orderId);
+    writer.literal("\"}}");
+
+    out.length = writer.overflow ? 0 : static_cast<size_t>(writer.pos - out.data);
+    return !writer.overflow;
+}
@@ -0,0 +1,77 @@
+// orders/OrderEncoder.h
+#ifndef ORDER_ENCODER_H
+#define ORDER_ENCODER_H
+
+#include "models/order.h"
+#include <cstddef>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+// Writes Deribit JSON-RPC order requests straight into a caller-owned buffer.
+// The instrument-dependent part of each request is serialized once per
+// instrument; encoding an order only copies that template and formats the
+// numeric fields, so the send path does not touch the heap once an instrument
+// has been prepared.
+class OrderEncoder {
+public:
+    static constexpr size_t MAX_REQUEST_SIZE = 512;
+    static constexpr int DEFAULT_DECIMALS = 8;
+
+    struct Buffer {
+        char data[MAX_REQUEST_SIZE];
+        size_t length = 0;
+    };
+
+    OrderEncoder();
+
+    // Builds an instrument's template ahead of its first order. Decimals
+    // bound the precision written for price and amount; by default they come
+    // from the instrument's tick size and minimum trade amount, or
+    // DEFAULT_DECIMALS without reference data. Safe while other threads
+    // encode: a rebuilt template replaces the old one, which stays valid.
+    void prepare(InstrumentId instrument);
+    void prepare(InstrumentId instrument, int priceDecimals, int amountDecimals);
+    // Prepares every instrument with reference data; returns how many
+    size_t prepareAll();
+
+    // Each returns false if the request does not fit in the buffer.
+    bool encodePlace(const Order& order, uint64_t requestId, Buffer& out);
+    // Edits use the instrument's decimals, or DEFAULT_DECIMALS when it is unknown
+    bool encodeEdit(InstrumentId instrument, std::string_view orderId, double amount, double price,
+                    uint64_t requestId, Buffer& out);
+    bool encodeCancel(std::string_view orderId, uint64_t requestId, Buffer& out);
+
+    // Exposed for reuse; return the number of characters written.
+    static size_t writeUnsigned(char* out, uint64_t value);
+    static size_t writeDecimal(char* out, double value, int decimals);
+    // Decimals needed to write multiples of increment exactly
+    static int decimalsFor(double increment);
+
+private:
+    // Immutable once published
+    struct InstrumentTemplate {
+        // ,"params":{"instrument_name":"<name>","amount":
+        char params[128];
+        size_t paramsLength;
+        int priceDecimals;
+        int amountDecimals;
+    };
+
+    // Indexed by InstrumentId; null until built
+    std::unique_ptr<std::atomic<const InstrumentTemplate*>[]> templates;
+    // Owns every template ever published, since an encode may still be
+    // reading a replaced one. Guarded by prepareMutex.
+    std::vector<std::unique_ptr<const InstrumentTemplate>> built;
+    std::mutex prepareMutex;
+
+    const InstrumentTemplate* getTemplate(InstrumentId instrument);
+    // Call with prepareMutex held
+    const InstrumentTemplate* buildTemplate(InstrumentId instrument, int priceDecimals, int amountDecimals);
+    static void defaultDecimals(InstrumentId instrument, int& priceDecimals, int& amountDecimals);
+};
+
+#endif
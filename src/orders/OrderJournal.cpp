@@ -0,0 +1,364 @@
+#include "OrderJournal.h"
+#include "../include/Logger.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+namespace {
+
+constexpr char JOURNAL_MAGIC[8] = {'O', 'R', 'D', 'J', 'R', 'N', 'L', '1'};
+// Records start on their own page after the header
+constexpr size_t HEADER_SIZE = 4096;
+constexpr size_t RECORDS_PER_PAGE = 4096 / sizeof(JournalRecord);
+// How far ahead of the appenders the flusher maps pages in
+constexpr uint64_t PREFAULT_AHEAD = 4096;
+// Records behind the first missing or damaged one are cleared on open, so
+// that they cannot resurface once new records fill the gap, up to this many
+// empty slots in a row
+constexpr uint64_t TAIL_CLEAR = 1024;
+constexpr uint64_t CHECKSUM_MIX = 0x9E3779B97F4A7C15ull;
+
+struct JournalHeader {
+    char magic[8];
+    uint32_t recordSize;  // a layout change invalidates older files
+    uint32_t reserved;
+    uint64_t capacity;
+    int64_t createdAtMs;
+};
+
+static_assert(std::is_trivially_copyable<JournalRecord>::value, "Journal records are copied as raw bytes");
+static_assert(offsetof(JournalRecord, timestampNs) == 2 * sizeof(uint64_t),
+              "The checksum covers everything after the sequence and checksum");
+
+int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+uint64_t checksumOf(const JournalRecord& record, uint64_t sequence) {
+    const char* bytes = reinterpret_cast<const char*>(&record);
+    uint64_t hash = sequence * CHECKSUM_MIX;
+    for (size_t offset = offsetof(JournalRecord, timestampNs); offset < sizeof(JournalRecord);
+         offset += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, bytes + offset, sizeof(word));
+        hash = (hash ^ word) * CHECKSUM_MIX;
+        hash ^= hash >> 32;
+    }
+    return hash;
+}
+
+// Returns the open descriptor of a new, empty journal, or -1
+int createJournalFile(const std::string& path, uint64_t capacity) {
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        Logger::error("Could not create order journal ", path, ": ", std::strerror(errno));
+        return -1;
+    }
+    JournalHeader header{};
+    std::memcpy(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+    header.recordSize = sizeof(JournalRecord);
+    header.capacity = capacity;
+    header.createdAtMs = nowMs();
+
+    // Sparse: disk space is only taken as records are written
+    off_t size = static_cast<off_t>(HEADER_SIZE + capacity * sizeof(JournalRecord));
+    if (ftruncate(fd, size) != 0 || pwrite(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+        Logger::error("Could not create order journal ", path, ": ", std::strerror(errno));
+        ::close(fd);
+        unlink(path.c_str());
+        return -1;
+    }
+    return fd;
+}
+
+}
+
+OrderJournal::OrderJournal() : OrderJournal(Options()) {}
+
+OrderJournal::OrderJournal(const Options& options) : options(options) {}
+
+OrderJournal::~OrderJournal() {
+    close();
+}
+
+bool OrderJournal::open() {
+    if (records) {
+        return true;
+    }
+    if (access(options.path.c_str(), F_OK) != 0) {
+        int created = createJournalFile(options.path, options.capacity);
+        if (created < 0) {
+            return false;
+        }
+        fsync(created);
+        ::close(created);
+    }
+    if (!map()) {
+        return false;
+    }
+    startFlusher();
+    Logger::info("Order journal ", options.path, " open with ", size(), " records");
+    return true;
+}
+
+void OrderJournal::close() {
+    if (!records) {
+        return;
+    }
+    stopFlusher();
+    flushCompleted();
+    unmap();
+}
+
+bool OrderJournal::map() {
+    const std::string& path = options.path;
+    int file = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (file < 0) {
+        Logger::error("Could not open order journal ", path, ": ", std::strerror(errno));
+        return false;
+    }
+    JournalHeader header;
+    struct stat status;
+    // A journal that cannot be read is left alone for someone to look at
+    if (pread(file, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) || fstat(file, &status) != 0 ||
+        std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0 ||
+        header.recordSize != sizeof(JournalRecord) ||
+        static_cast<uint64_t>(status.st_size) != HEADER_SIZE + header.capacity * sizeof(JournalRecord)) {
+        Logger::error("Order journal ", path, " has an unknown layout or is truncated");
+        ::close(file);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(status.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    if (mapped == MAP_FAILED) {
+        Logger::error("Could not map order journal ", path, ": ", std::strerror(errno));
+        ::close(file);
+        return false;
+    }
+
+    fd = file;
+    mapping = static_cast<char*>(mapped);
+    mappedSize = size;
+    records = reinterpret_cast<JournalRecord*>(mapping + HEADER_SIZE);
+    capacity = header.capacity;
+    createdAtMs = header.createdAtMs;
+
+    uint64_t end = findEnd();
+    uint64_t empty = 0;
+    for (uint64_t i = end; i < capacity && empty < TAIL_CLEAR; ++i) {
+        if (records[i].sequence != 0) {
+            std::memset(static_cast<void*>(&records[i]), 0, sizeof(JournalRecord));
+            empty = 0;
+        } else {
+            ++empty;
+        }
+    }
+    nextIndex.store(end, std::memory_order_relaxed);
+    durable.store(end, std::memory_order_relaxed);
+    completed = end;
+    full.store(end >= capacity, std::memory_order_relaxed);
+    return true;
+}
+
+void OrderJournal::unmap() {
+    munmap(mapping, mappedSize);
+    ::close(fd);
+    fd = -1;
+    mapping = nullptr;
+    mappedSize = 0;
+    records = nullptr;
+    capacity = 0;
+}
+
+uint64_t OrderJournal::findEnd() const {
+    uint64_t end = 0;
+    while (end < capacity && records[end].sequence == end + 1 &&
+           records[end].checksum == checksumOf(records[end], end + 1)) {
+        ++end;
+    }
+    return end;
+}
+
+size_t OrderJournal::replay(const std::function<void(const JournalRecord&)>& apply) const {
+    uint64_t end = size();
+    for (uint64_t i = 0; i < end; ++i) {
+        apply(records[i]);
+    }
+    return static_cast<size_t>(end);
+}
+
+bool OrderJournal::rewrite(const std::vector<JournalRecord>& snapshot) {
+    if (!records) {
+        return false;
+    }
+    std::string temporary = options.path + ".tmp";
+    uint64_t newCapacity = std::max<uint64_t>(options.capacity, 2 * snapshot.size());
+    int file = createJournalFile(temporary, newCapacity);
+    if (file < 0) {
+        return false;
+    }
+
+    bool written = true;
+    for (size_t i = 0; i < snapshot.size() && written; ++i) {
+        JournalRecord record = snapshot[i];
+        record.sequence = i + 1;
+        record.checksum = checksumOf(record, record.sequence);
+        off_t offset = static_cast<off_t>(HEADER_SIZE + i * sizeof(JournalRecord));
+        written = pwrite(file, &record, sizeof(record), offset) == static_cast<ssize_t>(sizeof(record));
+    }
+    written = written && fdatasync(file) == 0;
+    ::close(file);
+    if (!written || std::rename(temporary.c_str(), options.path.c_str()) != 0) {
+        Logger::error("Could not rewrite order journal ", options.path, ": ", std::strerror(errno));
+        unlink(temporary.c_str());
+        return false;
+    }
+
+    stopFlusher();
+    unmap();
+    if (!map()) {
+        return false;
+    }
+    startFlusher();
+    Logger::info("Order journal ", options.path, " rewritten with ", snapshot.size(), " records");
+    return true;
+}
+
+JournalRecord* OrderJournal::claim(JournalEvent event, uint64_t& sequence) {
+    if (!records) {
+        return nullptr;
+    }
+    uint64_t index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+    if (index >= capacity) {
+        if (!full.exchange(true, std::memory_order_relaxed)) {
+            Logger::error("Order journal ", options.path, " is full, order events are no longer recorded");
+        }
+        return nullptr;
+    }
+    sequence = index + 1;
+    JournalRecord* slot = records + index;
+    slot->timestampNs = nowNs();
+    slot->event = event;
+    return slot;
+}
+
+void OrderJournal::publish(JournalRecord* slot, uint64_t sequence) {
+    slot->checksum = checksumOf(*slot, sequence);
+    __atomic_store_n(&slot->sequence, sequence, __ATOMIC_RELEASE);
+}
+
+bool OrderJournal::append(JournalEvent event, const Order& order) {
+    uint64_t sequence;
+    JournalRecord* slot = claim(event, sequence);
+    if (!slot) {
+        return false;
+    }
+    slot->amount = 0;
+    slot->price = 0;
+    slot->instrument = order.instrumentId < InstrumentRegistry::MAX_INSTRUMENTS ? order.instrumentName()
+                                                                                : InstrumentRegistry::Name();
+    slot->order = order;
+    publish(slot, sequence);
+    return true;
+}
+
+bool OrderJournal::append(JournalEvent event, InstrumentId instrument, double amount, double price) {
+    if (instrument >= InstrumentRegistry::MAX_INSTRUMENTS) {
+        return false;
+    }
+    uint64_t sequence;
+    JournalRecord* slot = claim(event, sequence);
+    if (!slot) {
+        return false;
+    }
+    slot->amount = amount;
+    slot->price = price;
+    slot->instrument = InstrumentRegistry::instance().name(instrument);
+    slot->order = Order{};
+    publish(slot, sequence);
+    return true;
+}
+
+void OrderJournal::sync() {
+    flushCompleted();
+}
+
+std::chrono::system_clock::time_point OrderJournal::createdAt() const {
+    return std::chrono::system_clock::time_point(std::chrono::milliseconds(createdAtMs));
+}
+
+void OrderJournal::flushCompleted() {
+    static const uintptr_t pageMask = ~(static_cast<uintptr_t>(sysconf(_SC_PAGESIZE)) - 1);
+
+    std::lock_guard<std::mutex> lock(syncMutex);
+    if (!records) {
+        return;
+    }
+    // Stops at a record whose appender is still writing it
+    uint64_t end = std::min(nextIndex.load(std::memory_order_acquire), capacity);
+    while (completed < end && __atomic_load_n(&records[completed].sequence, __ATOMIC_ACQUIRE) == completed + 1) {
+        ++completed;
+    }
+
+    uint64_t from = durable.load(std::memory_order_relaxed);
+    if (completed == from) {
+        return;
+    }
+    uintptr_t begin = reinterpret_cast<uintptr_t>(records + from) & pageMask;
+    uintptr_t stop = reinterpret_cast<uintptr_t>(records + completed);
+    if (msync(reinterpret_cast<void*>(begin), stop - begin, MS_SYNC) != 0) {
+        Logger::error("Order journal sync failed: ", std::strerror(errno));
+        return;
+    }
+    durable.store(completed, std::memory_order_release);
+}
+
+void OrderJournal::prefault() {
+    uint64_t target = std::min(capacity, nextIndex.load(std::memory_order_relaxed) + PREFAULT_AHEAD);
+    for (; prefaulted < target; prefaulted += RECORDS_PER_PAGE) {
+        // A no-op atomic add takes the write fault here instead of in an
+        // appender, and cannot lose a sequence being published meanwhile
+        __atomic_fetch_add(&records[prefaulted].sequence, 0, __ATOMIC_RELAXED);
+    }
+}
+
+void OrderJournal::startFlusher() {
+    prefaulted = nextIndex.load(std::memory_order_relaxed);
+    running = true;
+    flusher = std::thread(&OrderJournal::flushLoop, this);
+}
+
+void OrderJournal::stopFlusher() {
+    {
+        std::lock_guard<std::mutex> lock(flusherMutex);
+        running = false;
+    }
+    flusherWake.notify_all();
+    if (flusher.joinable()) {
+        flusher.join();
+    }
+}
+
+void OrderJournal::flushLoop() {
+    std::unique_lock<std::mutex> lock(flusherMutex);
+    while (running) {
+        lock.unlock();
+        flushCompleted();
+        prefault();
+        lock.lock();
+        flusherWake.wait_for(lock, options.syncInterval, [this] { return !running; });
+    }
+}
@@ -0,0 +1,134 @@
+// orders/OrderJournal.h
+#ifndef ORDER_JOURNAL_H
+#define ORDER_JOURNAL_H
+
+#include "models/order.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Ack and Update record an order's state as tracked; a terminal status means
+// it is no longer open. Cancel and Reject end an order. Fill and Position
+// carry a signed amount instead of an order: a position change, and the
+// absolute position a rewritten journal starts from.
+enum class JournalEvent : uint8_t { New, Ack, Update, Cancel, Reject, Fill, Position };
+
+inline const char* toString(JournalEvent event) {
+    switch (event) {
+        case JournalEvent::New: return "new";
+        case JournalEvent::Ack: return "ack";
+        case JournalEvent::Update: return "update";
+        case JournalEvent::Cancel: return "cancel";
+        case JournalEvent::Reject: return "reject";
+        case JournalEvent::Fill: return "fill";
+        case JournalEvent::Position: return "position";
+        default: return "unknown";
+    }
+}
+
+// Five cache lines, written to the file as raw bytes. The instrument is kept
+// by name: IDs only stay the same across restarts while the instrument cache
+// does.
+struct alignas(64) JournalRecord {
+    uint64_t sequence = 0;  // from 1; 0 is space nothing was written to
+    uint64_t checksum = 0;  // over everything after it, and the sequence
+    int64_t timestampNs = 0;
+    JournalEvent event = JournalEvent::New;
+    double amount = 0;  // Fill and Position only, positive when long
+    double price = 0;
+    Order order;  // order events only
+    InstrumentRegistry::Name instrument;  // after the order, which is cache-line aligned
+};
+
+static_assert(sizeof(JournalRecord) == 320, "Journal records should span exactly five cache lines");
+
+// Write-ahead log of order events in a preallocated, memory-mapped file.
+// Appending is lock-free: a slot is claimed with one atomic add, filled in
+// place and published by storing its sequence last, so the record is in the
+// page cache, and survives the process dying, once append() returns. A
+// flusher thread makes it durable with one msync per sync interval for
+// everything appended meanwhile, so no trading thread waits on the disk.
+// Recovery reads records in order up to the first one that is missing or
+// fails its checksum.
+class OrderJournal {
+public:
+    struct Options {
+        std::string path = "orders.journal";
+        // Records preallocated in a new file; a busy day stays well below this
+        size_t capacity = size_t(1) << 21;
+        // Group commit window
+        std::chrono::milliseconds syncInterval{5};
+    };
+
+    OrderJournal();
+    explicit OrderJournal(const Options& options);
+    ~OrderJournal();
+
+    // Maps the journal, creating it when missing, finds the last complete
+    // record and starts the flusher
+    bool open();
+    // Syncs and unmaps
+    void close();
+    bool isOpen() const { return records != nullptr; }
+
+    // Calls apply for every complete record in order; returns how many there were
+    size_t replay(const std::function<void(const JournalRecord&)>& apply) const;
+    // Atomically replaces the journal with these records, renumbered from 1.
+    // Not safe while other threads append.
+    bool rewrite(const std::vector<JournalRecord>& snapshot);
+
+    // Both return false when the journal is not open or full
+    bool append(JournalEvent event, const Order& order);
+    bool append(JournalEvent event, InstrumentId instrument, double amount, double price);
+    // Blocks until every record completed so far is on disk
+    void sync();
+
+    // When the file was created or last rewritten
+    std::chrono::system_clock::time_point createdAt() const;
+    uint64_t size() const { return std::min<uint64_t>(nextIndex.load(std::memory_order_relaxed), capacity); }
+    uint64_t durableSize() const { return durable.load(std::memory_order_acquire); }
+
+private:
+    Options options;
+    int fd = -1;
+    char* mapping = nullptr;
+    size_t mappedSize = 0;
+    JournalRecord* records = nullptr;
+    uint64_t capacity = 0;
+    int64_t createdAtMs = 0;
+
+    std::atomic<uint64_t> nextIndex{0};
+    std::atomic<uint64_t> durable{0};  // records below this index are on disk
+    std::atomic<bool> full{false};
+
+    // Guards completed and the msync calls
+    std::mutex syncMutex;
+    uint64_t completed = 0;   // records below this index are all published
+    uint64_t prefaulted = 0;  // flusher only: pages below this record are mapped
+
+    std::mutex flusherMutex;
+    std::condition_variable flusherWake;
+    bool running = false;
+    std::thread flusher;
+
+    // Maps an existing file and resumes after its last complete record
+    bool map();
+    void unmap();
+    uint64_t findEnd() const;
+    JournalRecord* claim(JournalEvent event, uint64_t& sequence);
+    static void publish(JournalRecord* slot, uint64_t sequence);
+    void flushLoop();
+    void flushCompleted();
+    void prefault();
+    void startFlusher();
+    void stopFlusher();
+};
+
+#endif
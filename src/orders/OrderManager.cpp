@@ -1,123 +1,835 @@
 #include "OrderManager.h"
-#include "utils/HttpClient.h"
+#include "../include/Logger.h"
+#include "../../include/IoContext.h"
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/this_coro.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/asio/use_future.hpp>
 #include <json/json.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <iostream>
 
+namespace {
+
+// Smaller position differences are rounding, not a missed fill
+constexpr double POSITION_TOLERANCE = 1e-9;
+
+// The currency Deribit lists an instrument's orders and positions under
+std::string settlementCurrency(InstrumentId instrument) {
+    InstrumentRegistry& registry = InstrumentRegistry::instance();
+    if (const InstrumentInfo* info = registry.info(instrument)) {
+        if (!info->settlementCurrency.empty()) {
+            return info->settlementCurrency.str();
+        }
+    }
+    // BTC-PERPETUAL settles in BTC, BTC_USDC-PERPETUAL in USDC
+    std::string_view name = registry.name(instrument).view();
+    std::string_view underlying = name.substr(0, name.find('-'));
+    size_t quote = underlying.find('_');
+    return std::string(quote == std::string_view::npos ? underlying : underlying.substr(quote + 1));
+}
+
+}
+
 OrderManager::OrderManager(AuthManager& authManager) 
     : authManager(authManager),
-      riskManager(std::make_unique<RiskManager>()) {}
+      orderPool(ORDER_POOL_CAPACITY),
+      riskManager(std::make_unique<RiskManager>(&rateLimiter)),
+      pnlEngine(std::make_unique<PnlEngine>(*riskManager)),
+      requestDispatcher(std::make_unique<RequestDispatcher>(asyncOptions.workerThreads, asyncOptions.maxInFlight)) {
+    // Reference data is loaded before the OrderManager is built
+    orderEncoder.prepareAll();
+}
 
 OrderManager::OrderManager(AuthManager& authManager, MarketDataManager& marketDataManager)
     : authManager(authManager),
-      riskManager(std::make_unique<RiskManager>()),
-      executionManager(std::make_unique<ExecutionManager>()),
-      marketDataIntegrator(std::make_unique<MarketDataIntegrator>(marketDataManager, *executionManager)) {
+      orderPool(ORDER_POOL_CAPACITY),
+      riskManager(std::make_unique<RiskManager>(&rateLimiter)),
+      pnlEngine(std::make_unique<PnlEngine>(*riskManager)),
+      executionManager(std::make_unique<ExecutionManager>(authManager, orderPool)),
+      marketDataIntegrator(std::make_unique<MarketDataIntegrator>(marketDataManager, *executionManager, orderPool)),
+      fillFeed(std::make_unique<FillFeed>(authManager)),
+      requestDispatcher(std::make_unique<RequestDispatcher>(asyncOptions.workerThreads, asyncOptions.maxInFlight)) {
     
+    orderEncoder.prepareAll();
+    pnlEngine->attach(marketDataManager);
     executionManager->setFillCallback([this](const Order& order, double amount, double price) {
         this->onFill(order, amount, price);
     });
+    executionManager->setExecutionReportCallback([this](OrderHandle handle) {
+        this->onExecutionReport(handle);
+    });
+    fillFeed->setFillCallback([this](const FillFeed::Fill& fill) {
+        this->onTrade(fill);
+    });
+    fillFeed->setOrderUpdateCallback([this](const Order& update) {
+        this->onOrderUpdate(update);
+    });
     
+    fillFeed->start();
     executionManager->start();
     marketDataIntegrator->start();
 }
 
+OrderManager::~OrderManager() {
+    stopping.store(true, std::memory_order_release);
+    if (fillFeed) {
+        fillFeed->stop();
+    }
+    // Drain in-flight requests before the members they touch are destroyed
+    drainRequests();
+    requestDispatcher->stop();
+}
+
 bool OrderManager::placeOrder(Order& order) {
-    auto start = std::chrono::high_resolution_clock::now(); // Start time
-    try {
-        if (!checkRateLimit()) {
-            Logger::warning("Order rejected: Rate limit exceeded");
-            order.status = "rejected";
-            order.rejectionReason = "Rate limit exceeded";
-            return false;
+    OrderResult result = placeOrderAsync(order).get();
+    order = result.order;
+    return result.success;
+}
+
+bool OrderManager::cancelOrder(const std::string& orderId) {
+    return cancelOrderAsync(orderId).get().success;
+}
+
+bool OrderManager::modifyOrder(const std::string& orderId, const Order& newOrder) {
+    return modifyOrderAsync(orderId, newOrder).get().success;
+}
+
+std::future<OrderManager::OrderResult> OrderManager::placeOrderAsync(const Order& order, OrderCallback callback,
+                                                                     std::chrono::milliseconds timeout) {
+    return dispatch([this](OrderResult& result, long timeoutMs) -> boost::asio::awaitable<bool> {
+        co_return co_await sendPlaceOrder(result.order, timeoutMs, result.error);
+    }, OrderResult{false, order, ""}, std::move(callback), timeout);
+}
+
+std::future<OrderManager::OrderResult> OrderManager::cancelOrderAsync(const std::string& orderId, OrderCallback callback,
+                                                                      std::chrono::milliseconds timeout) {
+    Order order{};
+    order.orderId = orderId;
+    return dispatch([this](OrderResult& result, long timeoutMs) -> boost::asio::awaitable<bool> {
+        bool cancelled = co_await sendCancelOrder(result.order.orderId.view(), timeoutMs, result.error);
+        if (cancelled) {
+            result.order.status = OrderStatus::Cancelled;
+            untrackOrder(result.order.orderId.view());
         }
+        co_return cancelled;
+    }, OrderResult{false, order, ""}, std::move(callback), timeout);
+}
 
-        if (!riskManager->validateOrder(order)) {
-            Logger::warning("Order rejected: Failed risk validation");
-            order.status = "rejected";
-            order.rejectionReason = "Failed risk validation";
-            return false;
+std::future<OrderManager::OrderResult> OrderManager::modifyOrderAsync(const std::string& orderId, const Order& newOrder,
+                                                                      OrderCallback callback,
+                                                                      std::chrono::milliseconds timeout) {
+    return dispatch([this, orderId](OrderResult& result, long timeoutMs) -> boost::asio::awaitable<bool> {
+        Logger::info("Modifying order with ID: ", orderId);
+        if (halted.load(std::memory_order_acquire)) {
+            result.order.rejectionReason = RejectReason::Halted;
+            result.error = toString(RejectReason::Halted);
+            co_return false;
+        }
+        ModifyMode mode = modifyMode.load(std::memory_order_relaxed);
+        // The edit and the cancel-and-replace fallback share the request's timeout
+        auto deadline = RequestDispatcher::Clock::now() + std::chrono::milliseconds(timeoutMs);
+
+        if (mode != ModifyMode::CancelReplace) {
+            if (co_await sendEditOrder(orderId, result.order, timeoutMs, result.error)) {
+                Logger::info("Order ", orderId, " amended in place");
+                co_return true;
+            }
+            if (mode == ModifyMode::EditOnly) {
+                co_return false;
+            }
+            Logger::warning("Edit of order ", orderId, " failed (", result.error,
+                            "), falling back to cancel-and-replace");
+            timeoutMs = remainingMs(deadline);
+            if (timeoutMs <= 0) {
+                result.order.rejectionReason = RejectReason::Timeout;
+                result.error = toString(RejectReason::Timeout);
+                co_return false;
+            }
         }
 
-        if (!authManager.refreshToken()) {
-            Logger::error("Failed to refresh authentication token");
-            return false;
+        if (co_await sendCancelReplace(orderId, result.order, timeoutMs, result.error)) {
+            Logger::info("Order modified successfully!");
+            co_return true;
         }
+        co_return false;
+    }, OrderResult{false, newOrder, ""}, std::move(callback), timeout);
+}
 
-        std::string endpoint = "private/" + order.side;
-        Json::Value request;
-        request["jsonrpc"] = "2.0";
-        request["id"] = 1;
-        request["method"] = endpoint;
+std::future<OrderManager::OrderResult> OrderManager::cancelAllByInstrumentAsync(const std::string& instrument,
+                                                                                OrderCallback callback,
+                                                                                std::chrono::milliseconds timeout) {
+    Order order{};
+    order.instrumentId = InstrumentRegistry::instance().intern(instrument);
+    return dispatch([this](OrderResult& result, long timeoutMs) -> boost::asio::awaitable<bool> {
+        if (executionBackend) {
+            InstrumentId instrumentId = result.order.instrumentId;
+            co_await runBlocking([this, &result, instrumentId]() {
+                result.cancelledCount = cancelTrackedWithBackend([instrumentId](const Order& tracked) {
+                    return tracked.instrumentId == instrumentId;
+                });
+            });
+            co_return true;
+        }
 
         Json::Value params;
-        params["instrument_name"] = order.instrumentName;
-        params["amount"] = order.amount;
-        params["type"] = order.type;
-        if (order.type == "limit") {
-            params["price"] = order.price;
+        params["instrument_name"] = result.order.instrumentName().str();
+        params["type"] = "all";
+
+        Json::Value response;
+        if (!co_await sendPrivateRequest("private/cancel_all_by_instrument", params, timeoutMs, response,
+                                         result.error)) {
+            Logger::error("Mass cancel for ", result.order.instrumentName(), " failed: ", result.error);
+            co_return false;
         }
-        request["params"] = params;
+        result.cancelledCount = response.asInt();
 
-        Json::StreamWriterBuilder writer;
-        std::string payload = Json::writeString(writer, request);
+        InstrumentId instrumentId = result.order.instrumentId;
+        untrackOrdersIf([instrumentId](const Order& tracked) {
+            return tracked.instrumentId == instrumentId;
+        });
+        Logger::info("Cancelled ", result.cancelledCount, " orders on ", result.order.instrumentName());
+        co_return true;
+    }, OrderResult{false, order, ""}, std::move(callback), timeout);
+}
 
-        std::string response = postRequest(endpoint, payload);
+std::future<OrderManager::OrderResult> OrderManager::cancelByLabelAsync(const std::string& label,
+                                                                        OrderCallback callback,
+                                                                        std::chrono::milliseconds timeout) {
+    Order order{};
+    order.label = label;
+    return dispatch([this, valid = isValidLabel(label)](OrderResult& result, long timeoutMs)
+                        -> boost::asio::awaitable<bool> {
+        if (!valid) {
+            result.order.rejectionReason = RejectReason::InvalidLabel;
+            result.error = toString(RejectReason::InvalidLabel);
+            co_return false;
+        }
+        if (executionBackend) {
+            co_await runBlocking([this, &result]() {
+                const auto& label = result.order.label;
+                result.cancelledCount = cancelTrackedWithBackend([&label](const Order& tracked) {
+                    return tracked.label == label;
+                });
+            });
+            co_return true;
+        }
 
-        Json::CharReaderBuilder reader;
-        Json::Value jsonResponse;
-        std::string errs;
-        std::istringstream responseStream(response);
+        Json::Value params;
+        params["label"] = result.order.label.str();
 
-        if (!Json::parseFromStream(reader, responseStream, &jsonResponse, &errs)) {
-            Logger::error("Failed to parse order response: ", errs);
-            return false;
+        Json::Value response;
+        if (!co_await sendPrivateRequest("private/cancel_by_label", params, timeoutMs, response, result.error)) {
+            Logger::error("Cancel by label ", result.order.label, " failed: ", result.error);
+            co_return false;
         }
+        result.cancelledCount = response.asInt();
 
-        updateOrderStatus(order, jsonResponse);
+        const auto& label = result.order.label;
+        untrackOrdersIf([&label](const Order& tracked) {
+            return tracked.label == label;
+        });
+        Logger::info("Cancelled ", result.cancelledCount, " orders with label ", label);
+        co_return true;
+    }, OrderResult{false, order, ""}, std::move(callback), timeout);
+}
 
-        if (order.status == "filled" || order.status == "partially_filled") {
-            double filledAmount = order.side == "buy" ? order.filledAmount : -order.filledAmount;
-            riskManager->updatePosition(order.instrumentName, filledAmount, order.averageFilledPrice);
+std::future<OrderManager::OrderResult> OrderManager::cancelAllAsync(OrderCallback callback,
+                                                                    std::chrono::milliseconds timeout) {
+    return dispatch([this](OrderResult& result, long timeoutMs) -> boost::asio::awaitable<bool> {
+        if (executionBackend) {
+            co_await runBlocking([this, &result]() {
+                result.cancelledCount = cancelTrackedWithBackend([](const Order&) { return true; });
+            });
+            co_return true;
         }
 
-        if (order.status != "rejected" && order.status != "cancelled") {
-            std::lock_guard<std::mutex> lock(ordersMutex);
-            activeOrders[order.orderId] = order;
+        Json::Value response;
+        if (!co_await sendPrivateRequest("private/cancel_all", Json::Value(Json::objectValue), timeoutMs, response,
+                                         result.error)) {
+            Logger::error("Mass cancel failed: ", result.error);
+            co_return false;
+        }
+        result.cancelledCount = response.asInt();
+
+        untrackOrdersIf([](const Order&) { return true; });
+        Logger::info("Cancelled ", result.cancelledCount, " orders");
+        co_return true;
+    }, OrderResult{false, Order{}, ""}, std::move(callback), timeout);
+}
+
+bool OrderManager::halt() {
+    if (halted.exchange(true, std::memory_order_acq_rel)) {
+        return false;
+    }
+    if (executionManager) {
+        executionManager->halt();
+    }
+
+    // The feed's session is already connected and authenticated; REST would
+    // open a new TLS connection first
+    bool sentOnFeed = fillFeed && fillFeed->cancelAll();
+    if (!sentOnFeed) {
+        // Counted so the destructor waits for it, but never refused by the in-flight limit
+        requestsInFlight.fetch_add(1, std::memory_order_acq_rel);
+        boost::asio::co_spawn(IoContext::instance().context(), haltCancelAll(), boost::asio::detached);
+    }
+    Logger::error("Trading halted: new orders are rejected, open orders cancelled ",
+                  sentOnFeed ? "on the fill feed session" : executionBackend ? "by the simulated backend" : "over REST");
+    return true;
+}
+
+boost::asio::awaitable<void> OrderManager::haltCancelAll() {
+    auto retryDelay = HALT_CANCEL_INITIAL_RETRY;
+    while (true) {
+        bool cancelled = false;
+        std::string error;
+        try {
+            if (executionBackend) {
+                int count = 0;
+                co_await runBlocking([this, &count]() {
+                    count = cancelTrackedWithBackend([](const Order&) { return true; });
+                });
+                Logger::info("Halt cancelled ", count, " orders");
+                cancelled = true;
+            } else {
+                // Not rate limited: the exchange takes a cancel_all whatever our bucket holds
+                Json::Value response;
+                cancelled = co_await postPrivateRequest("private/cancel_all", Json::Value(Json::objectValue),
+                                                        static_cast<long>(asyncOptions.defaultTimeout.count()),
+                                                        response, error);
+                if (cancelled) {
+                    untrackOrdersIf([](const Order&) { return true; });
+                    Logger::info("Halt cancelled ", response.asInt(), " orders");
+                }
+            }
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        if (cancelled) {
+            break;
+        }
+        if (!halted.load(std::memory_order_acquire) || stopping.load(std::memory_order_acquire)) {
+            Logger::warning("Gave up on the halt's cancel_all: trading resumed or shutting down");
+            break;
+        }
+        Logger::error("Halt cancel_all failed (", error, "), retrying in ", retryDelay.count(), " ms");
+        boost::asio::steady_timer timer(co_await boost::asio::this_coro::executor, retryDelay);
+        co_await timer.async_wait(boost::asio::use_awaitable);
+        retryDelay = std::min(retryDelay * 2, HALT_CANCEL_MAX_RETRY);
+        // The feed may have come back meanwhile
+        if (fillFeed && fillFeed->cancelAll()) {
+            break;
+        }
+    }
+    finishRequest();
+}
+
+void OrderManager::resume() {
+    if (!halted.load(std::memory_order_acquire)) {
+        return;
+    }
+    if (executionManager) {
+        executionManager->resume();
+    }
+    halted.store(false, std::memory_order_release);
+    Logger::warning("Trading resumed");
+}
+
+bool OrderManager::recover() {
+    return recover(RecoveryOptions());
+}
+
+bool OrderManager::recover(const RecoveryOptions& options) {
+    if (journal) {
+        Logger::warning("Order state was already recovered");
+        return true;
+    }
+    auto start = std::chrono::steady_clock::now();
+    journal = std::make_unique<OrderJournal>(options.journal);
+    if (!journal->open()) {
+        journal.reset();
+        Logger::error("No order journal, open orders and positions will not survive a restart");
+        return false;
+    }
+
+    size_t replayed = 0;
+    std::unordered_map<std::string, Order> openOrders = replayJournal(replayed);
+    for (const auto& [orderId, order] : openOrders) {
+        trackOrder(order, 0);
+    }
+
+    // A new UTC day starts a new PnL day and a new journal
+    auto utcDay = [](std::chrono::system_clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::hours>(time.time_since_epoch()).count() / 24;
+    };
+    if (utcDay(journal->createdAt()) != utcDay(std::chrono::system_clock::now())) {
+        pnlEngine->startNewDay();
+        journal->rewrite(snapshotState());
+    }
+    journaling.store(true, std::memory_order_release);
+
+    if (executionBackend) {
+        // A simulated backend starts out empty: nothing replayed is still resting
+        untrackOrdersIf([](const Order&) { return true; });
+    } else {
+        // Before trading starts, so the caller may wait for it
+        boost::asio::co_spawn(IoContext::instance().context(),
+                              reconcileWithExchange(options.currencies, static_cast<long>(options.timeout.count())),
+                              boost::asio::use_future).get();
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    Logger::info("Replayed ", replayed, " journal events with ", openOrders.size(), " open orders, ready to trade in ",
+                 elapsed.count(), " ms");
+    return true;
+}
+
+std::unordered_map<std::string, Order> OrderManager::replayJournal(size_t& replayed) {
+    std::unordered_map<std::string, Order> openOrders;
+    InstrumentRegistry& registry = InstrumentRegistry::instance();
+    replayed = journal->replay([&](const JournalRecord& record) {
+        if (record.instrument.empty()) {
+            return;
+        }
+        InstrumentId instrument = registry.intern(record.instrument.view());
+        switch (record.event) {
+            case JournalEvent::Fill:
+            case JournalEvent::Position:
+                riskManager->updatePosition(instrument, record.amount, record.price);
+                pnlEngine->onFill(instrument, record.amount, record.price);
+                break;
+            case JournalEvent::New:
+                // Whether it reached the exchange is for reconciliation to find out
+                break;
+            default:
+                if (record.order.orderId.empty()) {
+                    break;
+                }
+                if (record.event == JournalEvent::Cancel || record.event == JournalEvent::Reject ||
+                    isTerminal(record.order.status)) {
+                    openOrders.erase(record.order.orderId.str());
+                } else {
+                    Order& order = openOrders[record.order.orderId.str()];
+                    order = record.order;
+                    order.instrumentId = instrument;
+                }
+                break;
+        }
+    });
+    return openOrders;
+}
+
+std::vector<JournalRecord> OrderManager::snapshotState() {
+    std::vector<JournalRecord> snapshot;
+    InstrumentRegistry& registry = InstrumentRegistry::instance();
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    size_t count = std::min(registry.size(), InstrumentRegistry::MAX_INSTRUMENTS);
+    for (InstrumentId instrument = 0; instrument < count; ++instrument) {
+        double size;
+        double averagePrice;
+        if (riskManager->getPosition(instrument, size, averagePrice) && std::abs(size) >= POSITION_TOLERANCE) {
+            JournalRecord record;
+            record.timestampNs = now;
+            record.event = JournalEvent::Position;
+            record.amount = size;
+            record.price = averagePrice;
+            record.instrument = registry.name(instrument);
+            snapshot.push_back(record);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(ordersMutex);
+    for (size_t i = 0; i < activeOrders.size(); ++i) {
+        JournalRecord record;
+        record.timestampNs = now;
+        record.event = JournalEvent::Ack;
+        record.order = orderPool.get(activeOrders.at(i));
+        record.instrument = record.order.instrumentName();
+        snapshot.push_back(record);
+    }
+    return snapshot;
+}
+
+boost::asio::awaitable<void> OrderManager::reconcileWithExchange(std::vector<std::string> currencies, long timeoutMs) {
+    InstrumentRegistry& registry = InstrumentRegistry::instance();
+    std::unordered_map<std::string, double> positions = riskManager->getCurrentPositions();
+    for (const auto& [name, size] : positions) {
+        currencies.push_back(settlementCurrency(registry.find(name)));
+    }
+    {
+        std::lock_guard<std::mutex> lock(ordersMutex);
+        for (size_t i = 0; i < activeOrders.size(); ++i) {
+            currencies.push_back(settlementCurrency(orderPool.get(activeOrders.at(i)).instrumentId));
+        }
+    }
+    std::sort(currencies.begin(), currencies.end());
+    currencies.erase(std::unique(currencies.begin(), currencies.end()), currencies.end());
+
+    std::unordered_map<std::string, Order> exchangeOrders;
+    bool allOrdersFetched = true;
+    for (const std::string& currency : currencies) {
+        Json::Value params;
+        params["currency"] = currency;
+        Json::Value result;
+        std::string error;
+
+        if (!co_await sendPrivateRequest("private/get_open_orders_by_currency", params, timeoutMs, result, error)) {
+            Logger::warning("Could not fetch open ", currency, " orders: ", error);
+            allOrdersFetched = false;
+        } else {
+            for (const Json::Value& state : result) {
+                Order order{};
+                if (FillFeed::parseOrder(state, order) && !isTerminal(order.status)) {
+                    exchangeOrders[order.orderId.str()] = order;
+                }
+            }
+        }
+
+        if (!co_await sendPrivateRequest("private/get_positions", params, timeoutMs, result, error)) {
+            Logger::warning("Could not fetch ", currency, " positions, keeping the journaled ones: ", error);
+            continue;
+        }
+        for (const Json::Value& position : result) {
+            InstrumentId instrument = registry.intern(position["instrument_name"].asString());
+            reconcilePosition(instrument, position["size"].asDouble(), position["average_price"].asDouble());
+            positions.erase(registry.name(instrument).str());
+        }
+        // Closed while we were down: the exchange no longer lists them
+        for (auto it = positions.begin(); it != positions.end();) {
+            InstrumentId instrument = registry.find(it->first);
+            if (settlementCurrency(instrument) == currency) {
+                reconcilePosition(instrument, 0, 0);
+                it = positions.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // Orders that finished while nobody was listening; their fills are in the positions
+    if (allOrdersFetched) {
+        untrackOrdersIf([&exchangeOrders](const Order& tracked) {
+            return exchangeOrders.count(tracked.orderId.str()) == 0;
+        });
+    }
+    for (const auto& [orderId, order] : exchangeOrders) {
+        trackOrder(order, 0);
+    }
+    Logger::info("Reconciled with the exchange: ", exchangeOrders.size(), " open orders in ", currencies.size(),
+                 " currencies");
+}
+
+void OrderManager::reconcilePosition(InstrumentId instrument, double exchangeSize, double exchangeAveragePrice) {
+    double size = 0;
+    double averagePrice = 0;
+    riskManager->getPosition(instrument, size, averagePrice);
+    double difference = exchangeSize - size;
+    if (std::abs(difference) < POSITION_TOLERANCE) {
+        return;
+    }
+    Logger::warning("Position in ", InstrumentRegistry::instance().name(instrument), " is ", exchangeSize,
+                    " on the exchange but ", size, " locally, booking the difference");
+    // As a fill, so that PnL and the journal follow
+    bookFill(instrument, difference, exchangeAveragePrice > 0 ? exchangeAveragePrice : averagePrice);
+}
+
+int OrderManager::cancelAllByInstrument(const std::string& instrument) {
+    OrderResult result = cancelAllByInstrumentAsync(instrument).get();
+    return result.success ? result.cancelledCount : -1;
+}
+
+int OrderManager::cancelByLabel(const std::string& label) {
+    OrderResult result = cancelByLabelAsync(label).get();
+    return result.success ? result.cancelledCount : -1;
+}
+
+void OrderManager::setModifyMode(ModifyMode mode) {
+    modifyMode.store(mode, std::memory_order_relaxed);
+}
+
+std::future<OrderManager::OrderResult> OrderManager::dispatch(RequestFn request, OrderResult initial,
+                                                              OrderCallback callback,
+                                                              std::chrono::milliseconds timeout) {
+    auto promise = std::make_shared<std::promise<OrderResult>>();
+    std::future<OrderResult> future = promise->get_future();
+
+    auto complete = [promise, callback](OrderResult& result) {
+        if (callback) {
+            try {
+                callback(result);
+            } catch (const std::exception& e) {
+                Logger::error("Error in order completion callback: ", e.what());
+            }
+        }
+        promise->set_value(std::move(result));
+    };
+
+    if (timeout <= std::chrono::milliseconds::zero()) {
+        timeout = asyncOptions.defaultTimeout;
+    }
+    auto requestDeadline = RequestDispatcher::Clock::now() + timeout;
+
+    size_t current = requestsInFlight.load(std::memory_order_relaxed);
+    do {
+        if (current >= asyncOptions.maxInFlight) {
+            Logger::warning("Order request rejected: In-flight limit of ", asyncOptions.maxInFlight, " reached");
+            initial.order.rejectionReason = RejectReason::InFlightLimit;
+            initial.error = toString(RejectReason::InFlightLimit);
+            complete(initial);
+            return future;
+        }
+    } while (!requestsInFlight.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel));
+
+    boost::asio::co_spawn(IoContext::instance().context(),
+                          runRequest(std::move(request), std::make_shared<OrderResult>(std::move(initial)),
+                                     std::move(complete), requestDeadline),
+                          boost::asio::detached);
+    return future;
+}
+
+boost::asio::awaitable<void> OrderManager::runRequest(RequestFn request, std::shared_ptr<OrderResult> shared,
+                                                      std::function<void(OrderResult&)> complete,
+                                                      RequestDispatcher::Clock::time_point deadline) {
+    OrderResult& result = *shared;
+    long remaining = remainingMs(deadline);
+    if (remaining <= 0) {
+        result.order.rejectionReason = RejectReason::Timeout;
+        result.error = "Request timed out before it was sent";
+    } else {
+        try {
+            result.success = co_await request(result, remaining);
+        } catch (const std::exception& e) {
+            result.success = false;
+            result.error = e.what();
+        }
+    }
+    complete(result);
+    finishRequest();
+}
+
+long OrderManager::remainingMs(RequestDispatcher::Clock::time_point deadline) {
+    return static_cast<long>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(deadline - RequestDispatcher::Clock::now()).count());
+}
+
+void OrderManager::finishRequest() {
+    if (requestsInFlight.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(drainMutex);
+        drainCV.notify_all();
+    }
+}
+
+void OrderManager::drainRequests() {
+    std::unique_lock<std::mutex> lock(drainMutex);
+    drainCV.wait(lock, [this]() { return requestsInFlight.load(std::memory_order_acquire) == 0; });
+}
+
+boost::asio::awaitable<void> OrderManager::runBlocking(std::function<void()> work) {
+    co_await boost::asio::async_initiate<decltype(boost::asio::use_awaitable), void()>(
+        [this, &work](auto handler) {
+            // The dispatcher's tasks are copyable; the handler is not
+            auto shared = std::make_shared<decltype(handler)>(std::move(handler));
+            auto resume = [shared]() {
+                boost::asio::post(IoContext::instance().context(), [shared]() { (*shared)(); });
+            };
+            bool queued = requestDispatcher->submit([work = std::move(work), resume](RequestDispatcher::Clock::time_point) {
+                work();
+                resume();
+            }, RequestDispatcher::Clock::time_point::max());
+            // Each request holds at most one slot, so this only happens while stopping
+            if (!queued) {
+                Logger::warning("No dispatcher thread for a blocking backend call, running it on the I/O thread");
+                work();
+                resume();
+            }
+        },
+        boost::asio::use_awaitable);
+}
+
+boost::asio::awaitable<bool> OrderManager::ensureValidToken() {
+    std::shared_ptr<const AuthManager::Token> token = authManager.currentToken();
+    if (token && AuthManager::Clock::now() < token->expiresAt) {
+        co_return true;
+    }
+    // Expired: the refresh is a blocking request of its own
+    bool valid = false;
+    co_await runBlocking([this, &valid]() { valid = authManager.ensureValidToken(); });
+    co_return valid;
+}
+
+void OrderManager::setAsyncOptions(const AsyncOptions& options) {
+    drainRequests();
+    requestDispatcher->stop();
+    asyncOptions = options;
+    requestDispatcher = std::make_unique<RequestDispatcher>(asyncOptions.workerThreads, asyncOptions.maxInFlight);
+}
+
+size_t OrderManager::getInFlightCount() const {
+    return requestsInFlight.load(std::memory_order_relaxed);
+}
+
+boost::asio::awaitable<bool> OrderManager::sendPlaceOrder(Order& order, long timeoutMs, std::string& error) {
+    auto start = std::chrono::high_resolution_clock::now(); // Start time
+    auto reject = [&order, &error](RejectReason reason) {
+        order.status = OrderStatus::Rejected;
+        order.rejectionReason = reason;
+        error = toString(reason);
+        return false;
+    };
+    if (halted.load(std::memory_order_acquire)) {
+        co_return reject(RejectReason::Halted);
+    }
+    if (order.label.empty()) {
+        assignClientLabel(order);
+    } else if (!isValidLabel(order.label.view())) {
+        co_return reject(RejectReason::InvalidLabel);
+    }
+    // The full amount counts as open exposure while the order is in flight
+    double reserved = 0;
+    try {
+        RiskRejection rejection = riskManager->checkOrder(order);
+        if (rejection != RiskRejection::None) {
+            Logger::warning("Order rejected: ", toString(rejection));
+            reject(RejectReason::RiskCheck);
+            error = toString(rejection);
+            co_return false;
+        }
+        reserved = order.amount;
+
+        // Credits are only spent once the order is known to go out
+        if (!co_await checkRateLimit(order.instrumentId)) {
+            Logger::warning("Order rejected: Rate limit exceeded");
+            adjustExposure(order, -reserved);
+            co_return reject(RejectReason::RateLimit);
+        }
+
+        journalOrder(JournalEvent::New, order);
+        if (executionBackend) {
+            co_await runBlocking([this, &order]() { executionBackend->place(order); });
+            if (order.status == OrderStatus::Rejected) {
+                error = toString(order.rejectionReason);
+            }
+        } else if (!co_await postPlaceOrder(order, timeoutMs, error)) {
+            adjustExposure(order, -reserved);
+            journalOrder(JournalEvent::Reject, order);
+            co_return false;
+        }
+        if (order.status == OrderStatus::Rejected) {
+            journalOrder(JournalEvent::Reject, order);
+        }
+
+        // With the fill feed running, its deduplicated trades are the only source of position updates
+        if (!fillFeed && order.filledAmount > 0) {
+            double filledAmount = order.isBuy() ? order.filledAmount : -order.filledAmount;
+            bookFill(order.instrumentId, filledAmount, order.averageFilledPrice);
+        }
+
+        if (order.status == OrderStatus::Open || order.status == OrderStatus::PartiallyFilled ||
+            order.status == OrderStatus::Untriggered) {
+            trackOrder(order, reserved);
+            // The halt landed while the request was out, possibly after its cancel_all
+            std::string cancelError;
+            if (halted.load(std::memory_order_acquire) &&
+                co_await sendCancelOrder(order.orderId.view(), timeoutMs, cancelError)) {
+                order.status = OrderStatus::Cancelled;
+                untrackOrder(order.orderId.view());
+            }
+        } else {
+            adjustExposure(order, -reserved);
         }
 
         auto end = std::chrono::high_resolution_clock::now(); // End time
         std::chrono::duration<double, std::milli> latency = end - start;
         Logger::info("Order placement latency: ", latency.count(), " ms");
 
-        return order.status != "rejected";
+        co_return order.status != OrderStatus::Rejected;
 
     }
     catch(const std::exception& e) {
         Logger::error("Error placing order: ", e.what());
-        return false;
+        adjustExposure(order, -reserved);
+        order.status = OrderStatus::Failed;
+        error = e.what();
+        co_return false;
     }
 }
 
-bool OrderManager::cancelOrder(const std::string& orderId) {
-    if (!authManager.refreshToken()) {
-        Logger::error("Failed to refresh access token");
+boost::asio::awaitable<bool> OrderManager::postPlaceOrder(Order& order, long timeoutMs, std::string& error) {
+    auto reject = [&order, &error](RejectReason reason) {
+        order.status = OrderStatus::Rejected;
+        order.rejectionReason = reason;
+        error = toString(reason);
         return false;
+    };
+    if (!co_await ensureValidToken()) {
+        Logger::error("No valid authentication token");
+        co_return reject(RejectReason::Authentication);
     }
 
-    std::string endpoint = "private/cancel";
-    Json::Value request;
-    request["jsonrpc"] = "2.0";
-    request["id"] = 2;
-    request["method"] = endpoint;
+    OrderEncoder::Buffer payload;
+    if (!orderEncoder.encodePlace(order, nextRequestId++, payload)) {
+        Logger::error("Failed to encode order for ", order.instrumentName());
+        co_return reject(RejectReason::Encoding);
+    }
 
-    Json::Value params;
-    params["order_id"] = orderId;
-    request["params"] = params;
+    const char* endpoint = order.isBuy() ? "private/buy" : "private/sell";
+    std::string response = co_await postRequest(endpoint, payload.data, payload.length, timeoutMs);
 
-    Json::StreamWriterBuilder writer;
-    std::string payload = Json::writeString(writer, request);
+    Json::CharReaderBuilder reader;
+    Json::Value jsonResponse;
+    std::string errs;
+    std::istringstream responseStream(response);
+
+    if (!Json::parseFromStream(reader, responseStream, &jsonResponse, &errs)) {
+        Logger::error("Failed to parse order response: ", errs);
+        co_return reject(RejectReason::InvalidResponse);
+    }
 
-    std::string response = postRequest(endpoint, payload);
+    updateOrderStatus(order, jsonResponse, error);
+    co_return true;
+}
+
+boost::asio::awaitable<bool> OrderManager::sendCancelOrder(std::string_view orderId, long timeoutMs, std::string& error) {
+    if (!co_await checkRateLimit(trackedInstrument(orderId))) {
+        error = toString(RejectReason::RateLimit);
+        co_return false;
+    }
+
+    if (executionBackend) {
+        Order order;
+        if (!findOrder(orderId, order)) {
+            error = "Unknown order";
+            co_return false;
+        }
+        co_await runBlocking([this, &order]() { executionBackend->cancel(order); });
+        if (order.status != OrderStatus::Cancelled) {
+            error = "Order is no longer open";
+            co_return false;
+        }
+        co_return true;
+    }
+
+    if (!co_await ensureValidToken()) {
+        Logger::error("No valid access token");
+        error = toString(RejectReason::Authentication);
+        co_return false;
+    }
+
+    OrderEncoder::Buffer payload;
+    if (!orderEncoder.encodeCancel(orderId, nextRequestId++, payload)) {
+        error = "Encoding failed";
+        co_return false;
+    }
+
+    std::string response = co_await postRequest("private/cancel", payload.data, payload.length, timeoutMs);
 
     Json::CharReaderBuilder reader;
     Json::Value jsonResponse;
@@ -126,78 +838,466 @@ bool OrderManager::cancelOrder(const std::string& orderId) {
 
     if(!Json::parseFromStream(reader, responseStream, &jsonResponse, &errs)) {
         Logger::error("Error parsing cancel order response: ", errs);
-        return false;
+        error = toString(RejectReason::InvalidResponse);
+        co_return false;
     }
 
     if(jsonResponse["result"].isObject()) {
         Logger::info("Order canceled successfully. Order ID: ", jsonResponse["result"]["order_id"].asString());
-        return true;
+        co_return true;
     }
     else{
-        Logger::error("Order cancellation failed: ", jsonResponse["error"]["message"].asString());
+        error = jsonResponse["error"]["message"].asString();
+        Logger::error("Order cancellation failed: ", error);
+        co_return false;
+    }
+}
+
+boost::asio::awaitable<bool> OrderManager::sendEditOrder(const std::string& orderId, Order& order, long timeoutMs, std::string& error) {
+    if (!co_await checkRateLimit(trackedInstrument(orderId))) {
+        error = toString(RejectReason::RateLimit);
+        co_return false;
+    }
+
+    // Growing an order needs the extra exposure before the edit goes out
+    Order current;
+    double increase = 0;
+    if (findOrder(orderId, current)) {
+        increase = std::max(0.0, order.amount - current.amount);
+        if (increase > 0 && !riskManager->reserveExposure(current.instrumentId, current.side, increase)) {
+            error = toString(RejectReason::RiskCheck);
+            co_return false;
+        }
+    }
+    auto fail = [&](std::string reason) {
+        adjustExposure(current, -increase);
+        error = std::move(reason);
         return false;
+    };
+    // Swaps the reservation for the tracked order's new open remainder
+    auto settle = [&](Order& tracked, double previousOpen) {
+        adjustExposure(tracked, openAmount(tracked) - previousOpen - increase);
+        increase = 0;
+    };
+
+    if (executionBackend) {
+        Order amended;
+        bool found = findOrder(orderId, amended);
+        bool applied = false;
+        if (found) {
+            co_await runBlocking([this, &amended, &order, &applied]() {
+                applied = executionBackend->amend(amended, order.amount, order.price);
+            });
+        }
+        if (!applied) {
+            co_return fail("Edit rejected");
+        }
+        std::lock_guard<std::mutex> lock(ordersMutex);
+        OrderHandle handle = activeOrders.find(orderId);
+        if (handle != INVALID_ORDER_HANDLE) {
+            double previousOpen = openAmount(orderPool.get(handle));
+            if (!activeOrders.update(handle, amended)) {
+                Logger::error("Order ", orderId, " keeps its tracked state: the amended order ID is taken");
+            }
+            settle(orderPool.get(handle), previousOpen);
+            journalOrder(JournalEvent::Update, orderPool.get(handle));
+        }
+        adjustExposure(current, -increase);
+        order = amended;
+        co_return true;
+    }
+
+    if (!co_await ensureValidToken()) {
+        co_return fail(toString(RejectReason::Authentication));
+    }
+
+    // The tracked order knows its instrument when the caller's copy does not
+    InstrumentId instrument = current.instrumentId != INVALID_INSTRUMENT ? current.instrumentId : order.instrumentId;
+    OrderEncoder::Buffer payload;
+    if (!orderEncoder.encodeEdit(instrument, orderId, order.amount, order.price, nextRequestId++, payload)) {
+        co_return fail(toString(RejectReason::Encoding));
     }
+
+    std::string response = co_await postRequest("private/edit", payload.data, payload.length, timeoutMs);
+
+    Json::CharReaderBuilder reader;
+    Json::Value jsonResponse;
+    std::string errs;
+    std::istringstream responseStream(response);
+    if (!Json::parseFromStream(reader, responseStream, &jsonResponse, &errs)) {
+        co_return fail(toString(RejectReason::InvalidResponse));
+    }
+    if (!jsonResponse["result"].isObject()) {
+        co_return fail(jsonResponse["error"]["message"].asString());
+    }
+
+    updateOrderStatus(order, jsonResponse, error);
+
+    std::lock_guard<std::mutex> lock(ordersMutex);
+    OrderHandle handle = activeOrders.find(orderId);
+    if (handle != INVALID_ORDER_HANDLE) {
+        Order& tracked = orderPool.get(handle);
+        double previousOpen = openAmount(tracked);
+        tracked.amount = order.amount;
+        tracked.price = order.price;
+        tracked.status = order.status;
+        tracked.filledAmount = order.filledAmount;
+        tracked.averageFilledPrice = order.averageFilledPrice;
+        settle(tracked, previousOpen);
+        journalOrder(JournalEvent::Update, tracked);
+        order = tracked;
+    }
+    // The order finished meanwhile
+    adjustExposure(current, -increase);
+    co_return true;
 }
 
-bool OrderManager::modifyOrder(const std::string& orderId, const Order& newOrder) {
-    Logger::info("Modifying order with ID: ", orderId);
+boost::asio::awaitable<bool> OrderManager::sendCancelReplace(const std::string& orderId, Order& order, long timeoutMs, std::string& error) {
+    auto deadline = RequestDispatcher::Clock::now() + std::chrono::milliseconds(timeoutMs);
+    // The replacement inherits instrument, side and type from the original order
+    {
+        std::lock_guard<std::mutex> lock(ordersMutex);
+        OrderHandle handle = activeOrders.find(orderId);
+        if (handle != INVALID_ORDER_HANDLE) {
+            Order replacement = orderPool.get(handle);
+            replacement.amount = order.amount;
+            replacement.price = order.price;
+            replacement.filledAmount = 0;
+            replacement.averageFilledPrice = 0;
+            replacement.status = OrderStatus::New;
+            replacement.rejectionReason = RejectReason::None;
+            order = replacement;
+        }
+    }
 
-    if (!cancelOrder(orderId)) {
+    if (!co_await sendCancelOrder(orderId, timeoutMs, error)) {
         Logger::error("Failed to cancel the existing order. Modification aborted.");
-        return false;
+        co_return false;
     }
+    untrackOrder(orderId);
     Logger::info("Order canceled successfully. Proceeding to place a new order...");
 
-    if (placeOrder(newOrder)) {
-        Logger::info("Order modified successfully!");
-        return true;
-    } else {
+    // The place only gets what the cancel left of the timeout
+    long remaining = remainingMs(deadline);
+    if (remaining <= 0) {
+        Logger::error("No time left to place the new order. Modification failed.");
+        order.rejectionReason = RejectReason::Timeout;
+        error = toString(RejectReason::Timeout);
+        co_return false;
+    }
+    if (!co_await sendPlaceOrder(order, remaining, error)) {
         Logger::error("Failed to place the new order. Modification failed.");
-        return false;
+        co_return false;
+    }
+    co_return true;
+}
+
+boost::asio::awaitable<bool> OrderManager::sendPrivateRequest(const std::string& method, const Json::Value& params,
+                                                              long timeoutMs, Json::Value& result, std::string& error) {
+    // Mass-cancel and other account-wide requests only draw on the global bucket
+    if (!co_await checkRateLimit(INVALID_INSTRUMENT)) {
+        error = toString(RejectReason::RateLimit);
+        co_return false;
     }
+    co_return co_await postPrivateRequest(method, params, timeoutMs, result, error);
 }
 
+boost::asio::awaitable<bool> OrderManager::postPrivateRequest(const std::string& method, const Json::Value& params,
+                                                              long timeoutMs, Json::Value& result, std::string& error) {
+    if (!co_await ensureValidToken()) {
+        error = toString(RejectReason::Authentication);
+        co_return false;
+    }
+
+    Json::Value request;
+    request["jsonrpc"] = "2.0";
+    request["id"] = static_cast<Json::UInt64>(nextRequestId++);
+    request["method"] = method;
+    request["params"] = params;
+
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "";
+    std::string payload = Json::writeString(writer, request);
+    std::string response = co_await postRequest(method.c_str(), payload.data(), payload.size(), timeoutMs);
 
+    Json::CharReaderBuilder reader;
+    Json::Value jsonResponse;
+    std::string errs;
+    std::istringstream responseStream(response);
+    if (!Json::parseFromStream(reader, responseStream, &jsonResponse, &errs)) {
+        error = toString(RejectReason::InvalidResponse);
+        co_return false;
+    }
 
-std::string OrderManager::postRequest(const std::string& endpoint, const std::string& payload) {
-    HttpClient client;
-    std::string url = baseUrl + endpoint;
+    if (jsonResponse.isMember("error")) {
+        error = jsonResponse["error"]["message"].asString();
+        co_return false;
+    }
+    result = jsonResponse["result"];
+    co_return true;
+}
 
-    return client.post(url, payload, {
-        {"Authorization", "Bearer " + authManager.getAccessToken()},
+boost::asio::awaitable<std::string> OrderManager::postRequest(const char* endpoint, const char* payload,
+                                                              size_t length, long timeoutMs) {
+    std::shared_ptr<const AuthManager::Token> token = authManager.currentToken();
+    AsyncHttpClient::Request request;
+    request.target = apiPath + endpoint;
+    request.body.assign(payload, length);
+    request.headers = {
+        {"Authorization", token ? token->authorizationHeader : std::string()},
         {"Content-Type", "application/json"}
+    };
+    request.timeout = std::chrono::milliseconds(timeoutMs);
+
+    // Suspends the request's coroutine, not a thread
+    AsyncHttpClient::Response response = co_await restClient.request(std::move(request));
+    if (!response.error.empty()) {
+        Logger::error("Request to ", endpoint, " failed: ", response.error);
+    }
+    co_return response.body;
+}
+
+boost::asio::awaitable<bool> OrderManager::checkRateLimit(InstrumentId instrument) {
+    std::chrono::nanoseconds delay;
+    if (!rateLimiter.acquire(instrument, delay)) {
+        co_return false;
+    }
+    // Pacing waits on a timer, so the I/O thread keeps serving everything else
+    if (delay > std::chrono::nanoseconds::zero()) {
+        boost::asio::steady_timer timer(co_await boost::asio::this_coro::executor, delay);
+        co_await timer.async_wait(boost::asio::use_awaitable);
+    }
+    co_return true;
+}
+
+void OrderManager::assignClientLabel(Order& order) {
+    char label[sizeof(order.label)];
+    int length = std::snprintf(label, sizeof(label), "c%llx-%llx", static_cast<unsigned long long>(sessionStartMs),
+                               static_cast<unsigned long long>(nextClientOrder.fetch_add(1, std::memory_order_relaxed)));
+    order.label.assign(std::string_view(label, static_cast<size_t>(length)));
+}
+
+InstrumentId OrderManager::trackedInstrument(std::string_view orderId) {
+    std::lock_guard<std::mutex> lock(ordersMutex);
+    OrderHandle handle = activeOrders.find(orderId);
+    return handle != INVALID_ORDER_HANDLE ? orderPool.get(handle).instrumentId : INVALID_INSTRUMENT;
+}
+
+void OrderManager::updateOrderStatus(Order& order, const Json::Value& response, std::string& error) {
+    if (response["result"].isObject()) {
+        // buy, sell and edit wrap the order state as result.order alongside result.trades
+        const Json::Value& state = response["result"].isMember("order") ? response["result"]["order"] : response["result"];
+        order.orderId = state["order_id"].asString();
+        if (!parseOrderStatus(state["order_state"].asString(), order.status)) {
+            order.status = OrderStatus::Open;
+        }
+        order.filledAmount = state["filled_amount"].asDouble();
+        order.averageFilledPrice = state["average_price"].asDouble();
+        Logger::info("Order ", order.orderId, " status: ", toString(order.status));
+    } else {
+        order.status = OrderStatus::Rejected;
+        order.rejectionReason = RejectReason::Exchange;
+        error = response["error"]["message"].asString();
+        Logger::warning("Order rejected: ", error);
+    }
+}
+
+double OrderManager::openAmount(const Order& order) {
+    return isTerminal(order.status) ? 0.0 : std::max(0.0, order.remainingAmount());
+}
+
+void OrderManager::adjustExposure(const Order& order, double delta) {
+    riskManager->adjustExposure(order.instrumentId, order.side, delta);
+}
+
+void OrderManager::trackOrder(const Order& order, double reserved) {
+    std::lock_guard<std::mutex> lock(ordersMutex);
+    // The feed may have reported the order finished before the REST reply arrived
+    if (finishedOrders.contains(order.orderId.view())) {
+        adjustExposure(order, -reserved);
+        return;
+    }
+
+    OrderHandle handle = activeOrders.find(order.orderId.view());
+    if (handle != INVALID_ORDER_HANDLE) {
+        double trackedOpen = openAmount(orderPool.get(handle));
+        reserved += trackedOpen;
+        if (!activeOrders.update(handle, order)) {
+            Logger::error("Order ", order.orderId, " keeps its tracked state: the new order ID is taken");
+            adjustExposure(order, trackedOpen - reserved);
+            return;
+        }
+    } else {
+        handle = orderPool.acquire(order);
+        if (handle == INVALID_ORDER_HANDLE || !activeOrders.insert(handle)) {
+            Logger::error("Order ", order.orderId, " is not tracked locally: ",
+                          handle == INVALID_ORDER_HANDLE ? "order pool exhausted" : "no order ID");
+            orderPool.release(handle);
+            adjustExposure(order, -reserved);
+            return;
+        }
+    }
+    adjustExposure(order, openAmount(order) - reserved);
+    journalOrder(JournalEvent::Ack, order);
+}
+
+void OrderManager::journalOrder(JournalEvent event, const Order& order) {
+    if (journaling.load(std::memory_order_acquire)) {
+        journal->append(event, order);
+    }
+}
+
+void OrderManager::untrackOrder(std::string_view orderId) {
+    std::lock_guard<std::mutex> lock(ordersMutex);
+    OrderHandle handle = activeOrders.find(orderId);
+    if (handle != INVALID_ORDER_HANDLE) {
+        releaseTracked(handle);
+    }
+}
+
+void OrderManager::untrackOrdersIf(const std::function<bool(const Order&)>& predicate) {
+    std::lock_guard<std::mutex> lock(ordersMutex);
+    // Backwards, since erasing moves the last order into the erased one's place
+    for (size_t i = activeOrders.size(); i-- > 0;) {
+        OrderHandle handle = activeOrders.at(i);
+        if (predicate(orderPool.get(handle))) {
+            releaseTracked(handle);
+        }
+    }
+}
+
+void OrderManager::releaseTracked(OrderHandle handle) {
+    const Order& order = orderPool.get(handle);
+    adjustExposure(order, -openAmount(order));
+    journalOrder(JournalEvent::Cancel, order);
+    finishedOrders.insert(order.orderId.view());
+    activeOrders.erase(handle);
+    reportToPriceWatch(handle, true);
+    orderPool.release(handle);
+}
+
+void OrderManager::reportToPriceWatch(OrderHandle handle, bool final) {
+    if (marketDataIntegrator) {
+        marketDataIntegrator->onOrderReport(handle, final);
+    }
+}
+
+void OrderManager::bookFill(InstrumentId instrument, double signedAmount, double price) {
+    riskManager->updatePosition(instrument, signedAmount, price);
+    pnlEngine->onFill(instrument, signedAmount, price);
+    if (journaling.load(std::memory_order_acquire)) {
+        journal->append(JournalEvent::Fill, instrument, signedAmount, price);
+    }
+}
+
+void OrderManager::onExecutionReport(OrderHandle handle) {
+    Order& order = orderPool.get(handle);
+    if (!fillFeed && order.filledAmount > 0) {
+        double filledAmount = order.isBuy() ? order.filledAmount : -order.filledAmount;
+        bookFill(order.instrumentId, filledAmount, order.averageFilledPrice);
+    }
+    reportToPriceWatch(handle, false);
+
+    if (!isTerminal(order.status) && !order.orderId.empty()) {
+        std::lock_guard<std::mutex> lock(ordersMutex);
+        // A late or duplicate report must not revive a finished order and its exposure
+        if (finishedOrders.contains(order.orderId.view())) {
+            Logger::warning("Dropping execution report for finished order ", order.orderId);
+            reportToPriceWatch(handle, true);
+            orderPool.release(handle);
+            return;
+        }
+        if (activeOrders.insert(handle)) {
+            // Queued orders reserved nothing up front; count them once they rest
+            adjustExposure(order, openAmount(order));
+            journalOrder(JournalEvent::Ack, order);
+            return;
+        }
+    } else if (isTerminal(order.status) && !order.orderId.empty()) {
+        // e.g. a queued cancel: drop the tracked copy as well
+        untrackOrder(order.orderId.view());
+    }
+    reportToPriceWatch(handle, true);
+    orderPool.release(handle);
+}
+
+void OrderManager::setExecutionBackend(std::shared_ptr<ExecutionBackend> backend) {
+    if (!backend) {
+        Logger::warning("Ignoring empty execution backend");
+        return;
+    }
+
+    // The backend reports its own fills; exchange fills would be double counted
+    if (fillFeed) {
+        fillFeed->stop();
+        fillFeed.reset();
+    }
+
+    executionBackend = backend;
+    executionBackend->setFillCallback([this](const Order& order, double amount, double price) {
+        this->onFill(order, amount, price);
     });
+    if (executionManager) {
+        executionManager->stop();
+        executionManager->setBackend(backend);
+        executionManager->start();
+    }
+    Logger::info("Orders are now routed to a simulated execution backend");
 }
 
-bool OrderManager::checkRateLimit() {
-    std::lock_guard<std::mutex> lock(rateLimitMutex);
-    auto now = std::chrono::system_clock::now();
-    
-    while (!requestTimes.empty() && 
-           std::chrono::duration_cast<std::chrono::seconds>(now - requestTimes.front()).count() >= 1) {
-        requestTimes.pop();
+bool OrderManager::findOrder(std::string_view orderId, Order& order) {
+    std::lock_guard<std::mutex> lock(ordersMutex);
+    OrderHandle handle = activeOrders.find(orderId);
+    if (handle == INVALID_ORDER_HANDLE) {
+        return false;
     }
-    
-    if (requestTimes.size() >= MAX_REQUESTS_PER_SECOND) {
+    order = orderPool.get(handle);
+    return true;
+}
+
+bool OrderManager::findOrderByLabel(std::string_view label, Order& order) {
+    if (!isValidLabel(label)) {
         return false;
     }
-    
-    requestTimes.push(now);
+    std::lock_guard<std::mutex> lock(ordersMutex);
+    OrderHandle handle = activeOrders.findByLabel(label);
+    if (handle == INVALID_ORDER_HANDLE) {
+        return false;
+    }
+    order = orderPool.get(handle);
     return true;
 }
 
-void OrderManager::updateOrderStatus(Order& order, const Json::Value& response) {
-    if (response["result"].isObject()) {
-        order.orderId = response["result"]["order_id"].asString();
-        order.status = response["result"]["order_state"].asString();
-        order.filledAmount = response["result"]["filled_amount"].asDouble();
-        order.averageFilledPrice = response["result"]["average_price"].asDouble();
-        Logger::info("Order ", order.orderId, " status: ", order.status);
-    } else {
-        order.status = "rejected";
-        order.rejectionReason = response["error"]["message"].asString();
-        Logger::warning("Order rejected: ", order.rejectionReason);
+size_t OrderManager::getOpenOrderCount() {
+    std::lock_guard<std::mutex> lock(ordersMutex);
+    return activeOrders.size();
+}
+
+int OrderManager::cancelTrackedWithBackend(const std::function<bool(const Order&)>& predicate) {
+    std::vector<Order> matching;
+    {
+        std::lock_guard<std::mutex> lock(ordersMutex);
+        for (size_t i = 0; i < activeOrders.size(); ++i) {
+            const Order& order = orderPool.get(activeOrders.at(i));
+            if (predicate(order)) {
+                matching.push_back(order);
+            }
+        }
+    }
+
+    int cancelled = 0;
+    for (Order& order : matching) {
+        executionBackend->cancel(order);
+        if (order.status == OrderStatus::Cancelled) {
+            untrackOrder(order.orderId.view());
+            ++cancelled;
+        }
     }
+    return cancelled;
+}
+
+void OrderManager::setRateLimits(const RateLimiter::Config& config) {
+    rateLimiter.configure(config);
 }
 
 void OrderManager::setRiskLimits(const RiskManager::RiskLimits& limits) {
@@ -208,18 +1308,57 @@ std::unordered_map<std::string, double> OrderManager::getCurrentPositions() cons
     return riskManager->getCurrentPositions();
 }
 
+std::vector<OrderManager::PositionSnapshot> OrderManager::getPositions(const std::string& currency) const {
+    std::vector<PositionSnapshot> positions;
+    size_t count = std::min(InstrumentRegistry::instance().size(), InstrumentRegistry::MAX_INSTRUMENTS);
+    for (InstrumentId instrument = 0; instrument < count; ++instrument) {
+        PositionSnapshot position;
+        position.instrument = instrument;
+        if (!riskManager->getPosition(instrument, position.size, position.averagePrice) ||
+            std::abs(position.size) < POSITION_TOLERANCE) {
+            continue;
+        }
+        if (!currency.empty() && settlementCurrency(instrument) != currency) {
+            continue;
+        }
+        PnlEngine::InstrumentPnl pnl;
+        if (pnlEngine->getInstrumentPnl(instrument, pnl)) {
+            position.markPrice = pnl.markPrice;
+            position.realizedPnl = pnl.realized;
+            position.unrealizedPnl = pnl.unrealized;
+        }
+        positions.push_back(position);
+    }
+    return positions;
+}
+
 void OrderManager::onFill(const Order& order, double amount, double price) {
     auto start = std::chrono::high_resolution_clock::now(); // Start time
     try {
-        double signedAmount = order.side == "buy" ? amount : -amount;
-        riskManager->updatePosition(order.instrumentName, signedAmount, price);
+        double signedAmount = order.isBuy() ? amount : -amount;
+        bookFill(order.instrumentId, signedAmount, price);
 
-        {
+        // The fill feed's order updates carry the authoritative filled amount
+        if (!fillFeed) {
             std::lock_guard<std::mutex> lock(ordersMutex);
-            if (activeOrders.find(order.orderId) != activeOrders.end()) {
-                activeOrders[order.orderId].status = "filled";
-                activeOrders[order.orderId].filledAmount = amount;
-                activeOrders[order.orderId].averageFilledPrice = price;
+            OrderHandle handle = activeOrders.find(order.orderId.view());
+            if (handle != INVALID_ORDER_HANDLE) {
+                Order& tracked = orderPool.get(handle);
+                double previousOpen = openAmount(tracked);
+                double previousNotional = tracked.filledAmount * tracked.averageFilledPrice;
+                tracked.filledAmount += amount;
+                tracked.averageFilledPrice = (previousNotional + amount * price) / tracked.filledAmount;
+                tracked.status = tracked.remainingAmount() > 0 ? OrderStatus::PartiallyFilled : OrderStatus::Filled;
+                journalOrder(JournalEvent::Update, tracked);
+                reportToPriceWatch(handle, tracked.status == OrderStatus::Filled);
+
+                if (tracked.status == OrderStatus::Filled) {
+                    adjustExposure(tracked, -previousOpen);
+                    activeOrders.erase(handle);
+                    orderPool.release(handle);
+                } else {
+                    adjustExposure(tracked, openAmount(tracked) - previousOpen);
+                }
             }
         }
 
@@ -231,4 +1370,45 @@ void OrderManager::onFill(const Order& order, double amount, double price) {
     auto end = std::chrono::high_resolution_clock::now(); // End time
     std::chrono::duration<double, std::milli> latency = end - start;
     Logger::info("End-to-end trading loop latency: ", latency.count(), " ms");
-}
\ No newline at end of file
+}
+
+void OrderManager::onTrade(const FillFeed::Fill& fill) {
+    double signedAmount = fill.side == OrderSide::Buy ? fill.amount : -fill.amount;
+    bookFill(fill.instrumentId, signedAmount, fill.price);
+
+    std::chrono::duration<double, std::micro> latency = std::chrono::steady_clock::now() - fill.receivedAt;
+    Logger::info("Trade ", fill.tradeId, " for order ", fill.orderId, ": ", fill.amount, " @ ", fill.price,
+                 " booked in ", latency.count(), " us");
+}
+
+void OrderManager::onOrderUpdate(const Order& update) {
+    std::lock_guard<std::mutex> lock(ordersMutex);
+    OrderHandle handle = activeOrders.find(update.orderId.view());
+    if (handle == INVALID_ORDER_HANDLE) {
+        if (isTerminal(update.status)) {
+            finishedOrders.insert(update.orderId.view());
+        }
+        return;
+    }
+
+    Order& tracked = orderPool.get(handle);
+    double previousOpen = openAmount(tracked);
+    tracked.status = update.status;
+    tracked.amount = update.amount;
+    if (update.price > 0) {
+        tracked.price = update.price;
+    }
+    tracked.filledAmount = update.filledAmount;
+    tracked.averageFilledPrice = update.averageFilledPrice;
+    adjustExposure(tracked, openAmount(tracked) - previousOpen);
+    journalOrder(tracked.status == OrderStatus::Cancelled ? JournalEvent::Cancel
+                 : tracked.status == OrderStatus::Rejected ? JournalEvent::Reject
+                                                           : JournalEvent::Update, tracked);
+    reportToPriceWatch(handle, isTerminal(tracked.status));
+
+    if (isTerminal(tracked.status)) {
+        finishedOrders.insert(tracked.orderId.view());
+        activeOrders.erase(handle);
+        orderPool.release(handle);
+    }
+}
@@ -2,46 +2,264 @@
 #define ORDER_MANAGER_H
 
 #include "auth/AuthManager.h"
-#include "models/Order.h"
+#include "auth/utils/AsyncHttpClient.h"
+#include "models/order.h"
+#include "models/OrderPool.h"
+#include "models/OrderStore.h"
 #include "risk/RiskManager.h"
+#include "risk/RateLimiter.h"
+#include "risk/PnlEngine.h"
+#include "execution/ExecutionManager.h"
+#include "market/MarketDataIntegrator.h"
+#include "execution/FillFeed.h"
+#include "execution/ExecutionBackend.h"
+#include "../include/RecentIdSet.h"
+#include "OrderEncoder.h"
+#include "OrderJournal.h"
+#include "RequestDispatcher.h"
+#include <json/json.h>
 #include <string>
+#include <functional>
+#include <future>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 #include <mutex>
-#include <queue>
+#include <condition_variable>
+#include <atomic>
 #include <chrono>
 
 class OrderManager {
 public:
+    struct OrderResult {
+        bool success;
+        Order order;
+        std::string error;
+        int cancelledCount = 0;  // mass-cancel requests only
+    };
+    using OrderCallback = std::function<void(const OrderResult&)>;
+
+    enum class ModifyMode {
+        EditOnly,          // private/edit, fail if the exchange rejects it
+        EditWithFallback,  // private/edit, then cancel-and-replace if the edit fails
+        CancelReplace      // always cancel and place a new order
+    };
+
+    struct AsyncOptions {
+        size_t workerThreads = 8;  // for the execution backend's blocking calls
+        size_t maxInFlight = 64;
+        std::chrono::milliseconds defaultTimeout{5000};
+    };
+
+    struct RecoveryOptions {
+        OrderJournal::Options journal;
+        // Reconciled along with the currencies of everything the journal holds
+        std::vector<std::string> currencies{"BTC", "ETH"};
+        std::chrono::milliseconds timeout{5000};
+    };
+
     explicit OrderManager(AuthManager& authManager);
     OrderManager(AuthManager& authManager, MarketDataManager& marketDataManager);
+    ~OrderManager();
 
+    // Blocking wrappers around the async API
     bool placeOrder(Order& order);
     bool cancelOrder(const std::string& orderId);
-    bool modifyOrder(const std::string& orderId, Order& newOrder);
+    bool modifyOrder(const std::string& orderId, const Order& newOrder);
+    // Return the number of cancelled orders, or -1 on failure
+    int cancelAllByInstrument(const std::string& instrument);
+    int cancelByLabel(const std::string& label);
+
+    // Requests run as coroutines on the shared IoContext. The callback runs on
+    // its thread before the future becomes ready and must not block; waiting on
+    // the future is for other threads. A zero timeout uses
+    // AsyncOptions::defaultTimeout.
+    std::future<OrderResult> placeOrderAsync(const Order& order, OrderCallback callback = nullptr,
+                                             std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+    std::future<OrderResult> cancelOrderAsync(const std::string& orderId, OrderCallback callback = nullptr,
+                                              std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+    std::future<OrderResult> modifyOrderAsync(const std::string& orderId, const Order& newOrder,
+                                              OrderCallback callback = nullptr,
+                                              std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+    std::future<OrderResult> cancelAllByInstrumentAsync(const std::string& instrument, OrderCallback callback = nullptr,
+                                                        std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+    std::future<OrderResult> cancelByLabelAsync(const std::string& label, OrderCallback callback = nullptr,
+                                                std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+    // Every open order on the account, over REST
+    std::future<OrderResult> cancelAllAsync(OrderCallback callback = nullptr,
+                                            std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+
+    // Stops all new trading at once: places, edits and queued placements are
+    // rejected with RejectReason::Halted from here on, and private/cancel_all
+    // is written on the fill feed's open session. When the feed is down it
+    // goes over REST instead, past the in-flight limit and the rate limiter,
+    // and is retried with backoff until it succeeds or trading resumes.
+    // Returns false if already halted. Safe from any thread; nothing is
+    // logged before the cancel is handed off.
+    bool halt();
+    void resume();
+    bool isHalted() const { return halted.load(std::memory_order_relaxed); }
+
+    // Rebuilds open orders, positions and the day's PnL from the order
+    // journal, brings them in line with the exchange's open orders and
+    // positions, and journals every order event from then on. Call once,
+    // after setExecutionBackend and before trading starts. A journal from an
+    // earlier UTC day is first rewritten as a snapshot of what is still open.
+    // Returns false when the journal cannot be used; trading then goes on
+    // without one.
+    bool recover();
+    bool recover(const RecoveryOptions& options);
 
+    void setModifyMode(ModifyMode mode);
+
+    // Routes all order traffic, including triggered orders, through a simulated
+    // backend such as PaperExecutionBackend instead of the exchange, and stops
+    // the live fill feed. Call before trading starts; there is no way back to
+    // live trading on the same OrderManager.
+    void setExecutionBackend(std::shared_ptr<ExecutionBackend> backend);
+
+    // Must be called before orders are submitted; pending requests are drained first.
+    void setAsyncOptions(const AsyncOptions& options);
+    size_t getInFlightCount() const;
+
+    // Replaces the credit buckets shared with the risk checks. A later
+    // setRiskLimits call overrides the per-instrument rate with maxOrdersPerSecond.
+    void setRateLimits(const RateLimiter::Config& config);
     void setRiskLimits(const RiskManager::RiskLimits& limits);
     std::unordered_map<std::string, double> getCurrentPositions() const;
+    struct PositionSnapshot {
+        InstrumentId instrument = INVALID_INSTRUMENT;
+        double size = 0;  // positive when long
+        double averagePrice = 0;
+        double markPrice = 0;  // 0 until the instrument's book has a mid
+        double realizedPnl = 0;
+        double unrealizedPnl = 0;
+    };
+    // Open positions from the local risk and PnL state, without a request;
+    // an empty currency returns every settlement currency's
+    std::vector<PositionSnapshot> getPositions(const std::string& currency = std::string()) const;
+    // Copy a tracked open order, looked up by exchange order ID or by label.
+    // Orders placed without a label get a unique one from the OrderManager.
+    bool findOrder(std::string_view orderId, Order& order);
+    bool findOrderByLabel(std::string_view label, Order& order);
+    size_t getOpenOrderCount();
+    // Marked to market only when constructed with a MarketDataManager
+    PnlEngine& getPnlEngine() { return *pnlEngine; }
+    RiskManager& getRiskManager() { return *riskManager; }
 
 private:
+    static constexpr size_t ORDER_POOL_CAPACITY = 65536;
+
     AuthManager& authManager;
+    OrderPool orderPool;
+    std::unique_ptr<OrderJournal> journal;  // outlives the threads that append to it
+    std::atomic<bool> journaling{false};
+    RateLimiter rateLimiter;  // declared before riskManager, which holds a pointer to it
     std::unique_ptr<RiskManager> riskManager;
+    std::unique_ptr<PnlEngine> pnlEngine;
     std::unique_ptr<ExecutionManager> executionManager;
     std::unique_ptr<MarketDataIntegrator> marketDataIntegrator;
+    std::unique_ptr<FillFeed> fillFeed;  // null in the REST-only constructor
+    std::shared_ptr<ExecutionBackend> executionBackend;  // null when trading live
 
-    const std::string baseUrl = "https://test.deribit.com/api/v2/";
+    AsyncOptions asyncOptions;
+    std::atomic<ModifyMode> modifyMode{ModifyMode::EditWithFallback};
+    std::atomic<bool> halted{false};
+    std::atomic<bool> stopping{false};
+    static constexpr std::chrono::milliseconds HALT_CANCEL_INITIAL_RETRY{100};
+    static constexpr std::chrono::milliseconds HALT_CANCEL_MAX_RETRY{1000};
+    std::unique_ptr<RequestDispatcher> requestDispatcher;
+    std::atomic<size_t> requestsInFlight{0};
+    std::mutex drainMutex;
+    std::condition_variable drainCV;
 
-    std::unordered_map<std::string, Order> activeOrders;
+    // Keep-alive connections shared by every REST call this manager makes
+    AsyncHttpClient restClient{"https://test.deribit.com"};
+    const std::string apiPath = "/api/v2/";
+
+    OrderEncoder orderEncoder;
+    std::atomic<uint64_t> nextRequestId{1};
+    // Client labels are the session's start time and a counter, so they stay
+    // unique across restarts
+    const int64_t sessionStartMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::atomic<uint64_t> nextClientOrder{1};
+
+    // Tracked orders by exchange order ID and label; terminal ones are
+    // evicted to the journal, so the store stays within the pool's capacity
+    OrderStore activeOrders{orderPool};
     std::mutex ordersMutex;
+    // Recently finished orders, including ones the feed reported terminal
+    // before they were tracked, so late reports cannot revive them; guarded
+    // by ordersMutex
+    RecentIdSet finishedOrders{4096};
+
+    using RequestFn = std::function<boost::asio::awaitable<bool>(OrderResult&, long timeoutMs)>;
+    std::future<OrderResult> dispatch(RequestFn request, OrderResult initial, OrderCallback callback,
+                                      std::chrono::milliseconds timeout);
+    boost::asio::awaitable<void> runRequest(RequestFn request, std::shared_ptr<OrderResult> result,
+                                            std::function<void(OrderResult&)> complete,
+                                            RequestDispatcher::Clock::time_point deadline);
+    void finishRequest();
+    // Milliseconds left before deadline; zero or less once it has passed
+    static long remainingMs(RequestDispatcher::Clock::time_point deadline);
+    // Waits until no request is in flight
+    void drainRequests();
+    boost::asio::awaitable<void> haltCancelAll();
+    // Runs a blocking call on a dispatcher thread and resumes on the I/O thread
+    boost::asio::awaitable<void> runBlocking(std::function<void()> work);
+    // Refreshes the token off the I/O thread when it has expired
+    boost::asio::awaitable<bool> ensureValidToken();
 
-    std::queue<std::chrono::system_clock::time_point> requestTimes;
-    std::mutex rateLimitMutex;
-    static constexpr int MAX_REQUESTS_PER_SECOND = 10;
+    boost::asio::awaitable<bool> sendPlaceOrder(Order& order, long timeoutMs, std::string& error);
+    boost::asio::awaitable<bool> postPlaceOrder(Order& order, long timeoutMs, std::string& error);
+    boost::asio::awaitable<bool> sendCancelOrder(std::string_view orderId, long timeoutMs, std::string& error);
+    boost::asio::awaitable<bool> sendEditOrder(const std::string& orderId, Order& order, long timeoutMs,
+                                               std::string& error);
+    boost::asio::awaitable<bool> sendCancelReplace(const std::string& orderId, Order& order, long timeoutMs,
+                                                   std::string& error);
+    boost::asio::awaitable<bool> sendPrivateRequest(const std::string& method, const Json::Value& params,
+                                                    long timeoutMs, Json::Value& result, std::string& error);
+    // Without the rate limit check
+    boost::asio::awaitable<bool> postPrivateRequest(const std::string& method, const Json::Value& params,
+                                                    long timeoutMs, Json::Value& result, std::string& error);
 
-    std::string postRequest(const std::string& endpoint, const std::string& payload);
-    bool checkRateLimit();
-    void updateOrderStatus(Order& order, const Json::Value& response);
+    boost::asio::awaitable<std::string> postRequest(const char* endpoint, const char* payload, size_t length,
+                                                    long timeoutMs = 0);
+    // Spends the credits, waiting on a timer when pacing
+    boost::asio::awaitable<bool> checkRateLimit(InstrumentId instrument);
+    void assignClientLabel(Order& order);
+    InstrumentId trackedInstrument(std::string_view orderId);
+    void updateOrderStatus(Order& order, const Json::Value& response, std::string& error);
+    // Tracked orders hold their open remainder as exposure in the risk manager.
+    // reserved is what the caller already holds for the order; the difference
+    // is settled here, including when the order ends up untracked.
+    void trackOrder(const Order& order, double reserved);
+    void journalOrder(JournalEvent event, const Order& order);
+    void untrackOrder(std::string_view orderId);
+    static double openAmount(const Order& order);
+    void adjustExposure(const Order& order, double delta);
+    // Frees a tracked order and its exposure; call with ordersMutex held
+    void releaseTracked(OrderHandle handle);
+    // Passes a pooled order's fills to the price watch for its bracket exits;
+    // final before the slot is released
+    void reportToPriceWatch(OrderHandle handle, bool final);
+    int cancelTrackedWithBackend(const std::function<bool(const Order&)>& predicate);
+    void untrackOrdersIf(const std::function<bool(const Order&)>& predicate);
+    // Books a fill into positions and PnL; signedAmount is positive for buys
+    void bookFill(InstrumentId instrument, double signedAmount, double price);
+    // Replays journal records into positions and the returned open orders
+    std::unordered_map<std::string, Order> replayJournal(size_t& replayed);
+    // Open orders and positions as a journal to start a new day from
+    std::vector<JournalRecord> snapshotState();
+    boost::asio::awaitable<void> reconcileWithExchange(std::vector<std::string> currencies, long timeoutMs);
+    void reconcilePosition(InstrumentId instrument, double exchangeSize, double exchangeAveragePrice);
+    void onExecutionReport(OrderHandle handle);
+    // Fills generated by the execution backend itself
     void onFill(const Order& order, double amount, double price);
+    // Exchange-reported trades and order state from the fill feed
+    void onTrade(const FillFeed::Fill& fill);
+    void onOrderUpdate(const Order& update);
 };
 
 #endif
\ No newline at end of file
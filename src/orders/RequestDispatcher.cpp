@@ -0,0 +1,79 @@
+#include "RequestDispatcher.h"
+#include "../include/Logger.h"
+
+RequestDispatcher::RequestDispatcher(size_t workerThreads, size_t maxInFlight)
+    : maxInFlight(maxInFlight), inFlightCount(0), running(true) {
+    if (workerThreads == 0) {
+        workerThreads = 1;
+    }
+    workers.reserve(workerThreads);
+    for (size_t i = 0; i < workerThreads; ++i) {
+        workers.emplace_back(&RequestDispatcher::workerLoop, this);
+    }
+}
+
+RequestDispatcher::~RequestDispatcher() {
+    stop();
+}
+
+bool RequestDispatcher::submit(Task task, Clock::time_point deadline) {
+    size_t current = inFlightCount.load(std::memory_order_relaxed);
+    do {
+        if (current >= maxInFlight) {
+            return false;
+        }
+    } while (!inFlightCount.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel));
+
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        if (!running) {
+            inFlightCount.fetch_sub(1, std::memory_order_acq_rel);
+            return false;
+        }
+        pending.push_back({std::move(task), deadline});
+    }
+    pendingCV.notify_one();
+    return true;
+}
+
+void RequestDispatcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        if (!running) {
+            return;
+        }
+        running = false;
+    }
+    pendingCV.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers.clear();
+}
+
+void RequestDispatcher::workerLoop() {
+    while (true) {
+        PendingRequest request;
+        {
+            std::unique_lock<std::mutex> lock(pendingMutex);
+            pendingCV.wait(lock, [this]() {
+                return !pending.empty() || !running;
+            });
+
+            // Drain whatever was accepted before stop() so no caller is left waiting.
+            if (pending.empty()) break;
+
+            request = std::move(pending.front());
+            pending.pop_front();
+        }
+
+        try {
+            request.task(request.deadline);
+        } catch (const std::exception& e) {
+            Logger::error("Unhandled error in dispatched request: ", e.what());
+        }
+        inFlightCount.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
@@ -0,0 +1,50 @@
+// orders/RequestDispatcher.h
+#ifndef REQUEST_DISPATCHER_H
+#define REQUEST_DISPATCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs blocking calls, such as the simulated execution backend and token
+// refreshes, on a fixed pool of worker threads so they never hold up the I/O
+// thread that order requests run on.
+class RequestDispatcher {
+public:
+    using Clock = std::chrono::steady_clock;
+    // Receives the request deadline; the task is responsible for honouring it.
+    using Task = std::function<void(Clock::time_point deadline)>;
+
+    RequestDispatcher(size_t workerThreads, size_t maxInFlight);
+    ~RequestDispatcher();
+
+    // Returns false without queueing when maxInFlight requests are already pending.
+    bool submit(Task task, Clock::time_point deadline);
+    void stop();
+
+    size_t inFlight() const { return inFlightCount.load(std::memory_order_relaxed); }
+    size_t capacity() const { return maxInFlight; }
+
+private:
+    struct PendingRequest {
+        Task task;
+        Clock::time_point deadline;
+    };
+
+    const size_t maxInFlight;
+    std::atomic<size_t> inFlightCount;
+    std::atomic<bool> running;
+    std::deque<PendingRequest> pending;
+    std::mutex pendingMutex;
+    std::condition_variable pendingCV;
+    std::vector<std::thread> workers;
+
+    void workerLoop();
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include "OrderPool.h"
+
+namespace {
+
+constexpr uint64_t pack(uint32_t tag, OrderHandle index) {
+    return (static_cast<uint64_t>(tag) << 32) | index;
+}
+
+constexpr OrderHandle indexOf(uint64_t head) {
+    return static_cast<OrderHandle>(head & 0xFFFFFFFFu);
+}
+
+constexpr uint32_t tagOf(uint64_t head) {
+    return static_cast<uint32_t>(head >> 32);
+}
+
+} // namespace
+
+OrderPool::OrderPool(size_t capacity)
+    : poolCapacity(capacity < INVALID_ORDER_HANDLE ? capacity : INVALID_ORDER_HANDLE - 1),
+      orders(std::make_unique<Order[]>(poolCapacity)),
+      nextFree(std::make_unique<std::atomic<OrderHandle>[]>(poolCapacity)),
+      freeHead(pack(0, poolCapacity > 0 ? 0 : INVALID_ORDER_HANDLE)),
+      freeCount(poolCapacity) {
+    for (size_t i = 0; i < poolCapacity; ++i) {
+        OrderHandle next = i + 1 < poolCapacity ? static_cast<OrderHandle>(i + 1) : INVALID_ORDER_HANDLE;
+        nextFree[i].store(next, std::memory_order_relaxed);
+    }
+}
+
+OrderHandle OrderPool::acquire() {
+    uint64_t head = freeHead.load(std::memory_order_acquire);
+    while (true) {
+        OrderHandle index = indexOf(head);
+        if (index == INVALID_ORDER_HANDLE) {
+            return INVALID_ORDER_HANDLE;
+        }
+        OrderHandle next = nextFree[index].load(std::memory_order_relaxed);
+        if (freeHead.compare_exchange_weak(head, pack(tagOf(head) + 1, next),
+                                           std::memory_order_acq_rel, std::memory_order_acquire)) {
+            freeCount.fetch_sub(1, std::memory_order_relaxed);
+            orders[index] = Order{};
+            return index;
+        }
+    }
+}
+
+OrderHandle OrderPool::acquire(const Order& order) {
+    OrderHandle handle = acquire();
+    if (handle != INVALID_ORDER_HANDLE) {
+        orders[handle] = order;
+    }
+    return handle;
+}
+
+void OrderPool::release(OrderHandle handle) {
+    if (handle >= poolCapacity) {
+        return;
+    }
+    uint64_t head = freeHead.load(std::memory_order_relaxed);
+    do {
+        nextFree[handle].store(indexOf(head), std::memory_order_relaxed);
+    } while (!freeHead.compare_exchange_weak(head, pack(tagOf(head) + 1, handle),
+                                             std::memory_order_release, std::memory_order_relaxed));
+    freeCount.fetch_add(1, std::memory_order_relaxed);
+}
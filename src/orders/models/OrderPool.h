@@ -0,0 +1,43 @@
+#ifndef ORDER_POOL_H
+#define ORDER_POOL_H
+
+#include "order.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+using OrderHandle = uint32_t;
+constexpr OrderHandle INVALID_ORDER_HANDLE = UINT32_MAX;
+
+// Fixed-capacity slab of Order records handed out by index. acquire() and
+// release() are lock-free (tagged Treiber stack), so any thread can allocate
+// or free orders without touching the heap after construction.
+class OrderPool {
+public:
+    explicit OrderPool(size_t capacity);
+
+    OrderPool(const OrderPool&) = delete;
+    OrderPool& operator=(const OrderPool&) = delete;
+
+    // Returns INVALID_ORDER_HANDLE when the pool is exhausted. The slot is reset
+    // to a default-constructed Order.
+    OrderHandle acquire();
+    OrderHandle acquire(const Order& order);
+    void release(OrderHandle handle);
+
+    Order& get(OrderHandle handle) { return orders[handle]; }
+    const Order& get(OrderHandle handle) const { return orders[handle]; }
+
+    size_t capacity() const { return poolCapacity; }
+    size_t available() const { return freeCount.load(std::memory_order_relaxed); }
+
+private:
+    const size_t poolCapacity;
+    std::unique_ptr<Order[]> orders;
+    std::unique_ptr<std::atomic<OrderHandle>[]> nextFree;
+    // Upper 32 bits: ABA tag, lower 32 bits: head index
+    std::atomic<uint64_t> freeHead;
+    std::atomic<size_t> freeCount;
+};
+
+#endif
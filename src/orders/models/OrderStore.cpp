@@ -0,0 +1,193 @@
+#include "OrderStore.h"
+#include <functional>
+
+namespace {
+
+std::string_view idOf(const Order& order) {
+    return order.orderId.view();
+}
+
+std::string_view labelOf(const Order& order) {
+    return order.label.view();
+}
+
+// At most half full, so probe sequences stay short
+size_t tableSize(size_t capacity) {
+    size_t size = 2;
+    while (size < 2 * capacity) {
+        size <<= 1;
+    }
+    return size;
+}
+
+} // namespace
+
+OrderStore::OrderStore(OrderPool& pool)
+    : pool(pool),
+      mask(tableSize(pool.capacity()) - 1),
+      byId(std::make_unique<Slot[]>(mask + 1)),
+      byLabel(std::make_unique<Slot[]>(mask + 1)),
+      handles(std::make_unique<OrderHandle[]>(pool.capacity())),
+      positions(std::make_unique<uint32_t[]>(pool.capacity())) {
+    for (size_t i = 0; i <= mask; ++i) {
+        byId[i] = Slot{0, INVALID_ORDER_HANDLE};
+        byLabel[i] = Slot{0, INVALID_ORDER_HANDLE};
+    }
+    for (size_t i = 0; i < pool.capacity(); ++i) {
+        positions[i] = NOT_STORED;
+    }
+}
+
+uint32_t OrderStore::hashOf(std::string_view key) {
+    size_t hash = std::hash<std::string_view>{}(key);
+    return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+template <typename KeyOf>
+size_t OrderStore::probe(const Slot* table, std::string_view key, uint32_t hash, KeyOf keyOf) const {
+    size_t index = hash & mask;
+    // The stored hash settles almost every mismatch without touching the order
+    while (table[index].handle != INVALID_ORDER_HANDLE &&
+           (table[index].hash != hash || keyOf(pool.get(table[index].handle)) != key)) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+bool OrderStore::insert(OrderHandle handle) {
+    if (handle >= pool.capacity() || positions[handle] != NOT_STORED) {
+        return false;
+    }
+    const Order& order = pool.get(handle);
+    std::string_view orderId = order.orderId.view();
+    if (orderId.empty()) {
+        return false;
+    }
+    uint32_t hash = hashOf(orderId);
+    size_t slot = probe(byId.get(), orderId, hash, idOf);
+    if (byId[slot].handle != INVALID_ORDER_HANDLE) {
+        return false;
+    }
+    byId[slot] = Slot{hash, handle};
+
+    std::string_view label = order.label.view();
+    if (!label.empty()) {
+        uint32_t labelHash = hashOf(label);
+        size_t labelSlot = probe(byLabel.get(), label, labelHash, labelOf);
+        if (byLabel[labelSlot].handle == INVALID_ORDER_HANDLE) {
+            byLabel[labelSlot] = Slot{labelHash, handle};
+        }
+    }
+
+    positions[handle] = static_cast<uint32_t>(count);
+    handles[count++] = handle;
+    return true;
+}
+
+bool OrderStore::update(OrderHandle handle, const Order& order) {
+    Order& stored = pool.get(handle);
+    if (!contains(handle) || (stored.orderId == order.orderId && stored.label == order.label)) {
+        stored = order;
+        return true;
+    }
+
+    // Every probe runs before any slot changes, since probes read keys from the
+    // pooled order, which still holds the old ones
+    std::string_view orderId = order.orderId.view();
+    if (orderId.empty()) {
+        return false;
+    }
+    uint32_t hash = hashOf(orderId);
+    size_t slot = probe(byId.get(), orderId, hash, idOf);
+    if (byId[slot].handle != INVALID_ORDER_HANDLE && byId[slot].handle != handle) {
+        return false;
+    }
+    bool rekeyId = byId[slot].handle == INVALID_ORDER_HANDLE;
+    size_t oldSlot = probe(byId.get(), stored.orderId.view(), hashOf(stored.orderId.view()), idOf);
+
+    std::string_view label = order.label.view();
+    uint32_t labelHash = label.empty() ? 0 : hashOf(label);
+    size_t labelSlot = label.empty() ? 0 : probe(byLabel.get(), label, labelHash, labelOf);
+    bool indexLabel = !label.empty() && byLabel[labelSlot].handle == INVALID_ORDER_HANDLE;
+    size_t oldLabelSlot = 0;
+    bool unindexLabel = false;
+    if (stored.label != order.label && !stored.label.empty()) {
+        oldLabelSlot = probe(byLabel.get(), stored.label.view(), hashOf(stored.label.view()), labelOf);
+        unindexLabel = byLabel[oldLabelSlot].handle == handle;
+    }
+
+    // The new key goes in before the old one comes out. Inserting only fills
+    // an empty slot, so the old slot's index stays valid for removeAt.
+    if (rekeyId) {
+        byId[slot] = Slot{hash, handle};
+        removeAt(byId.get(), oldSlot);
+    }
+    if (indexLabel) {
+        byLabel[labelSlot] = Slot{labelHash, handle};
+    }
+    if (unindexLabel) {
+        removeAt(byLabel.get(), oldLabelSlot);
+    }
+    stored = order;
+    return true;
+}
+
+void OrderStore::erase(OrderHandle handle) {
+    if (!contains(handle)) {
+        return;
+    }
+    unindex(handle);
+
+    uint32_t position = positions[handle];
+    OrderHandle last = handles[--count];
+    handles[position] = last;
+    positions[last] = position;
+    positions[handle] = NOT_STORED;
+}
+
+OrderHandle OrderStore::find(std::string_view orderId) const {
+    if (orderId.empty()) {
+        return INVALID_ORDER_HANDLE;
+    }
+    return byId[probe(byId.get(), orderId, hashOf(orderId), idOf)].handle;
+}
+
+OrderHandle OrderStore::findByLabel(std::string_view label) const {
+    if (label.empty()) {
+        return INVALID_ORDER_HANDLE;
+    }
+    return byLabel[probe(byLabel.get(), label, hashOf(label), labelOf)].handle;
+}
+
+void OrderStore::unindex(OrderHandle handle) {
+    const Order& order = pool.get(handle);
+    size_t slot = probe(byId.get(), order.orderId.view(), hashOf(order.orderId.view()), idOf);
+    if (byId[slot].handle == handle) {
+        removeAt(byId.get(), slot);
+    }
+    if (!order.label.empty()) {
+        // The label may be indexed under another order that had it first
+        slot = probe(byLabel.get(), order.label.view(), hashOf(order.label.view()), labelOf);
+        if (byLabel[slot].handle == handle) {
+            removeAt(byLabel.get(), slot);
+        }
+    }
+}
+
+void OrderStore::removeAt(Slot* table, size_t index) {
+    // Pulls back every later entry of the cluster that may live in the hole,
+    // so lookups never need tombstones
+    size_t next = index;
+    while (true) {
+        next = (next + 1) & mask;
+        if (table[next].handle == INVALID_ORDER_HANDLE) {
+            break;
+        }
+        size_t home = table[next].hash & mask;
+        if (((next - home) & mask) >= ((next - index) & mask)) {
+            table[index] = table[next];
+            index = next;
+        }
+    }
+    table[index].handle = INVALID_ORDER_HANDLE;
+}
@@ -0,0 +1,67 @@
+#ifndef ORDER_STORE_H
+#define ORDER_STORE_H
+
+#include "OrderPool.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+// The open orders held in an OrderPool, indexed by exchange order ID and by
+// label. Both indices are open-addressing tables sized once from the pool's
+// capacity, with linear probing and backward-shift deletion, so a full day
+// of placing and cancelling neither allocates nor leaves tombstones behind.
+// Keys are read from the pooled orders themselves: an order's ID and label
+// must not change while it is stored, use update() for that. Not
+// thread-safe.
+class OrderStore {
+public:
+    explicit OrderStore(OrderPool& pool);
+
+    OrderStore(const OrderStore&) = delete;
+    OrderStore& operator=(const OrderStore&) = delete;
+
+    // Returns false if the order has no ID or one that is already stored. The
+    // label is indexed unless it is empty or another stored order has it.
+    bool insert(OrderHandle handle);
+    // Replaces the pooled order and re-indexes it. Returns false, leaving the
+    // stored order untouched, if the new ID is empty or held by another order.
+    bool update(OrderHandle handle, const Order& order);
+    // Drops the order from both indices; the handle stays acquired
+    void erase(OrderHandle handle);
+
+    // Both return INVALID_ORDER_HANDLE when nothing matches
+    OrderHandle find(std::string_view orderId) const;
+    OrderHandle findByLabel(std::string_view label) const;
+    bool contains(OrderHandle handle) const { return handle < pool.capacity() && positions[handle] != NOT_STORED; }
+
+    // Stored orders in no particular order. Erasing the one at i moves the
+    // last into its place, so walk backwards to erase while iterating.
+    size_t size() const { return count; }
+    OrderHandle at(size_t i) const { return handles[i]; }
+
+private:
+    static constexpr uint32_t NOT_STORED = UINT32_MAX;
+
+    struct Slot {
+        uint32_t hash;
+        OrderHandle handle;  // INVALID_ORDER_HANDLE when empty
+    };
+
+    OrderPool& pool;
+    size_t mask;
+    std::unique_ptr<Slot[]> byId;
+    std::unique_ptr<Slot[]> byLabel;
+    std::unique_ptr<OrderHandle[]> handles;
+    std::unique_ptr<uint32_t[]> positions;  // index into handles, by handle
+    size_t count = 0;
+
+    static uint32_t hashOf(std::string_view key);
+    // The slot holding key, or the empty slot that ends its probe sequence
+    template <typename KeyOf>
+    size_t probe(const Slot* table, std::string_view key, uint32_t hash, KeyOf keyOf) const;
+    void removeAt(Slot* table, size_t index);
+    void unindex(OrderHandle handle);
+};
+
+#endif
@@ -1,21 +1,142 @@
 #ifndef ORDER_H
 #define ORDER_H
 
+#include "../../market/InstrumentRegistry.h"
+#include "../../../include/FixedString.h"
 #include <string>
+#include <string_view>
 #include <chrono>
+#include <cstdint>
 
-struct Order {
-    std::string orderId;
-    std::string instrumentName;
-    std::string side;
-    double amount;
-    double price;
-    std::string type;
-    std::string status;
-    double filledAmount;
-    double averageFilledPrice;
+enum class OrderSide : uint8_t { Buy, Sell };
+
+enum class OrderType : uint8_t { Market, Limit };
+
+enum class OrderStatus : uint8_t {
+    New,
+    Open,
+    PartiallyFilled,
+    Filled,
+    Cancelled,
+    Rejected,
+    Untriggered,
+    Failed
+};
+
+enum class RejectReason : uint8_t {
+    None,
+    RateLimit,
+    RiskCheck,
+    Authentication,
+    InvalidResponse,
+    Encoding,
+    Exchange,
+    Timeout,
+    InFlightLimit,
+    PoolExhausted,
+    Halted,
+    InvalidLabel
+};
+
+// Deribit's limit for order labels
+constexpr size_t MAX_LABEL_LENGTH = 64;
+
+// Three cache lines, no heap members: orders can be copied and pooled freely
+struct alignas(64) Order {
+    FixedString<32> orderId;  // exchange order ID
+    // Client-side tag sent as the Deribit label. One character beyond the
+    // limit is kept, so an over-long label is caught instead of truncated.
+    FixedString<MAX_LABEL_LENGTH + 2> label;
+    double amount = 0;
+    double price = 0;
+    double filledAmount = 0;
+    double averageFilledPrice = 0;
     std::chrono::system_clock::time_point timestamp;
-    std::string rejectionReason;
+    InstrumentId instrumentId = INVALID_INSTRUMENT;
+    OrderSide side = OrderSide::Buy;
+    OrderType type = OrderType::Limit;
+    OrderStatus status = OrderStatus::New;
+    RejectReason rejectionReason = RejectReason::None;
+
+    const InstrumentRegistry::Name& instrumentName() const {
+        return InstrumentRegistry::instance().name(instrumentId);
+    }
+    bool isBuy() const { return side == OrderSide::Buy; }
+    double remainingAmount() const { return amount - filledAmount; }
 };
 
-#endif
\ No newline at end of file
+static_assert(sizeof(Order) == 192, "Order should span exactly three cache lines");
+
+inline bool isValidLabel(std::string_view label) {
+    return label.size() <= MAX_LABEL_LENGTH;
+}
+
+inline const char* toString(OrderSide side) {
+    return side == OrderSide::Buy ? "buy" : "sell";
+}
+
+inline const char* toString(OrderType type) {
+    return type == OrderType::Market ? "market" : "limit";
+}
+
+inline const char* toString(OrderStatus status) {
+    switch (status) {
+        case OrderStatus::New: return "new";
+        case OrderStatus::Open: return "open";
+        case OrderStatus::PartiallyFilled: return "partially_filled";
+        case OrderStatus::Filled: return "filled";
+        case OrderStatus::Cancelled: return "cancelled";
+        case OrderStatus::Rejected: return "rejected";
+        case OrderStatus::Untriggered: return "untriggered";
+        case OrderStatus::Failed: return "failed";
+        default: return "unknown";
+    }
+}
+
+inline const char* toString(RejectReason reason) {
+    switch (reason) {
+        case RejectReason::None: return "None";
+        case RejectReason::RateLimit: return "Rate limit exceeded";
+        case RejectReason::RiskCheck: return "Failed risk validation";
+        case RejectReason::Authentication: return "Authentication failed";
+        case RejectReason::InvalidResponse: return "Invalid response";
+        case RejectReason::Encoding: return "Encoding failed";
+        case RejectReason::Exchange: return "Rejected by exchange";
+        case RejectReason::Timeout: return "Request timed out";
+        case RejectReason::InFlightLimit: return "In-flight limit reached";
+        case RejectReason::PoolExhausted: return "Order pool exhausted";
+        case RejectReason::Halted: return "Trading halted";
+        case RejectReason::InvalidLabel: return "Label longer than 64 characters";
+        default: return "Unknown";
+    }
+}
+
+// Parsers return false and leave the output untouched on unknown input
+inline bool parseOrderSide(std::string_view text, OrderSide& side) {
+    if (text == "buy") { side = OrderSide::Buy; return true; }
+    if (text == "sell") { side = OrderSide::Sell; return true; }
+    return false;
+}
+
+inline bool parseOrderType(std::string_view text, OrderType& type) {
+    if (text == "market") { type = OrderType::Market; return true; }
+    if (text == "limit") { type = OrderType::Limit; return true; }
+    return false;
+}
+
+inline bool parseOrderStatus(std::string_view text, OrderStatus& status) {
+    if (text == "open") { status = OrderStatus::Open; return true; }
+    if (text == "filled") { status = OrderStatus::Filled; return true; }
+    if (text == "partially_filled") { status = OrderStatus::PartiallyFilled; return true; }
+    if (text == "cancelled") { status = OrderStatus::Cancelled; return true; }
+    if (text == "rejected") { status = OrderStatus::Rejected; return true; }
+    if (text == "untriggered") { status = OrderStatus::Untriggered; return true; }
+    return false;
+}
+
+inline bool isTerminal(OrderStatus status) {
+    return status == OrderStatus::Filled || status == OrderStatus::Cancelled ||
+           status == OrderStatus::Rejected || status == OrderStatus::Failed;
+}
+
+#endif
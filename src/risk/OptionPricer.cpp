@@ -0,0 +1,327 @@
+#include "OptionPricer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+size_t OptionChain::add(InstrumentId instrument, double optionStrike, double optionTimeToExpiry, bool isCall) {
+    instruments.push_back(instrument);
+    forward.push_back(0);
+    strike.push_back(optionStrike);
+    timeToExpiry.push_back(optionTimeToExpiry);
+    volatility.push_back(0);
+    rate.push_back(0);
+    callPut.push_back(isCall ? 1.0 : -1.0);
+    price.push_back(0);
+    delta.push_back(0);
+    gamma.push_back(0);
+    vega.push_back(0);
+    theta.push_back(0);
+    return instruments.size() - 1;
+}
+
+namespace {
+
+constexpr double INV_SQRT_2PI = 0.3989422804014327;
+
+struct ChainView {
+    const double* forward;
+    const double* strike;
+    const double* timeToExpiry;
+    const double* volatility;
+    const double* rate;
+    const double* callPut;
+    double* price;
+    double* delta;
+    double* gamma;
+    double* vega;
+    double* theta;
+};
+
+ChainView viewOf(OptionChain& chain) {
+    return {chain.forward.data(), chain.strike.data(), chain.timeToExpiry.data(), chain.volatility.data(),
+            chain.rate.data(), chain.callPut.data(), chain.price.data(), chain.delta.data(), chain.gamma.data(),
+            chain.vega.data(), chain.theta.data()};
+}
+
+double normalCdf(double x) {
+    return 0.5 * std::erfc(-x * M_SQRT1_2);
+}
+
+void priceScalar(const ChainView& chain, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        double forward = chain.forward[i];
+        double strike = chain.strike[i];
+        double timeToExpiry = chain.timeToExpiry[i];
+        double volatility = chain.volatility[i];
+        double rate = chain.rate[i];
+        double callPut = chain.callPut[i];
+        double discount = std::exp(-rate * timeToExpiry);
+
+        // Expired or degenerate inputs: intrinsic value, no curvature
+        if (timeToExpiry <= 0 || volatility <= 0 || forward <= 0 || strike <= 0) {
+            double intrinsic = callPut * (forward - strike);
+            chain.price[i] = intrinsic > 0 ? discount * intrinsic : 0;
+            chain.delta[i] = intrinsic > 0 ? callPut * discount : 0;
+            chain.gamma[i] = 0;
+            chain.vega[i] = 0;
+            chain.theta[i] = 0;
+            continue;
+        }
+
+        double sqrtT = std::sqrt(timeToExpiry);
+        double sigmaSqrtT = volatility * sqrtT;
+        double d1 = (std::log(forward / strike) + 0.5 * volatility * volatility * timeToExpiry) / sigmaSqrtT;
+        double d2 = d1 - sigmaSqrtT;
+        double pdf1 = std::exp(-0.5 * d1 * d1) * INV_SQRT_2PI;
+        double nd1 = normalCdf(d1);
+        double call = discount * (forward * nd1 - strike * normalCdf(d2));
+
+        double price = callPut > 0 ? call : call - discount * (forward - strike);
+        chain.price[i] = price;
+        chain.delta[i] = discount * (callPut > 0 ? nd1 : nd1 - 1.0);
+        chain.gamma[i] = discount * pdf1 / (forward * sigmaSqrtT);
+        chain.vega[i] = discount * forward * pdf1 * sqrtT;
+        chain.theta[i] = rate * price - discount * forward * pdf1 * volatility / (2.0 * sqrtT);
+    }
+}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define OPTION_PRICER_SIMD 1
+
+// The kernel is written once on GCC vector types and force-inlined into the
+// target-specific entry points below, which compile it for AVX2 or AVX-512.
+// Its math avoids libm and intrinsics so the generic code needs no target.
+// Vector arguments never cross a non-inlined call, so the ABI notes do not apply.
+#pragma GCC diagnostic ignored "-Wpsabi"
+#define KERNEL_INLINE inline __attribute__((always_inline))
+
+typedef double Double4 __attribute__((vector_size(32)));
+typedef int64_t Int4 __attribute__((vector_size(32)));
+typedef double Double8 __attribute__((vector_size(64)));
+typedef int64_t Int8 __attribute__((vector_size(64)));
+
+template <typename V>
+KERNEL_INLINE V splat(double value) {
+    return V{} + value;
+}
+
+template <typename V>
+KERNEL_INLINE V load(const double* source) {
+    V value;
+    std::memcpy(&value, source, sizeof(V));
+    return value;
+}
+
+template <typename V>
+KERNEL_INLINE void store(double* target, V value) {
+    std::memcpy(target, &value, sizeof(V));
+}
+
+// e^x to about 1 ulp: x = n ln2 + r with |r| <= ln2 / 2, a degree 11 Taylor
+// polynomial for e^r, and 2^n built directly in the exponent bits
+template <typename V, typename I>
+KERNEL_INLINE V expApprox(V x) {
+    x = x < splat<V>(-708.0) ? splat<V>(-708.0) : x;
+    x = x > splat<V>(708.0) ? splat<V>(708.0) : x;
+    const V roundMagic = splat<V>(6755399441055744.0);  // 1.5 * 2^52: adding it rounds to an integer
+    V shifted = x * 1.4426950408889634 + roundMagic;
+    V n = shifted - roundMagic;
+    V r = x - n * 6.93147180369123816490e-01;
+    r = r - n * 1.90821492927058770002e-10;
+
+    V p = splat<V>(1.0 / 39916800.0);
+    p = p * r + 1.0 / 3628800.0;
+    p = p * r + 1.0 / 362880.0;
+    p = p * r + 1.0 / 40320.0;
+    p = p * r + 1.0 / 5040.0;
+    p = p * r + 1.0 / 720.0;
+    p = p * r + 1.0 / 120.0;
+    p = p * r + 1.0 / 24.0;
+    p = p * r + 1.0 / 6.0;
+    p = p * r + 0.5;
+    p = p * r + 1.0;
+    p = p * r + 1.0;
+
+    I exponent = (I)shifted - (I)roundMagic;
+    return p * (V)((exponent + 1023) << 52);
+}
+
+// ln x for positive normal x: x = 2^e m with m in [sqrt(1/2), sqrt(2)), and
+// ln m = 2 atanh((m - 1) / (m + 1)) as an odd series
+template <typename V, typename I>
+KERNEL_INLINE V logApprox(V x) {
+    I bits = (I)x;
+    I exponent = (bits >> 52) - 1023;
+    V m = (V)((bits & 0x000FFFFFFFFFFFFFLL) | 0x3FF0000000000000LL);
+    auto large = m > splat<V>(1.4142135623730951);
+    m = large ? m * 0.5 : m;
+    exponent = large ? exponent + 1 : exponent;
+    // Exact int64 to double for small values: place them in a 2^52 mantissa
+    V e = (V)((exponent + 1024) + 0x4330000000000000LL) - (4503599627370496.0 + 1024.0);
+
+    V s = (m - 1.0) / (m + 1.0);
+    V s2 = s * s;
+    V series = splat<V>(1.0 / 17.0);
+    series = series * s2 + 1.0 / 15.0;
+    series = series * s2 + 1.0 / 13.0;
+    series = series * s2 + 1.0 / 11.0;
+    series = series * s2 + 1.0 / 9.0;
+    series = series * s2 + 1.0 / 7.0;
+    series = series * s2 + 1.0 / 5.0;
+    series = series * s2 + 1.0 / 3.0;
+    series = series * s2 + 1.0;
+    return e * 0.6931471805599453 + 2.0 * s * series;
+}
+
+// Standard normal CDF given the density at x (Abramowitz & Stegun 26.2.17,
+// absolute error below 7.5e-8)
+template <typename V, typename I>
+KERNEL_INLINE V normalCdfApprox(V x, V pdf) {
+    V absolute = (V)((I)x & 0x7FFFFFFFFFFFFFFFLL);
+    V t = 1.0 / (1.0 + 0.2316419 * absolute);
+    V poly = splat<V>(1.330274429);
+    poly = poly * t - 1.821255978;
+    poly = poly * t + 1.781477937;
+    poly = poly * t - 0.356563782;
+    poly = poly * t + 0.319381530;
+    V tail = pdf * t * poly;
+    return x < splat<V>(0.0) ? tail : 1.0 - tail;
+}
+
+template <typename V, typename I>
+KERNEL_INLINE void priceLanes(const ChainView& chain, size_t i) {
+    V forward = load<V>(chain.forward + i);
+    V strike = load<V>(chain.strike + i);
+    V timeToExpiry = load<V>(chain.timeToExpiry + i);
+    V volatility = load<V>(chain.volatility + i);
+    V rate = load<V>(chain.rate + i);
+    V callPut = load<V>(chain.callPut + i);
+    const V zero = splat<V>(0.0);
+
+    V discount = expApprox<V, I>(-rate * timeToExpiry);
+    V sqrtT = expApprox<V, I>(0.5 * logApprox<V, I>(timeToExpiry));
+    V sigmaSqrtT = volatility * sqrtT;
+    V d1 = (logApprox<V, I>(forward / strike) + 0.5 * volatility * volatility * timeToExpiry) / sigmaSqrtT;
+    // Far from the money the density underflows into subnormals, which cost
+    // microcode assists on every operation; beyond 30 sigma it is zero anyway
+    d1 = d1 < splat<V>(-30.0) ? splat<V>(-30.0) : d1;
+    d1 = d1 > splat<V>(30.0) ? splat<V>(30.0) : d1;
+    V d2 = d1 - sigmaSqrtT;
+    V pdf1 = expApprox<V, I>(-0.5 * d1 * d1) * INV_SQRT_2PI;
+    V pdf2 = pdf1 * forward / strike;  // phi(d2) = phi(d1) F / K saves an exponential
+    V nd1 = normalCdfApprox<V, I>(d1, pdf1);
+    V nd2 = normalCdfApprox<V, I>(d2, pdf2);
+    V call = discount * (forward * nd1 - strike * nd2);
+
+    auto isCall = callPut > zero;
+    V price = isCall ? call : call - discount * (forward - strike);
+    V delta = discount * (isCall ? nd1 : nd1 - 1.0);
+    V gamma = discount * pdf1 / (forward * sigmaSqrtT);
+    V vega = discount * forward * pdf1 * sqrtT;
+    V theta = rate * price - discount * forward * pdf1 * volatility / (2.0 * sqrtT);
+
+    // Expired or degenerate inputs: intrinsic value, no curvature
+    auto valid = (timeToExpiry > zero) & (volatility > zero) & (forward > zero) & (strike > zero);
+    V intrinsic = callPut * (forward - strike);
+    auto inTheMoney = intrinsic > zero;
+    store(chain.price + i, valid ? price : (inTheMoney ? discount * intrinsic : zero));
+    store(chain.delta + i, valid ? delta : (inTheMoney ? callPut * discount : zero));
+    store(chain.gamma + i, valid ? gamma : zero);
+    store(chain.vega + i, valid ? vega : zero);
+    store(chain.theta + i, valid ? theta : zero);
+}
+
+template <typename V, typename I>
+KERNEL_INLINE void priceRange(const ChainView& chain, size_t begin, size_t end) {
+    constexpr size_t WIDTH = sizeof(V) / sizeof(double);
+    size_t i = begin;
+    for (; i + WIDTH <= end; i += WIDTH) {
+        priceLanes<V, I>(chain, i);
+    }
+    if (i == end) {
+        return;
+    }
+
+    // Tail: run one padded vector so every option goes through the same kernel
+    double inputs[6][WIDTH];
+    double outputs[5][WIDTH];
+    const double* sources[6] = {chain.forward, chain.strike, chain.timeToExpiry, chain.volatility, chain.rate,
+                                chain.callPut};
+    size_t remaining = end - i;
+    for (size_t array = 0; array < 6; ++array) {
+        for (size_t lane = 0; lane < WIDTH; ++lane) {
+            inputs[array][lane] = sources[array][i + std::min(lane, remaining - 1)];
+        }
+    }
+    ChainView padded{inputs[0], inputs[1], inputs[2], inputs[3], inputs[4], inputs[5],
+                     outputs[0], outputs[1], outputs[2], outputs[3], outputs[4]};
+    priceLanes<V, I>(padded, 0);
+    double* targets[5] = {chain.price, chain.delta, chain.gamma, chain.vega, chain.theta};
+    for (size_t array = 0; array < 5; ++array) {
+        std::memcpy(targets[array] + i, outputs[array], remaining * sizeof(double));
+    }
+}
+
+__attribute__((target("avx2,fma"))) void priceAvx2(const ChainView& chain, size_t begin, size_t end) {
+    priceRange<Double4, Int4>(chain, begin, end);
+}
+
+__attribute__((target("avx512f"))) void priceAvx512(const ChainView& chain, size_t begin, size_t end) {
+    priceRange<Double8, Int8>(chain, begin, end);
+}
+
+#endif
+
+bool supported(OptionPricer::InstructionSet instructionSet) {
+    switch (instructionSet) {
+#ifdef OPTION_PRICER_SIMD
+        case OptionPricer::InstructionSet::Avx512:
+            return __builtin_cpu_supports("avx512f");
+        case OptionPricer::InstructionSet::Avx2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+        case OptionPricer::InstructionSet::Scalar:
+            return true;
+        default:
+            return false;
+    }
+}
+
+}
+
+OptionPricer::InstructionSet OptionPricer::detect() {
+    static const InstructionSet best = supported(InstructionSet::Avx512) ? InstructionSet::Avx512 :
+                                       supported(InstructionSet::Avx2) ? InstructionSet::Avx2 :
+                                       InstructionSet::Scalar;
+    return best;
+}
+
+OptionPricer::OptionPricer() : instructionSet(detect()) {}
+
+OptionPricer::OptionPricer(InstructionSet instructionSet)
+    : instructionSet(supported(instructionSet) ? instructionSet : detect()) {}
+
+void OptionPricer::price(OptionChain& chain) const {
+    price(chain, 0, chain.size());
+}
+
+void OptionPricer::price(OptionChain& chain, size_t begin, size_t end) const {
+    end = std::min(end, chain.size());
+    if (begin >= end) {
+        return;
+    }
+    ChainView view = viewOf(chain);
+    switch (instructionSet) {
+#ifdef OPTION_PRICER_SIMD
+        case InstructionSet::Avx512:
+            priceAvx512(view, begin, end);
+            return;
+        case InstructionSet::Avx2:
+            priceAvx2(view, begin, end);
+            return;
+#endif
+        default:
+            priceScalar(view, begin, end);
+    }
+}
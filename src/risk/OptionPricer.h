@@ -0,0 +1,88 @@
+// risk/OptionPricer.h
+#ifndef OPTION_PRICER_H
+#define OPTION_PRICER_H
+
+#include "../market/InstrumentRegistry.h"
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// Allocator for the chain's arrays, so SIMD loads never straddle cache lines
+template <typename T>
+struct CacheAlignedAllocator {
+    using value_type = T;
+    static constexpr std::align_val_t ALIGNMENT{64};
+
+    CacheAlignedAllocator() = default;
+    template <typename U>
+    CacheAlignedAllocator(const CacheAlignedAllocator<U>&) {}
+
+    T* allocate(size_t count) { return static_cast<T*>(::operator new(count * sizeof(T), ALIGNMENT)); }
+    void deallocate(T* pointer, size_t) { ::operator delete(pointer, ALIGNMENT); }
+
+    template <typename U>
+    bool operator==(const CacheAlignedAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const CacheAlignedAllocator<U>&) const { return false; }
+};
+
+using AlignedDoubles = std::vector<double, CacheAlignedAllocator<double>>;
+
+// Structure-of-arrays option chain: one index per option across every array,
+// so the pricer streams each input once per tick. Callers refresh forward and
+// volatility (and time to expiry as it decays) in place before pricing.
+struct OptionChain {
+    std::vector<InstrumentId> instruments;
+    // Inputs
+    AlignedDoubles forward;       // underlying forward for the option's expiry
+    AlignedDoubles strike;
+    AlignedDoubles timeToExpiry;  // years
+    AlignedDoubles volatility;    // annualized, 0.6 = 60%
+    AlignedDoubles rate;          // continuously compounded discount rate
+    AlignedDoubles callPut;       // +1 for calls, -1 for puts
+    // Outputs, per unit of the underlying and in the forward's currency
+    AlignedDoubles price;
+    AlignedDoubles delta;
+    AlignedDoubles gamma;
+    AlignedDoubles vega;   // per 1.00 of volatility
+    AlignedDoubles theta;  // per year
+
+    // Returns the option's index
+    size_t add(InstrumentId instrument, double strike, double timeToExpiry, bool isCall);
+    size_t size() const { return instruments.size(); }
+};
+
+// Batch Black-76 pricing and Greeks. The AVX-512 and AVX2 kernels are picked
+// at run time from what the CPU supports, so the binary needs no -m flags;
+// the scalar path is the portable reference. Deribit quotes option premiums
+// in the underlying: divide price by the forward to compare with its book.
+class OptionPricer {
+public:
+    enum class InstructionSet { Scalar, Avx2, Avx512 };
+
+    // Best instruction set the running CPU supports
+    static InstructionSet detect();
+
+    OptionPricer();
+    // Falls back to detect() if the requested set is not supported
+    explicit OptionPricer(InstructionSet instructionSet);
+
+    void price(OptionChain& chain) const;
+    // Prices [begin, end) only, e.g. one expiry or one thread's share
+    void price(OptionChain& chain, size_t begin, size_t end) const;
+
+    InstructionSet getInstructionSet() const { return instructionSet; }
+
+private:
+    InstructionSet instructionSet;
+};
+
+inline const char* toString(OptionPricer::InstructionSet instructionSet) {
+    switch (instructionSet) {
+        case OptionPricer::InstructionSet::Avx512: return "avx512";
+        case OptionPricer::InstructionSet::Avx2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+#endif
@@ -0,0 +1,361 @@
+#include "PnlEngine.h"
+#include "../market/MarketDataManager.h"
+#include "../websockets/WebSocketServer.h"
+#include "../include/Logger.h"
+#include <json/json.h>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Positions closer to zero than this are treated as flat
+constexpr double FLAT_EPSILON = 1e-9;
+
+void addTo(std::atomic<double>& target, double delta) {
+    double current = target.load(std::memory_order_relaxed);
+    while (!target.compare_exchange_weak(current, current + delta, std::memory_order_relaxed)) {
+    }
+}
+
+// BTC-PERPETUAL settles in BTC, BTC_USDC-PERPETUAL in USDC
+std::string_view settlementCurrency(std::string_view instrumentName) {
+    std::string_view head = instrumentName.substr(0, instrumentName.find('-'));
+    size_t underscore = head.find('_');
+    return underscore == std::string_view::npos ? head : head.substr(underscore + 1);
+}
+
+bool isUsdStablecoin(std::string_view currency) {
+    return currency == "USD" || currency == "USDC" || currency == "USDT";
+}
+
+}
+
+PnlEngine::PnlEngine(RiskManager& riskManager)
+    : riskManager(riskManager),
+      instruments(std::make_unique<InstrumentState[]>(InstrumentRegistry::MAX_INSTRUMENTS)) {}
+
+PnlEngine::~PnlEngine() {
+    if (attachedTo) {
+        attachedTo->removeBookUpdateListener(bookListener);
+    }
+    stopPublishing();
+}
+
+void PnlEngine::attach(MarketDataManager& marketDataManager) {
+    attachedTo = &marketDataManager;
+    bookListener = marketDataManager.addBookUpdateListener([this](InstrumentId instrument, const OrderBook& book) {
+        double bestBid = book.getBestBid();
+        double bestAsk = book.getBestAsk();
+        if (bestBid > 0 && bestAsk > 0) {
+            onMark(instrument, (bestBid + bestAsk) / 2);
+        }
+    });
+}
+
+void PnlEngine::setContractType(InstrumentId instrument, ContractType type) {
+    if (instrument < InstrumentRegistry::MAX_INSTRUMENTS) {
+        instruments[instrument].inverse.store(type == ContractType::Inverse, std::memory_order_relaxed);
+        instruments[instrument].contractTypeSet.store(true, std::memory_order_relaxed);
+    }
+}
+
+double PnlEngine::valuation(double price, bool inverse) {
+    return inverse ? -1.0 / price : price;
+}
+
+int PnlEngine::currencyFor(InstrumentId instrument) {
+    InstrumentState& slot = instruments[instrument];
+    int currency = slot.currency.load(std::memory_order_acquire);
+    if (currency >= 0) {
+        return currency;
+    }
+
+    // Reference data, when loaded, knows the currency and the contract type
+    const InstrumentInfo* info = InstrumentRegistry::instance().info(instrument);
+    std::string_view name = info ? info->settlementCurrency.view()
+                                 : settlementCurrency(InstrumentRegistry::instance().name(instrument).view());
+    if (info && !slot.contractTypeSet.load(std::memory_order_relaxed)) {
+        // Option premiums are already quoted in the settlement currency
+        slot.inverse.store(info->inverse && info->instrumentClass != InstrumentClass::Option,
+                           std::memory_order_relaxed);
+    }
+    currency = currencyIndex(name);
+    if (currency < 0) {
+        Logger::error("Too many settlement currencies, PnL for ", InstrumentRegistry::instance().name(instrument),
+                      " is not aggregated");
+        return -1;
+    }
+    slot.currency.store(currency, std::memory_order_release);
+    return currency;
+}
+
+int PnlEngine::currencyIndex(std::string_view name) {
+    std::lock_guard<std::mutex> lock(currencyMutex);
+    size_t count = currencyCount.load(std::memory_order_relaxed);
+    auto known = std::find_if(currencyNames, currencyNames + count, [name](const FixedString<16>& existing) {
+        return existing == name;
+    });
+    if (known != currencyNames + count) {
+        return static_cast<int>(known - currencyNames);
+    }
+    if (count == MAX_CURRENCIES) {
+        return -1;
+    }
+    currencyNames[count].assign(name);
+    if (isUsdStablecoin(name)) {
+        currencies[count].usdRate.store(1.0, std::memory_order_relaxed);
+    }
+    currencyCount.store(count + 1, std::memory_order_release);
+    return static_cast<int>(count);
+}
+
+void PnlEngine::setUsdRate(std::string_view currency, double rate) {
+    int index = rate > 0 ? currencyIndex(currency) : -1;
+    if (index < 0) {
+        return;
+    }
+    currencies[index].usdRate.store(rate, std::memory_order_relaxed);
+    version.fetch_add(1, std::memory_order_relaxed);
+    reportDailyPnl();
+}
+
+void PnlEngine::onFill(InstrumentId instrument, double signedAmount, double price) {
+    if (instrument >= InstrumentRegistry::MAX_INSTRUMENTS || signedAmount == 0 || price <= 0) {
+        return;
+    }
+    int currency = currencyFor(instrument);
+    InstrumentState& slot = instruments[instrument];
+    bool inverse = slot.inverse.load(std::memory_order_relaxed);
+    double value = valuation(price, inverse);
+
+    slot.sequence.lock();
+    double position = slot.position.load(std::memory_order_relaxed);
+    double entry = slot.entryValue.load(std::memory_order_relaxed);
+    double newPosition = position + signedAmount;
+    double realizedDelta = 0;
+
+    if (position == 0 || (position > 0) == (signedAmount > 0)) {
+        entry = (position * entry + signedAmount * value) / newPosition;
+    } else {
+        double closed = std::min(std::abs(signedAmount), std::abs(position));
+        realizedDelta = (position > 0 ? closed : -closed) * (value - entry);
+        if (std::abs(newPosition) < FLAT_EPSILON) {
+            newPosition = 0;
+            entry = 0;
+        } else if ((newPosition > 0) != (position > 0)) {
+            entry = value;  // flipped: the remainder opens at the fill price
+        }
+    }
+
+    double markPrice = slot.markPrice.load(std::memory_order_relaxed);
+    double unrealized = markPrice > 0 ? newPosition * (valuation(markPrice, inverse) - entry) : 0;
+    double unrealizedDelta = unrealized - slot.unrealized.load(std::memory_order_relaxed);
+    slot.position.store(newPosition, std::memory_order_relaxed);
+    slot.entryValue.store(entry, std::memory_order_relaxed);
+    slot.realized.store(slot.realized.load(std::memory_order_relaxed) + realizedDelta, std::memory_order_relaxed);
+    slot.unrealized.store(unrealized, std::memory_order_relaxed);
+    slot.sequence.unlock();
+
+    if (inverse && currency >= 0) {
+        currencies[currency].usdRate.store(price, std::memory_order_relaxed);
+    }
+    applyDelta(currency, realizedDelta, unrealizedDelta);
+}
+
+void PnlEngine::onMark(InstrumentId instrument, double markPrice) {
+    if (instrument >= InstrumentRegistry::MAX_INSTRUMENTS || markPrice <= 0) {
+        return;
+    }
+    InstrumentState& slot = instruments[instrument];
+    // Depth-only book updates leave the mid unchanged
+    if (slot.markPrice.load(std::memory_order_relaxed) == markPrice) {
+        return;
+    }
+
+    int currency = slot.currency.load(std::memory_order_acquire);
+    bool inverse = slot.inverse.load(std::memory_order_relaxed);
+    slot.sequence.lock();
+    slot.markPrice.store(markPrice, std::memory_order_relaxed);
+    double position = slot.position.load(std::memory_order_relaxed);
+    double unrealizedDelta = 0;
+    if (position != 0) {
+        double unrealized = position * (valuation(markPrice, inverse) - slot.entryValue.load(std::memory_order_relaxed));
+        unrealizedDelta = unrealized - slot.unrealized.load(std::memory_order_relaxed);
+        slot.unrealized.store(unrealized, std::memory_order_relaxed);
+    }
+    slot.sequence.unlock();
+
+    // A new coin rate re-values the day's PnL in that coin even when this
+    // instrument is flat, so it is reported either way
+    bool rateChanged = inverse && currency >= 0;
+    if (rateChanged) {
+        currencies[currency].usdRate.store(markPrice, std::memory_order_relaxed);
+    }
+    if (unrealizedDelta != 0 || rateChanged) {
+        applyDelta(currency, 0, unrealizedDelta);
+    }
+}
+
+void PnlEngine::applyDelta(int currency, double realizedDelta, double unrealizedDelta) {
+    if (currency < 0) {
+        return;
+    }
+    CurrencyTotals& totals = currencies[currency];
+    if (realizedDelta != 0) {
+        addTo(totals.realized, realizedDelta);
+    }
+    if (unrealizedDelta != 0) {
+        addTo(totals.unrealized, unrealizedDelta);
+    }
+    version.fetch_add(1, std::memory_order_relaxed);
+    reportDailyPnl();
+}
+
+void PnlEngine::reportDailyPnl() {
+    riskManager.reportDailyPnl(getDailyPnlUsd());
+}
+
+double PnlEngine::getDailyPnlUsd() const {
+    double total = 0;
+    size_t count = currencyCount.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        const CurrencyTotals& totals = currencies[i];
+        double daily = totals.realized.load(std::memory_order_relaxed) +
+                       totals.unrealized.load(std::memory_order_relaxed) -
+                       totals.dayStart.load(std::memory_order_relaxed);
+        double rate = totals.usdRate.load(std::memory_order_relaxed);
+        if (rate > 0) {
+            total += daily * rate;
+        } else if (daily != 0 && !totals.missingRateLogged.exchange(true, std::memory_order_relaxed)) {
+            Logger::warning("No USD rate for ", currencyNames[i].view(), ", its PnL is left out of the daily loss check");
+        }
+    }
+    return total;
+}
+
+void PnlEngine::startNewDay() {
+    size_t count = currencyCount.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        CurrencyTotals& totals = currencies[i];
+        totals.dayStart.store(totals.realized.load(std::memory_order_relaxed) +
+                              totals.unrealized.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    riskManager.resetDailyLoss();
+    version.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool PnlEngine::getInstrumentPnl(InstrumentId instrument, InstrumentPnl& pnl) const {
+    if (instrument >= InstrumentRegistry::MAX_INSTRUMENTS) {
+        return false;
+    }
+    const InstrumentState& slot = instruments[instrument];
+    if (slot.currency.load(std::memory_order_acquire) < 0) {
+        return false;
+    }
+
+    bool inverse = slot.inverse.load(std::memory_order_relaxed);
+    double entry;
+    uint32_t begin;
+    do {
+        begin = slot.sequence.readBegin();
+        pnl.position = slot.position.load(std::memory_order_relaxed);
+        entry = slot.entryValue.load(std::memory_order_relaxed);
+        pnl.markPrice = slot.markPrice.load(std::memory_order_relaxed);
+        pnl.realized = slot.realized.load(std::memory_order_relaxed);
+        pnl.unrealized = slot.unrealized.load(std::memory_order_relaxed);
+    } while (slot.sequence.readRetry(begin));
+    pnl.averagePrice = entry == 0 ? 0 : (inverse ? -1.0 / entry : entry);
+    return true;
+}
+
+std::vector<PnlEngine::CurrencyPnl> PnlEngine::getCurrencyPnl() const {
+    std::vector<CurrencyPnl> result;
+    size_t count = currencyCount.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        const CurrencyTotals& totals = currencies[i];
+        CurrencyPnl pnl;
+        pnl.currency = currencyNames[i].str();
+        pnl.realized = totals.realized.load(std::memory_order_relaxed);
+        pnl.unrealized = totals.unrealized.load(std::memory_order_relaxed);
+        pnl.daily = pnl.realized + pnl.unrealized - totals.dayStart.load(std::memory_order_relaxed);
+        pnl.usdRate = totals.usdRate.load(std::memory_order_relaxed);
+        result.push_back(pnl);
+    }
+    return result;
+}
+
+std::string PnlEngine::snapshotJson() const {
+    Json::Value root;
+    root["type"] = "pnl";
+    root["currencies"] = Json::arrayValue;
+    for (const CurrencyPnl& pnl : getCurrencyPnl()) {
+        Json::Value entry;
+        entry["currency"] = pnl.currency;
+        entry["realized"] = pnl.realized;
+        entry["unrealized"] = pnl.unrealized;
+        entry["daily"] = pnl.daily;
+        entry["usd_rate"] = pnl.usdRate;
+        root["currencies"].append(entry);
+    }
+
+    root["daily_usd"] = getDailyPnlUsd();
+
+    root["instruments"] = Json::arrayValue;
+    size_t count = std::min(InstrumentRegistry::instance().size(), InstrumentRegistry::MAX_INSTRUMENTS);
+    for (InstrumentId instrument = 0; instrument < count; ++instrument) {
+        InstrumentPnl pnl;
+        if (!getInstrumentPnl(instrument, pnl)) {
+            continue;
+        }
+        Json::Value entry;
+        entry["instrument"] = InstrumentRegistry::instance().name(instrument).str();
+        entry["position"] = pnl.position;
+        entry["average_price"] = pnl.averagePrice;
+        entry["mark_price"] = pnl.markPrice;
+        entry["realized"] = pnl.realized;
+        entry["unrealized"] = pnl.unrealized;
+        root["instruments"].append(entry);
+    }
+
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "";
+    return Json::writeString(writer, root);
+}
+
+void PnlEngine::startPublishing(WebSocketServer& server, std::chrono::milliseconds interval) {
+    stopPublishing();
+    publishing = true;
+    publishThread = std::thread(&PnlEngine::publishLoop, this, std::ref(server), interval);
+}
+
+void PnlEngine::stopPublishing() {
+    {
+        std::lock_guard<std::mutex> lock(publishMutex);
+        publishing = false;
+    }
+    publishCV.notify_all();
+    if (publishThread.joinable()) {
+        publishThread.join();
+    }
+}
+
+void PnlEngine::publishLoop(WebSocketServer& server, std::chrono::milliseconds interval) {
+    uint64_t published = version.load(std::memory_order_relaxed) - 1;
+    std::unique_lock<std::mutex> lock(publishMutex);
+    while (publishing) {
+        publishCV.wait_for(lock, interval, [this]() { return !publishing; });
+        uint64_t current = version.load(std::memory_order_relaxed);
+        if (!publishing || current == published) {
+            continue;
+        }
+        published = current;
+
+        lock.unlock();
+        try {
+            server.broadcastToSubscribers("pnl", snapshotJson());
+        } catch (const std::exception& e) {
+            Logger::error("Error publishing PnL: ", e.what());
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,132 @@
+// risk/PnlEngine.h
+#ifndef PNL_ENGINE_H
+#define PNL_ENGINE_H
+
+#include "RiskManager.h"
+#include "../market/InstrumentRegistry.h"
+#include "../../include/FixedString.h"
+#include "../../include/SeqLock.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+class MarketDataManager;
+class WebSocketServer;
+
+// Realized and unrealized PnL per instrument, aggregated per settlement
+// currency. Fills realize PnL against the average entry; each mid-price change
+// re-marks only its own instrument and applies the difference to the currency
+// totals, so a book update costs the same however many instruments are held.
+// Every change reports the day's PnL to the RiskManager, which stops new
+// orders once it falls below -maxDailyLoss. That limit is in USD, so each
+// currency's daily PnL is converted at its USD rate and the sum is reported:
+// stablecoins count at 1, and a coin is worth the latest fill or mark of an
+// inverse contract settled in it (BTC-PERPETUAL quotes BTC in USD).
+class PnlEngine {
+public:
+    enum class ContractType : uint8_t {
+        Linear,  // PnL = amount * (exit - entry), in the quote currency
+        Inverse  // PnL = amount * (1 / entry - 1 / exit), in the base currency (Deribit futures)
+    };
+
+    struct InstrumentPnl {
+        double position = 0;
+        double averagePrice = 0;
+        double markPrice = 0;
+        double realized = 0;
+        double unrealized = 0;
+    };
+
+    struct CurrencyPnl {
+        std::string currency;
+        double realized = 0;
+        double unrealized = 0;
+        double daily = 0;  // realized plus unrealized change since startNewDay
+        double usdRate = 0;  // 0 until known
+    };
+
+    static constexpr size_t MAX_CURRENCIES = 16;
+
+    explicit PnlEngine(RiskManager& riskManager);
+    ~PnlEngine();
+
+    // Marks instruments at the mid of their local book on every book update
+    void attach(MarketDataManager& marketDataManager);
+    // Set before the instrument trades. Defaults to the instrument's
+    // reference data, or linear when there is none.
+    void setContractType(InstrumentId instrument, ContractType type);
+    // USD value of one unit of a settlement currency, e.g. from an index feed,
+    // for currencies held only through options or linear contracts
+    void setUsdRate(std::string_view currency, double rate);
+
+    // signedAmount is positive for buys
+    void onFill(InstrumentId instrument, double signedAmount, double price);
+    void onMark(InstrumentId instrument, double markPrice);
+    // Daily PnL restarts from the current totals and the loss limit is re-armed
+    void startNewDay();
+
+    // Returns false for instruments that never traded
+    bool getInstrumentPnl(InstrumentId instrument, InstrumentPnl& pnl) const;
+    std::vector<CurrencyPnl> getCurrencyPnl() const;
+    // The sum reported to the RiskManager; currencies without a rate are left out
+    double getDailyPnlUsd() const;
+
+    // Broadcasts a JSON snapshot to the server's "pnl" subscribers at most
+    // once per interval, and only when something changed
+    void startPublishing(WebSocketServer& server, std::chrono::milliseconds interval = std::chrono::milliseconds(1000));
+    void stopPublishing();
+
+private:
+    struct alignas(64) InstrumentState {
+        SeqLock sequence;  // guards the fields below as one record
+        std::atomic<double> position{0};
+        // Average entry in valuation space: the price, or -1 / price for
+        // inverse contracts, so both kinds share the same arithmetic
+        std::atomic<double> entryValue{0};
+        std::atomic<double> markPrice{0};
+        std::atomic<double> realized{0};
+        std::atomic<double> unrealized{0};
+        std::atomic<int> currency{-1};  // assigned on the first fill
+        std::atomic<bool> inverse{false};
+        std::atomic<bool> contractTypeSet{false};  // by setContractType, over the reference data
+    };
+
+    struct alignas(64) CurrencyTotals {
+        std::atomic<double> realized{0};
+        std::atomic<double> unrealized{0};
+        std::atomic<double> dayStart{0};  // realized + unrealized when the day started
+        std::atomic<double> usdRate{0};
+        mutable std::atomic<bool> missingRateLogged{false};
+    };
+
+    RiskManager& riskManager;
+    MarketDataManager* attachedTo = nullptr;
+    uint64_t bookListener = 0;
+    std::unique_ptr<InstrumentState[]> instruments;  // indexed by InstrumentId
+    CurrencyTotals currencies[MAX_CURRENCIES];
+    FixedString<16> currencyNames[MAX_CURRENCIES];
+    std::atomic<size_t> currencyCount{0};
+    std::mutex currencyMutex;  // serializes assigning new currencies
+    std::atomic<uint64_t> version{0};  // bumped on every change, for the publisher
+
+    std::thread publishThread;
+    std::mutex publishMutex;
+    std::condition_variable publishCV;
+    bool publishing = false;
+
+    int currencyFor(InstrumentId instrument);
+    int currencyIndex(std::string_view name);
+    static double valuation(double price, bool inverse);
+    void applyDelta(int currency, double realizedDelta, double unrealizedDelta);
+    void reportDailyPnl();
+    std::string snapshotJson() const;
+    void publishLoop(WebSocketServer& server, std::chrono::milliseconds interval);
+};
+
+#endif
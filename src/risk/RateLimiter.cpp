@@ -0,0 +1,122 @@
+#include "RateLimiter.h"
+#include <algorithm>
+
+RateLimiter::RateLimiter() : RateLimiter(Config()) {}
+
+RateLimiter::RateLimiter(const Config& config)
+    : instrumentBuckets(std::make_unique<Bucket[]>(InstrumentRegistry::MAX_INSTRUMENTS)) {
+    configure(config);
+}
+
+void RateLimiter::configure(const Config& config) {
+    setParams(globalParams, config.globalCreditsPerSecond, config.globalBurstCredits);
+    setParams(instrumentParams, config.instrumentCreditsPerSecond, config.instrumentBurstCredits);
+    paceRequests.store(config.paceRequests, std::memory_order_relaxed);
+    maxPaceDelayNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(config.maxPaceDelay).count(),
+                         std::memory_order_relaxed);
+}
+
+void RateLimiter::setInstrumentRate(double creditsPerSecond, double burstCredits) {
+    setParams(instrumentParams, creditsPerSecond, burstCredits);
+}
+
+int64_t RateLimiter::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+void RateLimiter::setParams(BucketParams& params, double creditsPerSecond, double burstCredits) {
+    // A non-positive rate disables the bucket
+    int64_t interval = creditsPerSecond > 0 ? static_cast<int64_t>(1e9 / creditsPerSecond) : 0;
+    params.intervalNs.store(interval, std::memory_order_relaxed);
+    params.toleranceNs.store(static_cast<int64_t>(interval * std::max(burstCredits, 1.0)), std::memory_order_relaxed);
+}
+
+int64_t RateLimiter::projectedDelay(const Bucket& bucket, const BucketParams& params, double cost, int64_t now) {
+    int64_t interval = params.intervalNs.load(std::memory_order_relaxed);
+    if (interval == 0) {
+        return 0;
+    }
+    int64_t tat = std::max(bucket.theoreticalArrivalNs.load(std::memory_order_relaxed), now);
+    int64_t newTat = tat + static_cast<int64_t>(cost * interval);
+    return newTat - now - params.toleranceNs.load(std::memory_order_relaxed);
+}
+
+bool RateLimiter::reserve(Bucket& bucket, const BucketParams& params, double cost, int64_t now,
+                          int64_t maxDelay, int64_t& delay) {
+    int64_t interval = params.intervalNs.load(std::memory_order_relaxed);
+    if (interval == 0) {
+        delay = 0;
+        return true;
+    }
+    int64_t tolerance = params.toleranceNs.load(std::memory_order_relaxed);
+    int64_t increment = static_cast<int64_t>(cost * interval);
+
+    int64_t current = bucket.theoreticalArrivalNs.load(std::memory_order_relaxed);
+    while (true) {
+        int64_t newTat = std::max(current, now) + increment;
+        int64_t wait = newTat - now - tolerance;
+        if (wait > maxDelay) {
+            return false;
+        }
+        if (bucket.theoreticalArrivalNs.compare_exchange_weak(current, newTat, std::memory_order_acq_rel,
+                                                              std::memory_order_relaxed)) {
+            delay = std::max<int64_t>(wait, 0);
+            return true;
+        }
+    }
+}
+
+void RateLimiter::refund(Bucket& bucket, const BucketParams& params, double cost) {
+    int64_t interval = params.intervalNs.load(std::memory_order_relaxed);
+    bucket.theoreticalArrivalNs.fetch_sub(static_cast<int64_t>(cost * interval), std::memory_order_acq_rel);
+}
+
+bool RateLimiter::wouldExceed(InstrumentId instrument, double cost) const {
+    int64_t now = nowNs();
+    if (projectedDelay(globalBucket, globalParams, cost, now) > 0) {
+        return true;
+    }
+    return instrument < InstrumentRegistry::MAX_INSTRUMENTS &&
+           projectedDelay(instrumentBuckets[instrument], instrumentParams, cost, now) > 0;
+}
+
+bool RateLimiter::acquireBuckets(InstrumentId instrument, double cost, int64_t maxDelay, int64_t& delay) {
+    int64_t now = nowNs();
+    int64_t instrumentDelay = 0;
+    bool hasInstrument = instrument < InstrumentRegistry::MAX_INSTRUMENTS;
+
+    if (hasInstrument &&
+        !reserve(instrumentBuckets[instrument], instrumentParams, cost, now, maxDelay, instrumentDelay)) {
+        return false;
+    }
+
+    int64_t globalDelay = 0;
+    if (!reserve(globalBucket, globalParams, cost, now, maxDelay, globalDelay)) {
+        if (hasInstrument) {
+            refund(instrumentBuckets[instrument], instrumentParams, cost);
+        }
+        return false;
+    }
+
+    delay = std::max(instrumentDelay, globalDelay);
+    return true;
+}
+
+bool RateLimiter::tryAcquire(InstrumentId instrument, double cost) {
+    int64_t delay = 0;
+    return acquireBuckets(instrument, cost, 0, delay);
+}
+
+bool RateLimiter::acquire(InstrumentId instrument, std::chrono::nanoseconds& delay, double cost) {
+    delay = std::chrono::nanoseconds::zero();
+    if (!paceRequests.load(std::memory_order_relaxed)) {
+        return tryAcquire(instrument, cost);
+    }
+
+    int64_t delayNs = 0;
+    if (!acquireBuckets(instrument, cost, maxPaceDelayNs.load(std::memory_order_relaxed), delayNs)) {
+        return false;
+    }
+    delay = std::chrono::nanoseconds(std::max<int64_t>(delayNs, 0));
+    return true;
+}
@@ -0,0 +1,72 @@
+// risk/RateLimiter.h
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+#include "../market/InstrumentRegistry.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+// Credit-based limiter modelled on Deribit's matching-engine limits: one
+// global bucket plus one bucket per instrument. Each bucket is a single atomic
+// "theoretical arrival time" (GCRA), which is equivalent to a token bucket
+// that refills continuously, so checks never take a lock.
+class RateLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Config {
+        double globalCreditsPerSecond = 10.0;
+        double globalBurstCredits = 20.0;
+        double instrumentCreditsPerSecond = 5.0;
+        double instrumentBurstCredits = 10.0;
+        bool paceRequests = false;                 // wait for credits instead of rejecting
+        std::chrono::milliseconds maxPaceDelay{250};
+    };
+
+    static constexpr double REQUEST_COST = 1.0;
+
+    RateLimiter();
+    explicit RateLimiter(const Config& config);
+
+    void configure(const Config& config);
+    void setInstrumentRate(double creditsPerSecond, double burstCredits);
+
+    // Non-consuming check; INVALID_INSTRUMENT only consults the global bucket
+    bool wouldExceed(InstrumentId instrument, double cost = REQUEST_COST) const;
+    // Consumes credits from both buckets or neither
+    bool tryAcquire(InstrumentId instrument, double cost = REQUEST_COST);
+    // Like tryAcquire, but in pacing mode reserves credits up to maxPaceDelay
+    // ahead. delay is how long the caller must wait before sending; the
+    // limiter never sleeps, so coroutines can wait on a timer instead.
+    bool acquire(InstrumentId instrument, std::chrono::nanoseconds& delay, double cost = REQUEST_COST);
+
+private:
+    struct alignas(64) Bucket {
+        std::atomic<int64_t> theoreticalArrivalNs{0};
+    };
+
+    struct alignas(64) BucketParams {
+        std::atomic<int64_t> intervalNs{0};   // time to refill one credit
+        std::atomic<int64_t> toleranceNs{0};  // burst capacity expressed as time
+    };
+
+    Bucket globalBucket;
+    std::unique_ptr<Bucket[]> instrumentBuckets;
+    BucketParams globalParams;
+    BucketParams instrumentParams;
+    std::atomic<bool> paceRequests;
+    std::atomic<int64_t> maxPaceDelayNs;
+
+    static int64_t nowNs();
+    static void setParams(BucketParams& params, double creditsPerSecond, double burstCredits);
+    static int64_t projectedDelay(const Bucket& bucket, const BucketParams& params, double cost, int64_t now);
+    static bool reserve(Bucket& bucket, const BucketParams& params, double cost, int64_t now,
+                        int64_t maxDelay, int64_t& delay);
+    static void refund(Bucket& bucket, const BucketParams& params, double cost);
+
+    bool acquireBuckets(InstrumentId instrument, double cost, int64_t maxDelay, int64_t& delay);
+};
+
+#endif
@@ -1,98 +1,360 @@
 #include "RiskManager.h"
 #include "../include/Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
-RiskManager::RiskManager() {
-    limits.maxOrderSize = 1.0;
-    limits.maxPositionSize = 5.0;
-    limits.maxLeverage = 10.0;
-    limits.minMargin = 0.1;
-    limits.maxDailyLoss = 1000.0;
-    limits.maxOrdersPerSecond = 5;
-}
-
-bool RiskManager::validateOrder(const Order& order) {
-    std::lock_guard<std::mutex> lock(riskMutex);
-    
-    try {
-        if (!checkOrderSize(order)) {
-            Logger::warning("Order rejected: Exceeds maximum order size");
-            return false;
-        }
+namespace {
 
-        if (!checkPositionLimit(order)) {
-            Logger::warning("Order rejected: Would exceed position limit");
-            return false;
+void addTo(std::atomic<double>& target, double delta) {
+    double current = target.load(std::memory_order_relaxed);
+    while (!target.compare_exchange_weak(current, current + delta, std::memory_order_relaxed)) {
+    }
+}
+
+// Without reference data: BTC-PERPETUAL settles in BTC, BTC_USDC-PERPETUAL in USDC
+bool isInverseByName(std::string_view name) {
+    return name.substr(0, name.find('-')).find('_') == std::string_view::npos;
+}
+
+}
+
+RiskManager::RiskManager(RateLimiter* rateLimiter)
+    : rateLimiter(rateLimiter),
+      instruments(std::make_unique<InstrumentRisk[]>(InstrumentRegistry::MAX_INSTRUMENTS)) {
+    RiskLimits defaults;
+    defaults.maxOrderSize = 1.0;
+    defaults.maxPositionSize = 5.0;
+    defaults.maxLeverage = 10.0;
+    defaults.minMargin = 0.1;
+    defaults.maxDailyLoss = 1000.0;
+    defaults.maxOrdersPerSecond = 5;
+    publishLimits(defaults);
+}
+
+RiskRejection RiskManager::checkOrder(const Order& order) {
+    if (order.instrumentId >= InstrumentRegistry::MAX_INSTRUMENTS) {
+        return RiskRejection::UnknownInstrument;
+    }
+    InstrumentClass instrumentClass = classOf(order.instrumentId);
+    const RuleLimits& rules = limits.load(std::memory_order_acquire)->rules[static_cast<size_t>(instrumentClass)];
+    InstrumentRisk& slot = instruments[order.instrumentId];
+    // An inverse contract's coin delta is judged at the order's own price
+    double unitDelta = slot.inverse.load(std::memory_order_relaxed) && order.price > 0
+                           ? 1.0 / order.price
+                           : slot.unitDelta.load(std::memory_order_relaxed);
+
+    RuleContext context{order,
+                        rules,
+                        order.side == OrderSide::Buy ? order.amount : -order.amount,
+                        slot.position.load(std::memory_order_relaxed),
+                        unitDelta,
+                        slot.unitGamma.load(std::memory_order_relaxed),
+                        slot.unitVega.load(std::memory_order_relaxed),
+                        slot.unitMargin.load(std::memory_order_relaxed),
+                        portfolioDelta.load(std::memory_order_relaxed),
+                        portfolioGamma.load(std::memory_order_relaxed),
+                        portfolioVega.load(std::memory_order_relaxed),
+                        optionMargin.load(std::memory_order_relaxed),
+                        dailyLossBreached.load(std::memory_order_relaxed),
+                        rateLimiter};
+    RiskRejection rejection = instrumentClass == InstrumentClass::Option ? OptionRiskRules::check(context)
+                                                                         : LinearRiskRules::check(context);
+    if (rejection != RiskRejection::None) {
+        return rejection;
+    }
+
+    // Last, so nothing has to be handed back if a rule fails
+    double maxPosition = rules.enabledRules & ruleBit(RiskRejection::PositionLimit)
+                             ? rules.maxPositionSize
+                             : std::numeric_limits<double>::infinity();
+    if (!reserve(slot, order.side, order.amount, maxPosition)) {
+        return RiskRejection::PositionLimit;
+    }
+    return RiskRejection::None;
+}
+
+InstrumentClass RiskManager::classOf(InstrumentId instrument) {
+    InstrumentRisk& slot = instruments[instrument];
+    uint8_t instrumentClass = slot.instrumentClass.load(std::memory_order_relaxed);
+    if (instrumentClass != UNCLASSIFIED) {
+        return static_cast<InstrumentClass>(instrumentClass);
+    }
+
+    // Racing callers compute the same answer; the name decides without reference data
+    const InstrumentRegistry& registry = InstrumentRegistry::instance();
+    const InstrumentInfo* info = registry.info(instrument);
+    std::string_view name = registry.name(instrument).view();
+    InstrumentClass classified = info ? info->instrumentClass : classifyInstrument(name);
+    uint8_t expected = UNCLASSIFIED;
+    if (!slot.instrumentClass.compare_exchange_strong(expected, static_cast<uint8_t>(classified),
+                                                      std::memory_order_relaxed)) {
+        return static_cast<InstrumentClass>(expected);
+    }
+
+    // Only the caller that classified it sets the delta, so a position held
+    // before is added to the portfolio once
+    if (classified == InstrumentClass::Future || classified == InstrumentClass::Perpetual) {
+        bool inverse = info ? info->inverse : isInverseByName(name);
+        slot.inverse.store(inverse, std::memory_order_relaxed);
+        if (!inverse) {
+            setUnitDelta(slot, 1.0);
+        } else {
+            double size;
+            double averagePrice;
+            if (getPosition(instrument, size, averagePrice) && averagePrice > 0) {
+                setUnitDelta(slot, 1.0 / averagePrice);
+            }
         }
+    }
+    return classified;
+}
 
-        if (!checkLeverage(order)) {
-            Logger::warning("Order rejected: Would exceed leverage limit");
+void RiskManager::setUnitDelta(InstrumentRisk& slot, double unitDelta) {
+    slot.sequence.lock();
+    double change = slot.position.load(std::memory_order_relaxed) *
+                    (unitDelta - slot.unitDelta.load(std::memory_order_relaxed));
+    slot.unitDelta.store(unitDelta, std::memory_order_relaxed);
+    slot.sequence.unlock();
+    addTo(portfolioDelta, change);
+}
+
+bool RiskManager::reserveExposure(InstrumentId instrument, OrderSide side, double amount) {
+    if (instrument >= InstrumentRegistry::MAX_INSTRUMENTS) {
+        return false;
+    }
+    const RuleLimits& rules = limits.load(std::memory_order_acquire)->rules[static_cast<size_t>(classOf(instrument))];
+    double maxPosition = rules.enabledRules & ruleBit(RiskRejection::PositionLimit)
+                             ? rules.maxPositionSize
+                             : std::numeric_limits<double>::infinity();
+    return reserve(instruments[instrument], side, amount, maxPosition);
+}
+
+bool RiskManager::reserve(InstrumentRisk& slot, OrderSide side, double amount, double maxPosition) {
+    double position = slot.position.load(std::memory_order_relaxed);
+    std::atomic<double>& open = side == OrderSide::Buy ? slot.openBuys : slot.openSells;
+
+    double reserved = open.load(std::memory_order_relaxed);
+    do {
+        // Only the side being added to is limited, so reducing orders always pass
+        bool exceeds = side == OrderSide::Buy ? position + reserved + amount > maxPosition
+                                              : position - reserved - amount < -maxPosition;
+        if (exceeds) {
             return false;
         }
+    } while (!open.compare_exchange_weak(reserved, reserved + amount, std::memory_order_relaxed));
+    return true;
+}
 
-        if (!checkMargin(order)) {
-            Logger::warning("Order rejected: Insufficient margin");
-            return false;
+void RiskManager::adjustExposure(InstrumentId instrument, OrderSide side, double delta) {
+    if (instrument >= InstrumentRegistry::MAX_INSTRUMENTS || delta == 0) {
+        return;
+    }
+    InstrumentRisk& slot = instruments[instrument];
+    std::atomic<double>& open = side == OrderSide::Buy ? slot.openBuys : slot.openSells;
+
+    // Clamped so that a missed update can only make the check stricter
+    double reserved = open.load(std::memory_order_relaxed);
+    while (!open.compare_exchange_weak(reserved, std::max(0.0, reserved + delta), std::memory_order_relaxed)) {
+    }
+}
+
+void RiskManager::getOpenExposure(InstrumentId instrument, double& openBuys, double& openSells) const {
+    openBuys = 0;
+    openSells = 0;
+    if (instrument < InstrumentRegistry::MAX_INSTRUMENTS) {
+        openBuys = instruments[instrument].openBuys.load(std::memory_order_relaxed);
+        openSells = instruments[instrument].openSells.load(std::memory_order_relaxed);
+    }
+}
+
+void RiskManager::updatePosition(InstrumentId instrument, double amount, double price) {
+    if (instrument >= InstrumentRegistry::MAX_INSTRUMENTS) {
+        return;
+    }
+    // Classified first, so the fill moves portfolio delta by the right unit
+    classOf(instrument);
+    InstrumentRisk& slot = instruments[instrument];
+    bool inverse = slot.inverse.load(std::memory_order_relaxed);
+
+    // Writers to one instrument serialize on the sequence; other instruments
+    // and readers are unaffected
+    slot.sequence.lock();
+
+    double oldPosition = slot.position.load(std::memory_order_relaxed);
+    double oldAvgPrice = slot.averagePrice.load(std::memory_order_relaxed);
+    double newPosition = oldPosition + amount;
+    slot.position.store(newPosition, std::memory_order_relaxed);
+    // Update average price calculation
+    if (std::abs(newPosition) > 0) {
+        slot.averagePrice.store((oldPosition * oldAvgPrice + amount * price) / newPosition, std::memory_order_relaxed);
+    } else {
+        slot.averagePrice.store(0, std::memory_order_relaxed);
+    }
+    slot.active.store(true, std::memory_order_relaxed);
+    // An inverse position is re-valued in coin at each fill's price
+    double oldUnitDelta = slot.unitDelta.load(std::memory_order_relaxed);
+    double newUnitDelta = inverse && price > 0 ? 1.0 / price : oldUnitDelta;
+    slot.unitDelta.store(newUnitDelta, std::memory_order_relaxed);
+    double deltaChange = newPosition * newUnitDelta - oldPosition * oldUnitDelta;
+    double gammaChange = amount * slot.unitGamma.load(std::memory_order_relaxed);
+    double vegaChange = amount * slot.unitVega.load(std::memory_order_relaxed);
+    double marginChange = (std::max(0.0, -newPosition) - std::max(0.0, -oldPosition)) *
+                          slot.unitMargin.load(std::memory_order_relaxed);
+
+    slot.sequence.unlock();
+
+    if (marginChange != 0) {
+        addTo(optionMargin, marginChange);
+    }
+
+    if (deltaChange != 0 || gammaChange != 0 || vegaChange != 0) {
+        addTo(portfolioDelta, deltaChange);
+        addTo(portfolioGamma, gammaChange);
+        addTo(portfolioVega, vegaChange);
+    }
+}
+
+void RiskManager::updateGreeks(const InstrumentId* ids, const double* delta, const double* gamma, const double* vega,
+                               size_t count) {
+    // Summed locally so a whole chain costs one update of each total
+    double deltaChange = 0;
+    double gammaChange = 0;
+    double vegaChange = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (ids[i] >= InstrumentRegistry::MAX_INSTRUMENTS) {
+            continue;
         }
+        InstrumentRisk& slot = instruments[ids[i]];
+        // Under the sequence so a concurrent fill sees either the old or the
+        // new Greeks, never applies its amount twice or not at all
+        slot.sequence.lock();
+        double position = slot.position.load(std::memory_order_relaxed);
+        deltaChange += position * (delta[i] - slot.unitDelta.load(std::memory_order_relaxed));
+        gammaChange += position * (gamma[i] - slot.unitGamma.load(std::memory_order_relaxed));
+        vegaChange += position * (vega[i] - slot.unitVega.load(std::memory_order_relaxed));
+        slot.unitDelta.store(delta[i], std::memory_order_relaxed);
+        slot.unitGamma.store(gamma[i], std::memory_order_relaxed);
+        slot.unitVega.store(vega[i], std::memory_order_relaxed);
+        slot.sequence.unlock();
+    }
+    addTo(portfolioDelta, deltaChange);
+    addTo(portfolioGamma, gammaChange);
+    addTo(portfolioVega, vegaChange);
+}
 
-        if (!checkRateLimit(order.instrumentName)) {
-            Logger::warning("Order rejected: Rate limit exceeded");
-            return false;
+void RiskManager::updateMargins(const InstrumentId* ids, const double* shortMargin, size_t count) {
+    double marginChange = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (ids[i] >= InstrumentRegistry::MAX_INSTRUMENTS) {
+            continue;
         }
+        InstrumentRisk& slot = instruments[ids[i]];
+        slot.sequence.lock();
+        double shortPosition = std::max(0.0, -slot.position.load(std::memory_order_relaxed));
+        marginChange += shortPosition * (shortMargin[i] - slot.unitMargin.load(std::memory_order_relaxed));
+        slot.unitMargin.store(shortMargin[i], std::memory_order_relaxed);
+        slot.sequence.unlock();
+    }
+    addTo(optionMargin, marginChange);
+}
 
-        Logger::info("Order passed all risk checks");
-        return true;
+RiskManager::Greeks RiskManager::getPortfolioGreeks() const {
+    Greeks greeks;
+    greeks.delta = portfolioDelta.load(std::memory_order_relaxed);
+    greeks.gamma = portfolioGamma.load(std::memory_order_relaxed);
+    greeks.vega = portfolioVega.load(std::memory_order_relaxed);
+    return greeks;
+}
 
-    } catch (const std::exception& e) {
-        Logger::error("Error in risk validation: ", e.what());
+bool RiskManager::getPosition(InstrumentId instrument, double& size, double& averagePrice) const {
+    if (instrument >= InstrumentRegistry::MAX_INSTRUMENTS) {
         return false;
     }
+    const InstrumentRisk& slot = instruments[instrument];
+
+    uint32_t version;
+    bool active;
+    do {
+        version = slot.sequence.readBegin();
+        size = slot.position.load(std::memory_order_relaxed);
+        averagePrice = slot.averagePrice.load(std::memory_order_relaxed);
+        active = slot.active.load(std::memory_order_relaxed);
+    } while (slot.sequence.readRetry(version));
+    return active;
+}
+
+void RiskManager::reportDailyPnl(double pnl) {
+    if (pnl >= -limits.load(std::memory_order_acquire)->limits.maxDailyLoss ||
+        dailyLossBreached.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (!dailyLossBreached.exchange(true)) {
+        if (std::shared_ptr<const DailyLossCallback> callback = dailyLossCallback.load(std::memory_order_acquire)) {
+            (*callback)(pnl);
+        }
+        Logger::error("Daily loss limit reached (PnL ", pnl, "), rejecting new orders");
+    }
 }
 
-bool RiskManager::checkOrderSize(const Order& order) {
-    return order.amount <= limits.maxOrderSize;
+void RiskManager::setDailyLossCallback(DailyLossCallback callback) {
+    dailyLossCallback.store(callback ? std::make_shared<const DailyLossCallback>(std::move(callback)) : nullptr,
+                            std::memory_order_release);
 }
 
-bool RiskManager::checkPositionLimit(const Order& order) {
-    double currentPosition = positions[order.instrumentName];
-    double newPosition = currentPosition;
-    
-    if (order.side == "buy") {
-        newPosition += order.amount;
-    } else {
-        newPosition -= order.amount;
+void RiskManager::resetDailyLoss() {
+    if (dailyLossBreached.exchange(false)) {
+        Logger::info("Daily loss limit re-armed");
     }
-    
-    return std::abs(newPosition) <= limits.maxPositionSize;
 }
 
-bool RiskManager::checkLeverage(const Order& order) {
-    // Simplified leverage calculation
-    double totalPosition = order.amount * order.price;
-    double currentMargin = totalPosition / limits.maxLeverage;
-    return currentMargin >= limits.minMargin;
+void RiskManager::publishLimits(const RiskLimits& newLimits) {
+    auto resolved = std::make_unique<LimitSnapshot>();
+    resolved->limits = newLimits;
+    for (size_t i = 0; i < INSTRUMENT_CLASS_COUNT; ++i) {
+        const RiskLimits::ClassRules& overrides = newLimits.classRules[i];
+        RuleLimits& rules = resolved->rules[i];
+        rules.enabledRules = overrides.enabledRules;
+        rules.maxOrderSize = overrides.maxOrderSize > 0 ? overrides.maxOrderSize : newLimits.maxOrderSize;
+        rules.maxPositionSize = overrides.maxPositionSize > 0 ? overrides.maxPositionSize : newLimits.maxPositionSize;
+        rules.maxLeverage = overrides.maxLeverage > 0 ? overrides.maxLeverage : newLimits.maxLeverage;
+        rules.minMargin = overrides.minMargin > 0 ? overrides.minMargin : newLimits.minMargin;
+        rules.maxPortfolioDelta = newLimits.maxPortfolioDelta;
+        rules.maxPortfolioGamma = newLimits.maxPortfolioGamma;
+        rules.maxPortfolioVega = newLimits.maxPortfolioVega;
+        rules.maxOptionMargin = newLimits.maxOptionMargin;
+    }
+    std::unique_ptr<const LimitSnapshot> snapshot = std::move(resolved);
+    limits.store(snapshot.get(), std::memory_order_release);
+    limitSnapshots.push_back(std::move(snapshot));
+
+    if (rateLimiter && newLimits.maxOrdersPerSecond > 0) {
+        rateLimiter->setInstrumentRate(newLimits.maxOrdersPerSecond, newLimits.maxOrdersPerSecond);
+    }
 }
 
-bool RiskManager::checkMargin(const Order& order) {
-    // Implement margin calculation based on your specific requirements
-    return true; // Placeholder
+void RiskManager::setRiskLimits(const RiskLimits& newLimits) {
+    std::lock_guard<std::mutex> lock(limitsMutex);
+    publishLimits(newLimits);
 }
 
-bool RiskManager::checkRateLimit(const std::string& instrument) {
-    // Implement rate limiting logic
-    return true; // Placeholder
+RiskManager::RiskLimits RiskManager::getRiskLimits() const {
+    return limits.load(std::memory_order_acquire)->limits;
 }
 
-void RiskManager::updatePosition(const std::string& instrument, double amount, double price) {
-    std::lock_guard<std::mutex> lock(riskMutex);
-    
-    positions[instrument] += amount;
-    // Update average price calculation
-    double oldPosition = positions[instrument] - amount;
-    double oldAvgPrice = avgPrices[instrument];
-    
-    if (std::abs(positions[instrument]) > 0) {
-        avgPrices[instrument] = (oldPosition * oldAvgPrice + amount * price) / positions[instrument];
-    } else {
-        avgPrices[instrument] = 0;
+RuleLimits RiskManager::getRuleLimits(InstrumentClass instrumentClass) const {
+    return limits.load(std::memory_order_acquire)->rules[static_cast<size_t>(instrumentClass)];
+}
+
+std::unordered_map<std::string, double> RiskManager::getCurrentPositions() const {
+    std::unordered_map<std::string, double> result;
+    size_t count = std::min(InstrumentRegistry::instance().size(), InstrumentRegistry::MAX_INSTRUMENTS);
+    for (InstrumentId instrument = 0; instrument < count; ++instrument) {
+        double size;
+        double averagePrice;
+        if (getPosition(instrument, size, averagePrice)) {
+            result[InstrumentRegistry::instance().name(instrument).str()] = size;
+        }
     }
-}
\ No newline at end of file
+    return result;
+}
@@ -2,11 +2,25 @@
 #ifndef RISK_MANAGER_H
 #define RISK_MANAGER_H
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <mutex>
-#include "../orders/models/Order.h"
+#include <vector>
+#include "../orders/models/order.h"
+#include "../../include/SeqLock.h"
+#include "RateLimiter.h"
+#include "RiskRules.h"
 
+// Pre-trade checks run lock-free on the execution workers: per-instrument
+// state lives in cache-line slots indexed by InstrumentId, and the limits are
+// an immutable snapshot swapped in atomically, so parallel checks never
+// contend with each other or with position updates on other instruments.
+// The checks themselves are the compile-time rule pipelines in RiskRules.h,
+// picked by instrument class.
 class RiskManager {
 public:
     struct RiskLimits {
@@ -14,27 +28,123 @@ public:
         double maxPositionSize;
         double maxLeverage;
         double minMargin;
-        double maxDailyLoss;
+        double maxDailyLoss;  // USD, across all settlement currencies
         int maxOrdersPerSecond;
+        // Portfolio Greek limits in absolute value; 0 disables a limit
+        double maxPortfolioDelta = 0;
+        double maxPortfolioGamma = 0;
+        double maxPortfolioVega = 0;
+        // Initial margin all short option positions may require; 0 disables
+        double maxOptionMargin = 0;
+
+        // Per instrument class: the rules that apply (ruleBit flags), and
+        // overrides for the per-order limits above where non-zero
+        struct ClassRules {
+            uint32_t enabledRules = ALL_RISK_RULES;
+            double maxOrderSize = 0;
+            double maxPositionSize = 0;
+            double maxLeverage = 0;
+            double minMargin = 0;
+        };
+        ClassRules classRules[INSTRUMENT_CLASS_COUNT];
+    };
+
+    struct Greeks {
+        double delta = 0;
+        double gamma = 0;
+        double vega = 0;
     };
 
-    RiskManager();
-    bool validateOrder(const Order& order);
-    void updatePosition(const std::string& instrument, double amount, double price);
+    // The limiter is shared with the order path; without one, rate checks always pass
+    explicit RiskManager(RateLimiter* rateLimiter = nullptr);
+    // Runs the instrument class's rules and returns the first failure, without
+    // logging. On None the order's amount is reserved as open exposure; the
+    // caller hands it back through adjustExposure as the order fills or finishes.
+    RiskRejection checkOrder(const Order& order);
+    // Position limits apply to the worst case: the position plus every open
+    // buy, or minus every open sell. reserveExposure checks and reserves in one
+    // step, so concurrent orders cannot overshoot the limit together;
+    // adjustExposure applies unchecked changes (negative to release).
+    bool reserveExposure(InstrumentId instrument, OrderSide side, double amount);
+    void adjustExposure(InstrumentId instrument, OrderSide side, double delta);
+    void getOpenExposure(InstrumentId instrument, double& openBuys, double& openSells) const;
+    void updatePosition(InstrumentId instrument, double amount, double price);
+    // Per-unit Greeks for a batch of instruments, straight from an
+    // OptionPricer run (futures and perpetuals set their own delta); the portfolio totals move by position times the
+    // change. Orders that would push a total past its limit are rejected,
+    // unless they reduce it.
+    void updateGreeks(const InstrumentId* ids, const double* delta, const double* gamma, const double* vega,
+                      size_t count);
+    Greeks getPortfolioGreeks() const;
+    // Initial margin per unit short, from the vol surface's option marks
+    void updateMargins(const InstrumentId* ids, const double* shortMargin, size_t count);
+    double getOptionMargin() const { return optionMargin.load(std::memory_order_relaxed); }
+    // Fed by the PnL engine with the PnL since the start of the day, summed
+    // across settlement currencies in USD. Once it falls below -maxDailyLoss
+    // every new order is rejected until resetDailyLoss.
+    void reportDailyPnl(double pnl);
+    // Runs once per breach, on the thread that reported it. Published
+    // atomically, so it may be set or cleared while PnL is being reported.
+    using DailyLossCallback = std::function<void(double pnl)>;
+    void setDailyLossCallback(DailyLossCallback callback);
+    void resetDailyLoss();
+    bool isDailyLossBreached() const { return dailyLossBreached.load(std::memory_order_relaxed); }
     void setRiskLimits(const RiskLimits& limits);
+    RiskLimits getRiskLimits() const;
+    // The limits an instrument class is checked against, overrides applied
+    RuleLimits getRuleLimits(InstrumentClass instrumentClass) const;
+    // Returns false for instruments that never had a position
+    bool getPosition(InstrumentId instrument, double& size, double& averagePrice) const;
+    std::unordered_map<std::string, double> getCurrentPositions() const;
 
 private:
-    RiskLimits limits;
-    std::unordered_map<std::string, double> positions;  // instrument -> position size
-    std::unordered_map<std::string, double> avgPrices;  // instrument -> average price
-    std::mutex riskMutex;
-
-    // Risk check methods
-    bool checkOrderSize(const Order& order);
-    bool checkPositionLimit(const Order& order);
-    bool checkLeverage(const Order& order);
-    bool checkMargin(const Order& order);
-    bool checkRateLimit(const std::string& instrument);
+    struct alignas(64) InstrumentRisk {
+        // Lets readers take a consistent position and average price without blocking
+        SeqLock sequence;
+        std::atomic<double> position{0};
+        std::atomic<double> averagePrice{0};
+        std::atomic<bool> active{false};
+        // Remaining amount of open and in-flight orders per side
+        std::atomic<double> openBuys{0};
+        std::atomic<double> openSells{0};
+        // Greeks of one unit long. Options get theirs from updateGreeks;
+        // futures and perpetuals get a delta when classified: 1 for linear
+        // contracts, 1 / price for inverse ones, whose amount is in USD
+        std::atomic<double> unitDelta{0};
+        std::atomic<double> unitGamma{0};
+        std::atomic<double> unitVega{0};
+        std::atomic<double> unitMargin{0};
+        std::atomic<uint8_t> instrumentClass{UNCLASSIFIED};
+        std::atomic<bool> inverse{false};  // unitDelta follows the fill price
+    };
+
+    static constexpr uint8_t UNCLASSIFIED = 0xFF;
+
+    struct LimitSnapshot {
+        RiskLimits limits;
+        RuleLimits rules[INSTRUMENT_CLASS_COUNT];  // resolved once per publish
+    };
+
+    std::atomic<const LimitSnapshot*> limits{nullptr};
+    // Every published snapshot stays alive, since checks may still be reading
+    // an old one; limits change rarely. Guarded by limitsMutex.
+    std::vector<std::unique_ptr<const LimitSnapshot>> limitSnapshots;
+    mutable std::mutex limitsMutex;
+
+    RateLimiter* rateLimiter;
+    std::atomic<bool> dailyLossBreached{false};
+    std::atomic<std::shared_ptr<const DailyLossCallback>> dailyLossCallback;
+    std::atomic<double> portfolioDelta{0};
+    std::atomic<double> portfolioGamma{0};
+    std::atomic<double> portfolioVega{0};
+    std::atomic<double> optionMargin{0};
+    // Indexed by InstrumentId
+    std::unique_ptr<InstrumentRisk[]> instruments;
+
+    InstrumentClass classOf(InstrumentId instrument);
+    void setUnitDelta(InstrumentRisk& slot, double unitDelta);
+    static bool reserve(InstrumentRisk& slot, OrderSide side, double amount, double maxPosition);
+    void publishLimits(const RiskLimits& limits);
 };
 
-#endif
\ No newline at end of file
+#endif
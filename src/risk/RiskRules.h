@@ -0,0 +1,156 @@
+// risk/RiskRules.h
+#ifndef RISK_RULES_H
+#define RISK_RULES_H
+
+#include "RateLimiter.h"
+#include "../orders/models/order.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// Why an order failed the pre-trade checks. Each value is also the rule's bit
+// in RuleLimits::enabledRules, and when several rules fail the lowest value
+// is reported.
+enum class RiskRejection : uint8_t {
+    None,
+    UnknownInstrument,
+    DailyLossLimit,
+    OrderSize,
+    Leverage,
+    Margin,
+    GreekLimits,
+    RateLimit,
+    PositionLimit
+};
+
+inline const char* toString(RiskRejection rejection) {
+    switch (rejection) {
+        case RiskRejection::None: return "None";
+        case RiskRejection::UnknownInstrument: return "Unknown instrument";
+        case RiskRejection::DailyLossLimit: return "Daily loss limit reached";
+        case RiskRejection::OrderSize: return "Exceeds maximum order size";
+        case RiskRejection::Leverage: return "Would exceed leverage limit";
+        case RiskRejection::Margin: return "Insufficient margin";
+        case RiskRejection::GreekLimits: return "Would exceed Greek limits";
+        case RiskRejection::RateLimit: return "Rate limit exceeded";
+        case RiskRejection::PositionLimit: return "Would exceed position limit";
+        default: return "Unknown";
+    }
+}
+
+constexpr uint32_t ruleBit(RiskRejection rule) {
+    return 1u << static_cast<unsigned>(rule);
+}
+
+constexpr uint32_t ALL_RISK_RULES = ~0u;
+
+// The limits one instrument class is checked against
+struct RuleLimits {
+    uint32_t enabledRules = ALL_RISK_RULES;
+    double maxOrderSize = 0;
+    double maxPositionSize = 0;
+    double maxLeverage = 0;
+    double minMargin = 0;
+    double maxPortfolioDelta = 0;
+    double maxPortfolioGamma = 0;
+    double maxPortfolioVega = 0;
+    double maxOptionMargin = 0;
+};
+
+// Everything the rules read, loaded once per check
+struct RuleContext {
+    const Order& order;
+    const RuleLimits& limits;
+    double signedAmount;  // positive for buys
+    double position;
+    double unitDelta;
+    double unitGamma;
+    double unitVega;
+    double unitMargin;
+    double portfolioDelta;
+    double portfolioGamma;
+    double portfolioVega;
+    double optionMargin;
+    bool dailyLossBreached;
+    const RateLimiter* rateLimiter;
+};
+
+// Passes moves that stay within the limit or end closer to zero; a limit of 0 is off
+inline bool withinRiskLimit(double current, double change, double limit) {
+    double next = current + change;
+    return limit <= 0 || std::abs(next) <= limit || std::abs(next) <= std::abs(current);
+}
+
+// Rules are side-effect free: CODE names the rule, passes() decides
+
+struct DailyLossRule {
+    static constexpr RiskRejection CODE = RiskRejection::DailyLossLimit;
+    static bool passes(const RuleContext& context) { return !context.dailyLossBreached; }
+};
+
+struct OrderSizeRule {
+    static constexpr RiskRejection CODE = RiskRejection::OrderSize;
+    static bool passes(const RuleContext& context) { return context.order.amount <= context.limits.maxOrderSize; }
+};
+
+// The order's notional must carry at least minMargin at maxLeverage
+struct LeverageRule {
+    static constexpr RiskRejection CODE = RiskRejection::Leverage;
+    static bool passes(const RuleContext& context) {
+        return context.order.amount * context.order.price >= context.limits.minMargin * context.limits.maxLeverage;
+    }
+};
+
+// Short option margin as if the order filled now; resting orders are not counted
+struct MarginRule {
+    static constexpr RiskRejection CODE = RiskRejection::Margin;
+    static bool passes(const RuleContext& context) {
+        double next = context.position + context.signedAmount;
+        double change = (std::fmax(0.0, -next) - std::fmax(0.0, -context.position)) * context.unitMargin;
+        return withinRiskLimit(context.optionMargin, change, context.limits.maxOptionMargin);
+    }
+};
+
+struct GreekLimitRule {
+    static constexpr RiskRejection CODE = RiskRejection::GreekLimits;
+    static bool passes(const RuleContext& context) {
+        const RuleLimits& limits = context.limits;
+        // Non-short-circuiting: all three are cheap and it keeps the rule branch-free
+        return withinRiskLimit(context.portfolioDelta, context.signedAmount * context.unitDelta,
+                               limits.maxPortfolioDelta) &
+               withinRiskLimit(context.portfolioGamma, context.signedAmount * context.unitGamma,
+                               limits.maxPortfolioGamma) &
+               withinRiskLimit(context.portfolioVega, context.signedAmount * context.unitVega,
+                               limits.maxPortfolioVega);
+    }
+};
+
+// Peek only; the order path spends the credits when the request is sent
+struct RateLimitRule {
+    static constexpr RiskRejection CODE = RiskRejection::RateLimit;
+    static bool passes(const RuleContext& context) {
+        return !context.rateLimiter || !context.rateLimiter->wouldExceed(context.order.instrumentId);
+    }
+};
+
+// Composes rules at compile time into one check. Every rule is evaluated,
+// with no branch between them, into a bitmask of failures; rules disabled for
+// the instrument class are masked out and the lowest failing code wins.
+template <typename... Rules>
+struct RiskPipeline {
+    static constexpr uint32_t RULES = (0u | ... | ruleBit(Rules::CODE));
+
+    static RiskRejection check(const RuleContext& context) {
+        uint32_t failed = (0u | ... | (Rules::passes(context) ? 0u : ruleBit(Rules::CODE)));
+        failed &= context.limits.enabledRules;
+        return failed ? static_cast<RiskRejection>(__builtin_ctz(failed)) : RiskRejection::None;
+    }
+};
+
+// Linear contracts are limited by notional; an option's premium says nothing
+// about leverage, so options are held to margin instead. The position limit
+// is not a rule: it reserves exposure, and runs after the pipeline passes.
+using LinearRiskRules = RiskPipeline<DailyLossRule, OrderSizeRule, LeverageRule, GreekLimitRule, RateLimitRule>;
+using OptionRiskRules = RiskPipeline<DailyLossRule, OrderSizeRule, MarginRule, GreekLimitRule, RateLimitRule>;
+
+#endif
@@ -0,0 +1,648 @@
+#include "VolSurface.h"
+#include "../market/MarketDataManager.h"
+#include "../websockets/WebSocketServer.h"
+#include "../include/Logger.h"
+#include <json/json.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+namespace {
+
+constexpr double MS_PER_YEAR = 365.0 * 24 * 3600 * 1000;
+constexpr size_t MAX_SOLVER_ITERATIONS = 64;
+// Relative to the forward; the vector pricer is accurate to about 1e-7
+constexpr double PRICE_TOLERANCE = 1e-8;
+constexpr double VOLATILITY_TOLERANCE = 1e-6;
+constexpr double INITIAL_VOLATILITY = 0.5;
+// Below this a Newton step is meaningless and the solver bisects
+constexpr double MIN_VEGA = 1e-12;
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+int64_t daysFromCivil(int64_t year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+    unsigned dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<int64_t>(dayOfEra) - 719468;
+}
+
+// Deribit expiry codes such as 7JUN24 or 27DEC24; contracts expire at 08:00 UTC
+bool parseExpiry(std::string_view code, int64_t& expiry) {
+    static const char* const MONTHS[] = {"JAN", "FEB", "MAR", "APR", "MAY", "JUN",
+                                         "JUL", "AUG", "SEP", "OCT", "NOV", "DEC"};
+    size_t digits = 0;
+    while (digits < code.size() && digits < 2 && code[digits] >= '0' && code[digits] <= '9') {
+        ++digits;
+    }
+    if (digits == 0 || code.size() != digits + 5) {
+        return false;
+    }
+    unsigned day = std::atoi(std::string(code.substr(0, digits)).c_str());
+    std::string_view monthCode = code.substr(digits, 3);
+    std::string_view yearCode = code.substr(digits + 3);
+    if (yearCode[0] < '0' || yearCode[0] > '9' || yearCode[1] < '0' || yearCode[1] > '9') {
+        return false;
+    }
+    auto month = std::find_if(std::begin(MONTHS), std::end(MONTHS),
+                              [monthCode](const char* name) { return monthCode == name; });
+    if (month == std::end(MONTHS) || day < 1 || day > 31) {
+        return false;
+    }
+    int64_t year = 2000 + (yearCode[0] - '0') * 10 + (yearCode[1] - '0');
+    int64_t days = daysFromCivil(year, static_cast<unsigned>(month - std::begin(MONTHS)) + 1, day);
+    expiry = (days * 86400 + 8 * 3600) * 1000;
+    return true;
+}
+
+// Strikes use 'd' as the decimal point: 0d625
+bool parseStrike(std::string_view code, double& strike) {
+    std::string text(code);
+    std::replace(text.begin(), text.end(), 'd', '.');
+    char* end = nullptr;
+    strike = std::strtod(text.c_str(), &end);
+    return !text.empty() && end == text.c_str() + text.size() && strike > 0;
+}
+
+int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Solves the 3x3 system in place by Gaussian elimination with partial pivoting
+bool solve3(double a[3][3], double b[3], double x[3]) {
+    for (int column = 0; column < 3; ++column) {
+        int pivot = column;
+        for (int row = column + 1; row < 3; ++row) {
+            if (std::abs(a[row][column]) > std::abs(a[pivot][column])) {
+                pivot = row;
+            }
+        }
+        if (std::abs(a[pivot][column]) < 1e-14) {
+            return false;
+        }
+        std::swap(a[column], a[pivot]);
+        std::swap(b[column], b[pivot]);
+        for (int row = column + 1; row < 3; ++row) {
+            double factor = a[row][column] / a[column][column];
+            for (int k = column; k < 3; ++k) {
+                a[row][k] -= factor * a[column][k];
+            }
+            b[row] -= factor * b[column];
+        }
+    }
+    for (int row = 2; row >= 0; --row) {
+        double sum = b[row];
+        for (int k = row + 1; k < 3; ++k) {
+            sum -= a[row][k] * x[k];
+        }
+        x[row] = sum / a[row][row];
+    }
+    return true;
+}
+
+}
+
+double VolSurface::Smile::volatility(double strike) const {
+    double k = std::log(strike / forward);
+    return atmVolatility + skew * k + curvature * k * k;
+}
+
+VolSurface::VolSurface(RiskManager& riskManager) : VolSurface(riskManager, Options()) {}
+
+VolSurface::VolSurface(RiskManager& riskManager, const Options& options)
+    : riskManager(riskManager),
+      options(options),
+      slots(std::make_unique<Slot[]>(InstrumentRegistry::MAX_INSTRUMENTS)) {
+    size_t threads = options.fitThreads ? options.fitThreads : std::max(1u, std::thread::hardware_concurrency());
+    // The refreshing thread is one of them
+    for (size_t i = 1; i < threads; ++i) {
+        fitWorkers.emplace_back(&VolSurface::fitWorkerLoop, this);
+    }
+}
+
+VolSurface::~VolSurface() {
+    if (attachedTo) {
+        attachedTo->removeBookUpdateListener(bookListener);
+    }
+    stopPublishing();
+    {
+        std::lock_guard<std::mutex> lock(fitMutex);
+        fitStopping = true;
+    }
+    fitCV.notify_all();
+    for (std::thread& worker : fitWorkers) {
+        worker.join();
+    }
+}
+
+void VolSurface::attach(MarketDataManager& marketDataManager) {
+    attachedTo = &marketDataManager;
+    bookListener = marketDataManager.addBookUpdateListener([this](InstrumentId instrument, const OrderBook& book) {
+        onQuote(instrument, book.getBestBid(), book.getBestAsk());
+    });
+}
+
+std::atomic<double>& VolSurface::perpetualMidFor(const std::string& underlying) {
+    // Called with expiriesMutex held
+    auto& mid = perpetualMids[underlying];
+    if (!mid) {
+        mid = std::make_unique<std::atomic<double>>(0);
+    }
+    return *mid;
+}
+
+VolSurface::Expiry& VolSurface::expiryFor(const std::string& underlying, int64_t expiry, bool inverse) {
+    std::lock_guard<std::mutex> lock(expiriesMutex);
+    auto& entry = expiries[{underlying, expiry}];
+    if (!entry) {
+        entry = std::make_unique<Expiry>(underlying, expiry, inverse, &perpetualMidFor(underlying));
+    }
+    return *entry;
+}
+
+void VolSurface::classify(InstrumentId instrument, Slot& slot) {
+    std::string_view name = InstrumentRegistry::instance().name(instrument).view();
+    std::vector<std::string_view> parts;
+    for (size_t start = 0;;) {
+        size_t dash = name.find('-', start);
+        parts.push_back(name.substr(start, dash - start));
+        if (dash == std::string_view::npos) {
+            break;
+        }
+        start = dash + 1;
+    }
+
+    slot.kind = Kind::Other;
+    std::string underlying(parts[0]);
+    // BTC options are quoted in BTC, BTC_USDC ones in USDC
+    bool inverse = underlying.find('_') == std::string::npos;
+    int64_t expiry;
+    double strike;
+    bool call = parts.size() == 4 && parts[3] == "C";
+    bool parsed = parts.size() == 4 && parseExpiry(parts[1], expiry) && parseStrike(parts[2], strike) &&
+                  (call || parts[3] == "P");
+
+    // Reference data is authoritative where loaded; combos have no single strike
+    const InstrumentInfo* info = InstrumentRegistry::instance().info(instrument);
+    if (info && info->instrumentClass == InstrumentClass::Option && parts.size() == 4) {
+        inverse = info->settlementCurrency == info->baseCurrency.view();
+        expiry = info->expiry;
+        strike = info->strike;
+        call = info->call;
+        parsed = expiry > 0 && strike > 0;
+    } else if (info && info->instrumentClass == InstrumentClass::Future && parts.size() == 2) {
+        inverse = info->settlementCurrency == info->baseCurrency.view();
+    }
+
+    if (parts.size() == 2 && parts[1] == "PERPETUAL") {
+        std::lock_guard<std::mutex> lock(expiriesMutex);
+        slot.perpetualMid = &perpetualMidFor(underlying);
+        slot.kind = Kind::Perpetual;
+    } else if (parts.size() == 2 && parseExpiry(parts[1], expiry)) {
+        slot.kind = Kind::Future;
+        slot.expiry.store(&expiryFor(underlying, expiry, inverse), std::memory_order_release);
+    } else if (parsed) {
+        Expiry& target = expiryFor(underlying, expiry, inverse);
+        {
+            std::lock_guard<std::mutex> lock(target.mutex);
+            slot.strikeIndex = static_cast<uint32_t>(target.options.size());
+            target.options.push_back(instrument);
+            target.strikes.push_back(strike);
+            target.calls.push_back(call);
+            target.mid.push_back(0);
+            target.dirty.push_back(0);
+            target.impliedVolatility.push_back(0);
+        }
+        slot.kind = Kind::Option;
+        slot.expiry.store(&target, std::memory_order_release);
+    }
+}
+
+void VolSurface::onQuote(InstrumentId instrument, double bestBid, double bestAsk) {
+    if (instrument >= InstrumentRegistry::MAX_INSTRUMENTS) {
+        return;
+    }
+    Slot& slot = slots[instrument];
+    if (slot.kind == Kind::Unknown) {
+        classify(instrument, slot);
+    }
+    double mid = bestBid > 0 && bestAsk > 0 ? (bestBid + bestAsk) / 2 : 0;
+
+    switch (slot.kind) {
+        case Kind::Perpetual:
+            if (mid > 0) {
+                slot.perpetualMid->store(mid, std::memory_order_relaxed);
+            }
+            break;
+        case Kind::Future: {
+            Expiry& expiry = *slot.expiry.load(std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(expiry.mutex);
+            expiry.futureMid = mid;
+            break;
+        }
+        case Kind::Option: {
+            Expiry& expiry = *slot.expiry.load(std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(expiry.mutex);
+            // Depth-only updates leave the mid unchanged and cost no re-solve
+            if (expiry.mid[slot.strikeIndex] != mid) {
+                expiry.mid[slot.strikeIndex] = mid;
+                expiry.dirty[slot.strikeIndex] = 1;
+                expiry.anyDirty = true;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+size_t VolSurface::refresh() {
+    return refresh(nullptr);
+}
+
+size_t VolSurface::refresh(std::vector<Expiry*>* changed) {
+    std::lock_guard<std::mutex> refreshLock(refreshMutex);
+    std::vector<Expiry*> batch;
+    {
+        std::lock_guard<std::mutex> lock(expiriesMutex);
+        for (auto& entry : expiries) {
+            batch.push_back(entry.second.get());
+        }
+    }
+    if (batch.empty()) {
+        return 0;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(fitMutex);
+        fitDoneCV.wait(lock, [this]() { return fitActive == 0; });
+        fitBatch = std::move(batch);
+        fitChanged.assign(fitBatch.size(), 0);
+        fitNext.store(0, std::memory_order_relaxed);
+        ++fitGeneration;
+    }
+    // Expiries with nothing to do return at once, so the pool only spreads real work
+    if (!fitWorkers.empty()) {
+        fitCV.notify_all();
+    }
+    drainFitBatch();
+    std::unique_lock<std::mutex> lock(fitMutex);
+    fitDoneCV.wait(lock, [this]() { return fitActive == 0; });
+
+    size_t count = 0;
+    for (size_t i = 0; i < fitBatch.size(); ++i) {
+        if (fitChanged[i]) {
+            ++count;
+            if (changed) {
+                changed->push_back(fitBatch[i]);
+            }
+        }
+    }
+    return count;
+}
+
+void VolSurface::drainFitBatch() {
+    size_t count = fitBatch.size();
+    for (size_t i = fitNext.fetch_add(1, std::memory_order_relaxed); i < count;
+         i = fitNext.fetch_add(1, std::memory_order_relaxed)) {
+        try {
+            fitChanged[i] = refreshExpiry(*fitBatch[i]);
+        } catch (const std::exception& e) {
+            Logger::error("Error refreshing ", fitBatch[i]->underlying, " volatility: ", e.what());
+        }
+    }
+}
+
+void VolSurface::fitWorkerLoop() {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(fitMutex);
+    while (true) {
+        fitCV.wait(lock, [this, &seen]() { return fitStopping || fitGeneration != seen; });
+        if (fitStopping) {
+            return;
+        }
+        seen = fitGeneration;
+        ++fitActive;
+        lock.unlock();
+        drainFitBatch();
+        lock.lock();
+        if (--fitActive == 0) {
+            fitDoneCV.notify_all();
+        }
+    }
+}
+
+bool VolSurface::refreshExpiry(Expiry& expiry) {
+    double timeToExpiry = (expiry.expiry - nowMs()) / MS_PER_YEAR;
+    if (timeToExpiry <= 0) {
+        return false;
+    }
+    auto now = std::chrono::steady_clock::now();
+
+    std::vector<uint32_t> strikes;
+    std::vector<double> targets;
+    std::vector<double> volatility;
+    double forward;
+    {
+        std::lock_guard<std::mutex> lock(expiry.mutex);
+        forward = expiry.futureMid > 0 ? expiry.futureMid : expiry.perpetualMid->load(std::memory_order_relaxed);
+        if (forward <= 0) {
+            return false;
+        }
+        bool full = std::abs(forward - expiry.solvedForward) > options.forwardTolerance * forward ||
+                    now - expiry.solvedAt > options.maxStaleness || expiry.chain.size() < expiry.options.size();
+        if (!full && !expiry.anyDirty) {
+            return false;
+        }
+
+        for (size_t i = expiry.chain.size(); i < expiry.options.size(); ++i) {
+            expiry.chain.add(expiry.options[i], expiry.strikes[i], timeToExpiry, expiry.calls[i]);
+            expiry.vega.push_back(0);
+            expiry.shortMargin.push_back(0);
+        }
+        volatility = expiry.impliedVolatility;
+        for (uint32_t i = 0; i < expiry.options.size(); ++i) {
+            if (!full && !expiry.dirty[i]) {
+                continue;
+            }
+            expiry.dirty[i] = 0;
+            if (expiry.mid[i] > 0) {
+                strikes.push_back(i);
+                targets.push_back(expiry.inverse ? expiry.mid[i] * forward : expiry.mid[i]);
+            } else {
+                volatility[i] = 0;
+            }
+        }
+        expiry.anyDirty = false;
+        if (full) {
+            expiry.solvedForward = forward;
+            expiry.solvedAt = now;
+        }
+    }
+
+    solve(expiry, strikes, targets, forward, timeToExpiry, volatility);
+    fit(expiry, forward, timeToExpiry, volatility);
+    return true;
+}
+
+// Newton's method on all strikes at once, one vector pricing pass per step.
+// Each strike keeps a bracket that every priced guess narrows, and a step
+// that would leave the bracket or has no vega to work with bisects instead,
+// so every quote inside the no-arbitrage bounds converges.
+void VolSurface::solve(Expiry& expiry, const std::vector<uint32_t>& strikes, const std::vector<double>& targets,
+                       double forward, double timeToExpiry, std::vector<double>& volatility) {
+    if (strikes.empty()) {
+        return;
+    }
+    OptionChain scratch;
+    std::vector<double> low(strikes.size(), options.minVolatility);
+    std::vector<double> high(strikes.size(), options.maxVolatility);
+    std::vector<uint8_t> active(strikes.size(), 1);
+    double discount = std::exp(-options.rate * timeToExpiry);
+    size_t remaining = strikes.size();
+
+    for (size_t j = 0; j < strikes.size(); ++j) {
+        uint32_t i = strikes[j];
+        double strike = expiry.chain.strike[i];
+        double callPut = expiry.chain.callPut[i];
+        scratch.add(expiry.chain.instruments[i], strike, timeToExpiry, callPut > 0);
+        scratch.forward[j] = forward;
+        scratch.rate[j] = options.rate;
+        double guess = volatility[i] > 0 ? volatility[i] :
+                       expiry.smile.points > 0 ? expiry.smile.volatility(strike) : INITIAL_VOLATILITY;
+        scratch.volatility[j] = std::clamp(guess, options.minVolatility, options.maxVolatility);
+
+        double intrinsic = discount * std::max(0.0, callPut * (forward - strike));
+        double upper = discount * (callPut > 0 ? forward : strike);
+        if (targets[j] <= intrinsic || targets[j] >= upper) {
+            active[j] = 0;
+            volatility[i] = 0;
+            --remaining;
+        }
+    }
+
+    auto finish = [&](size_t j, double solution) {
+        uint32_t i = strikes[j];
+        bool bounded = solution > options.minVolatility * (1 + VOLATILITY_TOLERANCE) &&
+                       solution < options.maxVolatility * (1 - VOLATILITY_TOLERANCE);
+        volatility[i] = bounded ? solution : 0;
+        expiry.vega[i] = scratch.vega[j];
+        active[j] = 0;
+        --remaining;
+    };
+
+    for (size_t iteration = 0; iteration < MAX_SOLVER_ITERATIONS && remaining > 0; ++iteration) {
+        pricer.price(scratch);
+        for (size_t j = 0; j < strikes.size(); ++j) {
+            if (!active[j]) {
+                continue;
+            }
+            double current = scratch.volatility[j];
+            double error = scratch.price[j] - targets[j];
+            if (std::abs(error) <= PRICE_TOLERANCE * forward || high[j] - low[j] <= VOLATILITY_TOLERANCE) {
+                finish(j, current);
+                continue;
+            }
+            (error > 0 ? high[j] : low[j]) = current;
+            double next = scratch.vega[j] > MIN_VEGA ? current - error / scratch.vega[j] : low[j];
+            if (!(next > low[j] && next < high[j])) {
+                next = (low[j] + high[j]) / 2;
+            }
+            if (std::abs(next - current) <= VOLATILITY_TOLERANCE) {
+                finish(j, next);
+                continue;
+            }
+            scratch.volatility[j] = next;
+        }
+    }
+    for (size_t j = 0; j < strikes.size(); ++j) {
+        if (active[j]) {
+            volatility[strikes[j]] = 0;
+        }
+    }
+}
+
+// Vega-weighted least squares of sigma against k = ln(K / F) over the
+// out-of-the-money strikes, which carry the liquid quotes. The smile then
+// prices the whole chain for the RiskManager.
+void VolSurface::fit(Expiry& expiry, double forward, double timeToExpiry, const std::vector<double>& volatility) {
+    OptionChain& chain = expiry.chain;
+    double normal[3][3] = {};
+    double rhs[3] = {};
+    size_t points = 0;
+    for (size_t i = 0; i < chain.size(); ++i) {
+        bool outOfTheMoney = chain.callPut[i] > 0 ? chain.strike[i] >= forward : chain.strike[i] < forward;
+        if (volatility[i] <= 0 || !outOfTheMoney) {
+            continue;
+        }
+        double k = std::log(chain.strike[i] / forward);
+        double weight = std::max(expiry.vega[i], MIN_VEGA);
+        double basis[3] = {1, k, k * k};
+        for (int row = 0; row < 3; ++row) {
+            for (int column = 0; column < 3; ++column) {
+                normal[row][column] += weight * basis[row] * basis[column];
+            }
+            rhs[row] += weight * basis[row] * volatility[i];
+        }
+        ++points;
+    }
+
+    Smile smile;
+    smile.underlying = expiry.underlying;
+    smile.expiry = expiry.expiry;
+    smile.forward = forward;
+    smile.timeToExpiry = timeToExpiry;
+    smile.points = points;
+    double coefficients[3] = {};
+    if (points >= 3 && solve3(normal, rhs, coefficients)) {
+        smile.atmVolatility = coefficients[0];
+        smile.skew = coefficients[1];
+        smile.curvature = coefficients[2];
+    } else if (points > 0) {
+        // Too few strikes for a shape: flat at the weighted mean
+        smile.atmVolatility = rhs[0] / normal[0][0];
+    }
+
+    if (points > 0) {
+        for (size_t i = 0; i < chain.size(); ++i) {
+            chain.forward[i] = forward;
+            chain.timeToExpiry[i] = timeToExpiry;
+            chain.rate[i] = options.rate;
+            chain.volatility[i] = std::clamp(smile.volatility(chain.strike[i]), options.minVolatility,
+                                             options.maxVolatility);
+        }
+        pricer.price(chain);
+        // Deribit's short option margin: max(15% - OTM fraction, 10%) of the underlying plus the mark
+        for (size_t i = 0; i < chain.size(); ++i) {
+            double outOfTheMoney = std::max(0.0, chain.callPut[i] * (chain.strike[i] - forward));
+            expiry.shortMargin[i] = chain.price[i] + forward * std::max(0.15 - outOfTheMoney / forward, 0.10);
+        }
+        riskManager.updateGreeks(chain.instruments.data(), chain.delta.data(), chain.gamma.data(),
+                                 chain.vega.data(), chain.size());
+        riskManager.updateMargins(chain.instruments.data(), expiry.shortMargin.data(), chain.size());
+    }
+
+    std::lock_guard<std::mutex> lock(expiry.mutex);
+    std::copy(volatility.begin(), volatility.end(), expiry.impliedVolatility.begin());
+    expiry.smile = smile;
+}
+
+bool VolSurface::getImpliedVolatility(InstrumentId option, double& volatility) const {
+    if (option >= InstrumentRegistry::MAX_INSTRUMENTS) {
+        return false;
+    }
+    const Slot& slot = slots[option];
+    const Expiry* expiry = slot.expiry.load(std::memory_order_acquire);
+    if (!expiry || slot.kind != Kind::Option) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(expiry->mutex);
+    volatility = expiry->impliedVolatility[slot.strikeIndex];
+    return volatility > 0;
+}
+
+bool VolSurface::getVolatility(const std::string& underlying, int64_t expiry, double strike,
+                               double& volatility) const {
+    const Expiry* entry;
+    {
+        std::lock_guard<std::mutex> lock(expiriesMutex);
+        auto found = expiries.find({underlying, expiry});
+        if (found == expiries.end()) {
+            return false;
+        }
+        entry = found->second.get();
+    }
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    if (entry->smile.points == 0 || strike <= 0) {
+        return false;
+    }
+    volatility = std::clamp(entry->smile.volatility(strike), options.minVolatility, options.maxVolatility);
+    return true;
+}
+
+std::vector<VolSurface::Smile> VolSurface::getSmiles() const {
+    std::vector<Smile> result;
+    std::lock_guard<std::mutex> lock(expiriesMutex);
+    for (const auto& entry : expiries) {
+        std::lock_guard<std::mutex> expiryLock(entry.second->mutex);
+        if (entry.second->smile.points > 0) {
+            result.push_back(entry.second->smile);
+        }
+    }
+    return result;
+}
+
+std::string VolSurface::snapshotJson(const std::vector<Expiry*>& changed) const {
+    Json::Value root;
+    root["type"] = "vol_surface";
+    root["expiries"] = Json::arrayValue;
+    for (const Expiry* expiry : changed) {
+        std::lock_guard<std::mutex> lock(expiry->mutex);
+        const Smile& smile = expiry->smile;
+        Json::Value entry;
+        entry["underlying"] = smile.underlying;
+        entry["expiry"] = Json::Int64(smile.expiry);
+        entry["forward"] = smile.forward;
+        entry["time_to_expiry"] = smile.timeToExpiry;
+        entry["atm_vol"] = smile.atmVolatility;
+        entry["skew"] = smile.skew;
+        entry["curvature"] = smile.curvature;
+        entry["strikes"] = Json::arrayValue;
+        for (size_t i = 0; i < expiry->impliedVolatility.size(); ++i) {
+            if (expiry->impliedVolatility[i] <= 0) {
+                continue;
+            }
+            Json::Value strike;
+            strike["instrument"] = InstrumentRegistry::instance().name(expiry->options[i]).str();
+            strike["iv"] = expiry->impliedVolatility[i];
+            entry["strikes"].append(strike);
+        }
+        root["expiries"].append(entry);
+    }
+
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "";
+    return Json::writeString(writer, root);
+}
+
+void VolSurface::startPublishing(WebSocketServer& server, std::chrono::milliseconds interval) {
+    stopPublishing();
+    publishing = true;
+    publishThread = std::thread(&VolSurface::publishLoop, this, std::ref(server), interval);
+}
+
+void VolSurface::stopPublishing() {
+    {
+        std::lock_guard<std::mutex> lock(publishMutex);
+        publishing = false;
+    }
+    publishCV.notify_all();
+    if (publishThread.joinable()) {
+        publishThread.join();
+    }
+}
+
+void VolSurface::publishLoop(WebSocketServer& server, std::chrono::milliseconds interval) {
+    std::unique_lock<std::mutex> lock(publishMutex);
+    while (publishing) {
+        publishCV.wait_for(lock, interval, [this]() { return !publishing; });
+        if (!publishing) {
+            break;
+        }
+
+        lock.unlock();
+        try {
+            std::vector<Expiry*> changed;
+            if (refresh(&changed) > 0) {
+                server.broadcastToSubscribers("vol_surface", snapshotJson(changed));
+            }
+        } catch (const std::exception& e) {
+            Logger::error("Error publishing volatility surface: ", e.what());
+        }
+        lock.lock();
+    }
+}
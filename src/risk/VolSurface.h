@@ -0,0 +1,169 @@
+// risk/VolSurface.h
+#ifndef VOL_SURFACE_H
+#define VOL_SURFACE_H
+
+#include "OptionPricer.h"
+#include "RiskManager.h"
+#include "../market/InstrumentRegistry.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class MarketDataManager;
+class WebSocketServer;
+
+// Implied volatility surface built from the local option books. Quotes mark
+// their strike dirty; refresh() re-solves only dirty strikes, warm-started
+// from their last volatility, and re-fits only the expiries that changed,
+// spread across a small pool of threads. Each fitted expiry re-prices its
+// chain off the smile and hands the Greeks and short-option margins to the
+// RiskManager.
+//
+// Forwards come from the expiry's future (BTC-27DEC24) when its book is
+// live, otherwise from the perpetual (BTC-PERPETUAL).
+class VolSurface {
+public:
+    struct Options {
+        size_t fitThreads = 0;    // 0: one per core, never more than there are expiries
+        double rate = 0;          // discount rate for every expiry
+        double minVolatility = 0.01;
+        double maxVolatility = 5.0;
+        // A forward move beyond this fraction re-solves the whole expiry
+        double forwardTolerance = 1e-4;
+        // Expiries are re-solved in full at least this often, as time decays
+        std::chrono::milliseconds maxStaleness{10000};
+    };
+
+    // sigma(k) = atmVolatility + skew * k + curvature * k^2, k = ln(strike / forward)
+    struct Smile {
+        std::string underlying;
+        int64_t expiry = 0;  // ms since epoch
+        double forward = 0;
+        double timeToExpiry = 0;
+        double atmVolatility = 0;
+        double skew = 0;
+        double curvature = 0;
+        size_t points = 0;  // strikes in the fit, 0 when not fitted
+
+        double volatility(double strike) const;
+    };
+
+    explicit VolSurface(RiskManager& riskManager);
+    VolSurface(RiskManager& riskManager, const Options& options);
+    ~VolSurface();
+
+    // Feeds top of book for options, futures and perpetuals from every book update
+    void attach(MarketDataManager& marketDataManager);
+    // Prices as quoted: options on inverse underlyings (BTC) in the
+    // underlying, linear ones (BTC_USDC) in the quote currency
+    void onQuote(InstrumentId instrument, double bestBid, double bestAsk);
+
+    // Re-solves dirty strikes and re-fits their expiries; returns how many
+    // expiries changed
+    size_t refresh();
+
+    // False until the strike has a valid implied volatility
+    bool getImpliedVolatility(InstrumentId option, double& volatility) const;
+    // Volatility from the fitted smile, for any strike of a known expiry
+    bool getVolatility(const std::string& underlying, int64_t expiry, double strike, double& volatility) const;
+    std::vector<Smile> getSmiles() const;
+
+    // Refreshes every interval and broadcasts the expiries that changed to
+    // the server's "vol_surface" subscribers
+    void startPublishing(WebSocketServer& server, std::chrono::milliseconds interval = std::chrono::milliseconds(100));
+    void stopPublishing();
+
+private:
+    struct Expiry {
+        std::string underlying;
+        int64_t expiry;
+        bool inverse;  // premiums quoted in the underlying
+        std::atomic<double>* perpetualMid;
+
+        mutable std::mutex mutex;
+        // Written by the feed. Strikes are only ever appended.
+        std::vector<InstrumentId> options;
+        std::vector<double> strikes;
+        std::vector<uint8_t> calls;
+        std::vector<double> mid;  // 0 without a two-sided quote
+        std::vector<uint8_t> dirty;
+        bool anyDirty = false;
+        double futureMid = 0;
+        // Written by refresh, read under mutex by everyone else
+        std::vector<double> impliedVolatility;  // 0 where there is no solution
+        Smile smile;
+
+        // Only touched by the thread refreshing this expiry
+        double solvedForward = 0;
+        std::chrono::steady_clock::time_point solvedAt;
+        OptionChain chain;  // strikes in the same order as options
+        std::vector<double> vega;  // at the implied volatility, weights the fit
+        AlignedDoubles shortMargin;
+
+        Expiry(std::string underlying, int64_t expiry, bool inverse, std::atomic<double>* perpetualMid)
+            : underlying(std::move(underlying)), expiry(expiry), inverse(inverse), perpetualMid(perpetualMid) {}
+    };
+
+    enum class Kind : uint8_t { Unknown, Option, Future, Perpetual, Other };
+
+    struct Slot {
+        std::atomic<Expiry*> expiry{nullptr};
+        uint32_t strikeIndex = 0;
+        Kind kind = Kind::Unknown;  // parsed once, on the first quote
+        std::atomic<double>* perpetualMid = nullptr;
+    };
+
+    RiskManager& riskManager;
+    Options options;
+    MarketDataManager* attachedTo = nullptr;
+    uint64_t bookListener = 0;
+    OptionPricer pricer;
+    std::unique_ptr<Slot[]> slots;  // indexed by InstrumentId
+
+    // Expiries never move or go away once created
+    std::map<std::pair<std::string, int64_t>, std::unique_ptr<Expiry>> expiries;
+    std::map<std::string, std::unique_ptr<std::atomic<double>>> perpetualMids;  // by underlying
+    mutable std::mutex expiriesMutex;
+
+    // Fit pool: refresh() posts a batch and works on it alongside the pool
+    std::vector<std::thread> fitWorkers;
+    std::mutex fitMutex;
+    std::condition_variable fitCV;
+    std::condition_variable fitDoneCV;
+    std::vector<Expiry*> fitBatch;
+    std::vector<uint8_t> fitChanged;  // per batch entry
+    std::atomic<size_t> fitNext{0};
+    size_t fitActive = 0;  // pool threads inside the current batch
+    uint64_t fitGeneration = 0;
+    bool fitStopping = false;
+    std::mutex refreshMutex;  // one refresh at a time
+
+    std::thread publishThread;
+    std::mutex publishMutex;
+    std::condition_variable publishCV;
+    bool publishing = false;
+
+    void classify(InstrumentId instrument, Slot& slot);
+    Expiry& expiryFor(const std::string& underlying, int64_t expiry, bool inverse);
+    std::atomic<double>& perpetualMidFor(const std::string& underlying);
+    size_t refresh(std::vector<Expiry*>* changed);
+    bool refreshExpiry(Expiry& expiry);
+    void solve(Expiry& expiry, const std::vector<uint32_t>& strikes, const std::vector<double>& targets,
+               double forward, double timeToExpiry, std::vector<double>& volatility);
+    void fit(Expiry& expiry, double forward, double timeToExpiry, const std::vector<double>& volatility);
+    void runFitBatch();
+    void drainFitBatch();
+    void fitWorkerLoop();
+    std::string snapshotJson(const std::vector<Expiry*>& changed) const;
+    void publishLoop(WebSocketServer& server, std::chrono::milliseconds interval);
+};
+
+#endif
@@ -1,9 +1,12 @@
 #include "WebSocketServer.h"
 #include "../include/Logger.h"
 #include <json/json.h>
+#include <algorithm>
+#include <cctype>
 #include <chrono>
 
-WebSocketServer::WebSocketServer() : running(false) {
+WebSocketServer::WebSocketServer()
+    : instrumentSubscribers(std::make_unique<Subscribers[]>(InstrumentRegistry::MAX_INSTRUMENTS)), running(false) {
     server.init_asio();
     
     server.set_open_handler([this](ConnectionHandle hdl) {
@@ -48,7 +51,11 @@ void WebSocketServer::onOpen(ConnectionHandle hdl) {
 void WebSocketServer::onClose(ConnectionHandle hdl) {
     std::lock_guard<std::mutex> lock(mutex);
     // Remove client from all subscriptions
-    for (auto& pair : subscriptions) {
+    size_t count = std::min(InstrumentRegistry::instance().size(), InstrumentRegistry::MAX_INSTRUMENTS);
+    for (size_t instrument = 0; instrument < count; ++instrument) {
+        instrumentSubscribers[instrument].erase(hdl);
+    }
+    for (auto& pair : channelSubscribers) {
         pair.second.erase(hdl);
     }
     Logger::info("WebSocket connection closed");
@@ -93,23 +100,53 @@ void WebSocketServer::handleSubscription(ConnectionHandle hdl, const std::string
 
     if (Json::parseFromStream(reader, iss, &root, &errors)) {
         if (root.isMember("instrument")) {
-            std::string instrument = root["instrument"].asString();
-            subscriptions[instrument].insert(hdl);
-            Logger::info("Client subscribed to instrument: ", instrument);
+            std::string name = root["instrument"].asString();
+            if (isChannelName(name)) {
+                channelSubscribers[name].insert(hdl);
+                Logger::info("Client subscribed to channel: ", name);
+                return;
+            }
+            InstrumentId instrument = InstrumentRegistry::instance().intern(name);
+            if (instrument == INVALID_INSTRUMENT) {
+                Logger::error("Cannot subscribe client to ", name, ": instrument table is full");
+                return;
+            }
+            instrumentSubscribers[instrument].insert(hdl);
+            Logger::info("Client subscribed to instrument: ", name);
         }
     }
 }
 
-void WebSocketServer::broadcastToSubscribers(const std::string& instrument, const std::string& message) {
+bool WebSocketServer::isChannelName(const std::string& name) {
+    return name.empty() || std::islower(static_cast<unsigned char>(name[0]));
+}
+
+void WebSocketServer::broadcastToSubscribers(const std::string& name, const std::string& message) {
+    if (!isChannelName(name)) {
+        broadcastToSubscribers(InstrumentRegistry::instance().find(name), message);
+        return;
+    }
     std::lock_guard<std::mutex> lock(mutex);
-    
-    if (subscriptions.find(instrument) != subscriptions.end()) {
-        for (const auto& hdl : subscriptions[instrument]) {
-            try {
-                server.send(hdl, message, websocketpp::frame::opcode::text);
-            } catch (const std::exception& e) {
-                Logger::error("Error broadcasting message: ", e.what());
-            }
+    auto it = channelSubscribers.find(name);
+    if (it != channelSubscribers.end()) {
+        sendToAll(it->second, message);
+    }
+}
+
+void WebSocketServer::broadcastToSubscribers(InstrumentId instrument, const std::string& message) {
+    if (instrument >= InstrumentRegistry::MAX_INSTRUMENTS) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    sendToAll(instrumentSubscribers[instrument], message);
+}
+
+void WebSocketServer::sendToAll(const Subscribers& subscribers, const std::string& message) {
+    for (const auto& hdl : subscribers) {
+        try {
+            server.send(hdl, message, websocketpp::frame::opcode::text);
+        } catch (const std::exception& e) {
+            Logger::error("Error broadcasting message: ", e.what());
         }
     }
 }
@@ -141,10 +178,21 @@ void WebSocketServer::setMessageHandler(MessageHandler handler) {
     messageHandler = handler;
 }
 
-bool WebSocketServer::isClientSubscribed(ConnectionHandle hdl, const std::string& instrument) {
+bool WebSocketServer::isClientSubscribed(ConnectionHandle hdl, const std::string& name) {
+    if (!isChannelName(name)) {
+        return isClientSubscribed(hdl, InstrumentRegistry::instance().find(name));
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = channelSubscribers.find(name);
+    return it != channelSubscribers.end() && it->second.count(hdl) > 0;
+}
+
+bool WebSocketServer::isClientSubscribed(ConnectionHandle hdl, InstrumentId instrument) {
+    if (instrument >= InstrumentRegistry::MAX_INSTRUMENTS) {
+        return false;
+    }
     std::lock_guard<std::mutex> lock(mutex);
-    auto it = subscriptions.find(instrument);
-    return it != subscriptions.end() && it->second.find(hdl) != it->second.end();
+    return instrumentSubscribers[instrument].count(hdl) > 0;
 }
 
 WebSocketServer::~WebSocketServer() {
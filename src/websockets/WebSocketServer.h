@@ -4,11 +4,18 @@
 
 #include <websocketpp/config/asio_tls.hpp>
 #include <websocketpp/server.hpp>
+#include "../market/InstrumentRegistry.h"
 #include <map>
+#include <memory>
 #include <set>
 #include <mutex>
 #include <functional>
 
+// Clients subscribe with {"type":"subscribe","instrument":name}. Instrument
+// names (upper case, as on Deribit) are interned and their subscribers kept in
+// a flat table indexed by InstrumentId, so a book update finds them without a
+// string lookup. Lower-case names are the server's own channels ("pnl",
+// "vol_surface"), published about once a second and kept by name.
 class WebSocketServer {
 public:
     using Server = websocketpp::server<websocketpp::config::asio_tls>;
@@ -22,12 +29,18 @@ public:
     void run(uint16_t port);
     void stop();
     void setMessageHandler(MessageHandler handler);
-    void broadcastToSubscribers(const std::string& instrument, const std::string& message);
-    bool isClientSubscribed(ConnectionHandle hdl, const std::string& instrument);
+    // Takes an instrument or a channel name
+    void broadcastToSubscribers(const std::string& name, const std::string& message);
+    void broadcastToSubscribers(InstrumentId instrument, const std::string& message);
+    bool isClientSubscribed(ConnectionHandle hdl, const std::string& name);
+    bool isClientSubscribed(ConnectionHandle hdl, InstrumentId instrument);
 
 private:
+    using Subscribers = std::set<ConnectionHandle, std::owner_less<ConnectionHandle>>;
+
     Server server;
-    std::map<std::string, std::set<ConnectionHandle, std::owner_less<ConnectionHandle>>> subscriptions;
+    std::unique_ptr<Subscribers[]> instrumentSubscribers;  // indexed by InstrumentId
+    std::map<std::string, Subscribers> channelSubscribers;
     std::mutex mutex;
     MessageHandler messageHandler;
     bool running;
@@ -36,6 +49,8 @@ private:
     void onClose(ConnectionHandle hdl);
     void onMessage(ConnectionHandle hdl, Server::message_ptr msg);
     void handleSubscription(ConnectionHandle hdl, const std::string& message);
+    void sendToAll(const Subscribers& subscribers, const std::string& message);
+    static bool isChannelName(const std::string& name);
     void setupTLS();
 };
 
@@ -0,0 +1,165 @@
+// BoundedRing: full and empty rings, FIFO order across many wraparounds, and
+// concurrent producers with one (MPSC) and several (MPMC) consumers. Exits
+// non-zero if any check fails.
+//
+// Build from the repository root:
+//   g++ -std=c++20 -pthread -I src tests/BoundedRingTest.cpp -o BoundedRingTest
+#include "execution/BoundedRing.h"
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::cout << (condition ? "ok    " : "FAIL  ") << what << "\n";
+    failures += !condition;
+}
+
+constexpr int PRODUCERS = 4;
+constexpr int PER_PRODUCER = 200000;
+
+// Values carry their producer in the top bits so order can be checked per producer
+uint64_t encode(int producer, int i) {
+    return (static_cast<uint64_t>(producer) << 32) | static_cast<uint32_t>(i);
+}
+
+template <typename Ring>
+std::vector<std::thread> startProducers(Ring& ring) {
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&ring, p]() {
+            for (int i = 0; i < PER_PRODUCER; ++i) {
+                while (!ring.tryPush(encode(p, i))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    return producers;
+}
+
+void fullAndEmpty() {
+    MpscRing<int> ring(5);
+    int value = 0;
+    check(ring.getCapacity() == 8, "capacity rounds up to a power of two");
+    check(ring.empty() && !ring.tryPop(value), "a new ring is empty");
+
+    bool pushed = true;
+    for (int i = 0; i < 8; ++i) {
+        pushed &= ring.tryPush(i);
+    }
+    check(pushed && ring.size() == 8, "fills to capacity");
+    check(!ring.tryPush(8), "push fails when full");
+
+    check(ring.tryPop(value) && value == 0, "pop frees the oldest slot");
+    check(ring.tryPush(8), "push succeeds again after a pop");
+
+    bool ordered = true;
+    for (int i = 1; i <= 8; ++i) {
+        ordered &= ring.tryPop(value) && value == i;
+    }
+    check(ordered, "drains in FIFO order");
+    check(ring.empty() && !ring.tryPop(value), "pop fails when empty");
+}
+
+template <typename Ring>
+void wraparound(const char* what) {
+    // Odd batch sizes move the head and tail through every slot position
+    Ring ring(8);
+    int next = 0;
+    int expected = 0;
+    bool ordered = true;
+    for (int round = 0; round < 10000; ++round) {
+        int batch = 1 + round % 7;
+        for (int i = 0; i < batch; ++i) {
+            ordered &= ring.tryPush(next++);
+        }
+        for (int i = 0; i < batch; ++i) {
+            int value = -1;
+            ordered &= ring.tryPop(value) && value == expected++;
+        }
+    }
+    check(ordered && ring.empty(), what);
+}
+
+void mpscConcurrent() {
+    MpscRing<uint64_t> ring(64);
+    std::vector<std::thread> producers = startProducers(ring);
+
+    std::vector<int> nextExpected(PRODUCERS, 0);
+    bool ordered = true;
+    int received = 0;
+    while (received < PRODUCERS * PER_PRODUCER) {
+        uint64_t value;
+        if (!ring.tryPop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        int producer = static_cast<int>(value >> 32);
+        int i = static_cast<int>(value & 0xffffffff);
+        ordered &= producer < PRODUCERS && i == nextExpected[producer]++;
+        ++received;
+    }
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+    check(ordered, "MPSC: each producer's values arrive once and in order");
+    check(ring.empty(), "MPSC: the ring is empty once everything is consumed");
+}
+
+void mpmcConcurrent() {
+    constexpr int CONSUMERS = 4;
+    MpmcRing<uint64_t> ring(64);
+    std::vector<std::thread> producers = startProducers(ring);
+
+    std::vector<std::vector<uint8_t>> seen(PRODUCERS, std::vector<uint8_t>(PER_PRODUCER, 0));
+    std::atomic<int> received{0};
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < CONSUMERS; ++c) {
+        consumers.emplace_back([&]() {
+            while (received.load(std::memory_order_relaxed) < PRODUCERS * PER_PRODUCER) {
+                uint64_t value;
+                if (!ring.tryPop(value)) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                // Each slot of seen has a single writer unless a value is popped twice
+                seen[value >> 32][value & 0xffffffff]++;
+                received.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+    for (std::thread& consumer : consumers) {
+        consumer.join();
+    }
+
+    bool once = true;
+    for (const auto& producer : seen) {
+        for (uint8_t count : producer) {
+            once &= count == 1;
+        }
+    }
+    check(once, "MPMC: every value is consumed exactly once");
+    check(ring.empty(), "MPMC: the ring is empty once everything is consumed");
+}
+
+} // namespace
+
+int main() {
+    fullAndEmpty();
+    wraparound<MpscRing<int>>("MPSC: FIFO order holds across wraparound");
+    wraparound<MpmcRing<int>>("MPMC: FIFO order holds across wraparound");
+    mpscConcurrent();
+    mpmcConcurrent();
+
+    std::cout << (failures ? "FAILED" : "passed") << "\n";
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,200 @@
+// OrderJournal: records replayed in order after a reopen, recovery stopping
+// at a damaged record without later ones resurfacing, rewrite, a full
+// journal and concurrent appenders. Exits non-zero if any check fails.
+//
+// Build from the repository root:
+//   g++ -std=c++20 -pthread -I src tests/OrderJournalTest.cpp src/orders/OrderJournal.cpp
+//       src/market/InstrumentRegistry.cpp src/logger.cpp -o OrderJournalTest
+#include "orders/OrderJournal.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::cout << (condition ? "ok    " : "FAIL  ") << what << "\n";
+    failures += !condition;
+}
+
+// Matches the header page OrderJournal writes ahead of the records
+constexpr off_t HEADER_SIZE = 4096;
+
+std::string journalPath(const char* name) {
+    std::string path = "/tmp/OrderJournalTest-" + std::to_string(getpid()) + "-" + name;
+    unlink(path.c_str());
+    return path;
+}
+
+OrderJournal::Options optionsFor(const std::string& path, size_t capacity = 1024) {
+    OrderJournal::Options options;
+    options.path = path;
+    options.capacity = capacity;
+    return options;
+}
+
+std::vector<JournalRecord> replayAll(const OrderJournal& journal) {
+    std::vector<JournalRecord> records;
+    journal.replay([&](const JournalRecord& record) { records.push_back(record); });
+    return records;
+}
+
+Order makeOrder(InstrumentId instrument, const char* orderId, double amount) {
+    Order order;
+    order.instrumentId = instrument;
+    order.orderId = orderId;
+    order.amount = amount;
+    order.price = 50000;
+    return order;
+}
+
+void replayAfterReopen(InstrumentId instrument) {
+    std::string path = journalPath("replay");
+    {
+        OrderJournal journal(optionsFor(path));
+        check(journal.open() && journal.size() == 0, "a new journal opens empty");
+        journal.append(JournalEvent::New, makeOrder(instrument, "", 1));
+        journal.append(JournalEvent::Ack, makeOrder(instrument, "A1", 1));
+        journal.append(JournalEvent::Fill, instrument, -0.5, 50100);
+        journal.append(JournalEvent::Cancel, makeOrder(instrument, "A1", 1));
+        journal.sync();
+        check(journal.durableSize() == 4, "sync makes every appended record durable");
+    }
+
+    OrderJournal journal(optionsFor(path));
+    check(journal.open() && journal.size() == 4, "reopening finds every record");
+    std::vector<JournalRecord> records = replayAll(journal);
+    bool ordered = records.size() == 4;
+    for (size_t i = 0; ordered && i < records.size(); ++i) {
+        ordered = records[i].sequence == i + 1;
+    }
+    check(ordered, "replay yields records in sequence order");
+    check(records.size() == 4 && records[0].event == JournalEvent::New && records[1].event == JournalEvent::Ack &&
+              records[2].event == JournalEvent::Fill && records[3].event == JournalEvent::Cancel,
+          "replay keeps each record's event");
+    check(records.size() == 4 && records[1].order.orderId == "A1" && records[1].order.amount == 1 &&
+              records[1].instrument.view() == "BTC-PERPETUAL",
+          "order records keep the order and the instrument name");
+    check(records.size() == 4 && records[2].amount == -0.5 && records[2].price == 50100 &&
+              records[2].instrument.view() == "BTC-PERPETUAL",
+          "fill records keep the signed amount, price and instrument name");
+
+    check(journal.append(JournalEvent::Update, makeOrder(instrument, "A2", 2)) && journal.size() == 5 &&
+              replayAll(journal).back().sequence == 5,
+          "appending after a reopen continues the sequence");
+    journal.close();
+    unlink(path.c_str());
+}
+
+void damagedRecord(InstrumentId instrument) {
+    std::string path = journalPath("damaged");
+    {
+        OrderJournal journal(optionsFor(path));
+        journal.open();
+        for (int i = 0; i < 5; ++i) {
+            journal.append(JournalEvent::Fill, instrument, i + 1, 50000);
+        }
+    }
+
+    // Flip a byte in the third record's amount
+    int fd = ::open(path.c_str(), O_RDWR);
+    off_t offset = HEADER_SIZE + 2 * static_cast<off_t>(sizeof(JournalRecord)) + offsetof(JournalRecord, amount);
+    char byte = 0;
+    bool damaged = fd >= 0 && pread(fd, &byte, 1, offset) == 1;
+    byte ^= 0x40;
+    damaged = damaged && pwrite(fd, &byte, 1, offset) == 1;
+    ::close(fd);
+    check(damaged, "the third record is damaged on disk");
+
+    {
+        OrderJournal journal(optionsFor(path));
+        check(journal.open() && journal.size() == 2, "recovery stops before the damaged record");
+        journal.append(JournalEvent::Fill, instrument, 30, 50000);
+    }
+
+    OrderJournal journal(optionsFor(path));
+    std::vector<JournalRecord> records;
+    check(journal.open() && (records = replayAll(journal)).size() == 3 && records[2].amount == 30,
+          "records behind the damaged one do not resurface once it is overwritten");
+    journal.close();
+    unlink(path.c_str());
+}
+
+void rewriteAndFull(InstrumentId instrument) {
+    std::string path = journalPath("rewrite");
+    OrderJournal journal(optionsFor(path, 4));
+    journal.open();
+    bool appended = true;
+    for (int i = 0; i < 4; ++i) {
+        appended &= journal.append(JournalEvent::Fill, instrument, 1, 50000);
+    }
+    check(appended && !journal.append(JournalEvent::Fill, instrument, 1, 50000) && journal.size() == 4,
+          "a full journal refuses further records");
+
+    std::vector<JournalRecord> snapshot = replayAll(journal);
+    snapshot.erase(snapshot.begin(), snapshot.begin() + 2);
+    snapshot[0].event = JournalEvent::Position;
+    std::vector<JournalRecord> records;
+    check(journal.rewrite(snapshot) && (records = replayAll(journal)).size() == 2 && records[0].sequence == 1 &&
+              records[1].sequence == 2 && records[0].event == JournalEvent::Position,
+          "rewrite replaces the journal, renumbered from 1");
+    check(journal.append(JournalEvent::Fill, instrument, 1, 50000) && journal.size() == 3,
+          "a rewritten journal takes new records");
+    journal.close();
+    unlink(path.c_str());
+}
+
+void concurrentAppends(InstrumentId instrument) {
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 2000;
+    std::string path = journalPath("concurrent");
+    {
+        OrderJournal journal(optionsFor(path, THREADS * PER_THREAD));
+        journal.open();
+        std::vector<std::thread> appenders;
+        for (int t = 0; t < THREADS; ++t) {
+            appenders.emplace_back([&journal, instrument, t]() {
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    journal.append(JournalEvent::Fill, instrument, t, i);
+                }
+            });
+        }
+        for (std::thread& appender : appenders) {
+            appender.join();
+        }
+    }
+
+    OrderJournal journal(optionsFor(path, THREADS * PER_THREAD));
+    journal.open();
+    std::vector<JournalRecord> records = replayAll(journal);
+    std::vector<int> next(THREADS, 0);
+    bool complete = records.size() == THREADS * PER_THREAD;
+    for (size_t i = 0; complete && i < records.size(); ++i) {
+        int thread = static_cast<int>(records[i].amount);
+        // Each thread's records are claimed in the order it appended them
+        complete = records[i].sequence == i + 1 && thread >= 0 && thread < THREADS &&
+                   records[i].price == next[thread]++;
+    }
+    check(complete, "concurrent appends are all recovered, each thread's in order");
+    journal.close();
+    unlink(path.c_str());
+}
+
+} // namespace
+
+int main() {
+    InstrumentId instrument = InstrumentRegistry::instance().intern("BTC-PERPETUAL");
+    replayAfterReopen(instrument);
+    damagedRecord(instrument);
+    rewriteAndFull(instrument);
+    concurrentAppends(instrument);
+
+    std::cout << (failures ? "FAILED" : "passed") << "\n";
+    return failures ? 1 : 0;
+}
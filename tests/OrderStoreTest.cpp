@@ -0,0 +1,167 @@
+// OrderStore: lookups after backward-shift deletes in a half-full table, the
+// update path (in place, re-keyed, and refused when the new ID is taken), and
+// a random workload checked against a std::map. Exits non-zero if any check
+// fails.
+//
+// Build from the repository root:
+//   g++ -std=c++20 -I src tests/OrderStoreTest.cpp src/orders/models/OrderStore.cpp
+//       src/orders/models/OrderPool.cpp -o OrderStoreTest
+#include "orders/models/OrderStore.h"
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::cout << (condition ? "ok    " : "FAIL  ") << what << "\n";
+    failures += !condition;
+}
+
+OrderHandle acquire(OrderPool& pool, const std::string& orderId, const std::string& label) {
+    Order order;
+    order.orderId = orderId;
+    order.label = label;
+    return pool.acquire(order);
+}
+
+void backwardShiftDelete() {
+    // A full pool fills its table to half, so probe clusters form
+    constexpr size_t CAPACITY = 64;
+    OrderPool pool(CAPACITY);
+    OrderStore store(pool);
+    std::vector<OrderHandle> handles;
+    bool inserted = true;
+    for (size_t i = 0; i < CAPACITY; ++i) {
+        handles.push_back(acquire(pool, "id-" + std::to_string(i), "label-" + std::to_string(i)));
+        inserted &= store.insert(handles.back());
+    }
+    check(inserted && store.size() == CAPACITY, "a full pool fits in the store");
+    check(!store.insert(acquire(pool, "id-0", "")), "an exhausted pool hands out no handle to insert");
+
+    for (size_t i = 0; i < CAPACITY; i += 2) {
+        store.erase(handles[i]);
+    }
+    bool found = true;
+    for (size_t i = 0; i < CAPACITY; ++i) {
+        OrderHandle expected = i % 2 ? handles[i] : INVALID_ORDER_HANDLE;
+        found &= store.find("id-" + std::to_string(i)) == expected;
+        found &= store.findByLabel("label-" + std::to_string(i)) == expected;
+    }
+    check(found, "every remaining order is found after deleting half, erased ones are not");
+    check(store.size() == CAPACITY / 2 && !store.contains(handles[0]) && store.contains(handles[1]),
+          "size and contains follow the deletes");
+
+    bool reinserted = true;
+    for (size_t i = 0; i < CAPACITY; i += 2) {
+        reinserted &= store.insert(handles[i]);
+    }
+    for (size_t i = 0; i < CAPACITY; ++i) {
+        reinserted &= store.find("id-" + std::to_string(i)) == handles[i];
+    }
+    check(reinserted, "erased orders can be inserted again and are found");
+}
+
+void updatePath() {
+    OrderPool pool(16);
+    OrderStore store(pool);
+    OrderHandle first = acquire(pool, "A", "alpha");
+    OrderHandle second = acquire(pool, "B", "beta");
+    store.insert(first);
+    store.insert(second);
+
+    Order amended = pool.get(first);
+    amended.amount = 42;
+    check(store.update(first, amended) && pool.get(first).amount == 42 && store.find("A") == first,
+          "update with the same keys replaces the order in place");
+
+    amended.orderId = "C";
+    amended.label = "gamma";
+    check(store.update(first, amended), "update to a free ID succeeds");
+    check(store.find("C") == first && store.find("A") == INVALID_ORDER_HANDLE, "the order moves to its new ID");
+    check(store.findByLabel("gamma") == first && store.findByLabel("alpha") == INVALID_ORDER_HANDLE,
+          "the order moves to its new label");
+    check(store.size() == 2 && store.contains(first), "re-keying keeps the order stored");
+
+    amended.orderId = "B";
+    amended.amount = 7;
+    check(!store.update(first, amended), "update to an ID held by another order fails");
+    check(store.find("C") == first && store.find("B") == second && pool.get(first).amount == 42,
+          "a failed update leaves both orders untouched");
+
+    amended.orderId = "";
+    check(!store.update(first, amended) && store.find("C") == first, "update to an empty ID fails");
+
+    OrderHandle untracked = acquire(pool, "D", "");
+    Order replacement = pool.get(untracked);
+    replacement.orderId = "E";
+    check(store.update(untracked, replacement) && pool.get(untracked).orderId == "E" &&
+              store.find("E") == INVALID_ORDER_HANDLE,
+          "update of an order that is not stored only replaces it");
+}
+
+// Ten thousand operations over a small key space, so IDs collide and clusters shift
+void matchesMap() {
+    OrderPool pool(64);
+    OrderStore store(pool);
+    std::map<std::string, OrderHandle> expected;
+    std::vector<OrderHandle> stored;
+    std::mt19937 rng(11);
+    int mismatches = 0;
+
+    auto randomId = [&]() { return "id-" + std::to_string(rng() % 100); };
+    for (int step = 0; step < 10000; ++step) {
+        int op = rng() % 3;
+        if (op == 0 && stored.size() < 60) {
+            std::string orderId = randomId();
+            OrderHandle handle = acquire(pool, orderId, "");
+            bool inserted = store.insert(handle);
+            mismatches += inserted == static_cast<bool>(expected.count(orderId));
+            if (inserted) {
+                expected[orderId] = handle;
+                stored.push_back(handle);
+            } else {
+                pool.release(handle);
+            }
+        } else if (op == 1 && !stored.empty()) {
+            size_t i = rng() % stored.size();
+            expected.erase(std::string(pool.get(stored[i]).orderId.view()));
+            store.erase(stored[i]);
+            pool.release(stored[i]);
+            stored.erase(stored.begin() + i);
+        } else if (!stored.empty()) {
+            OrderHandle handle = stored[rng() % stored.size()];
+            std::string previous(pool.get(handle).orderId.view());
+            Order order = pool.get(handle);
+            order.orderId = randomId();
+            bool free = order.orderId == previous || !expected.count(std::string(order.orderId.view()));
+            bool updated = store.update(handle, order);
+            mismatches += updated != free;
+            if (updated) {
+                expected.erase(previous);
+                expected[std::string(order.orderId.view())] = handle;
+            }
+        }
+
+        mismatches += store.size() != expected.size();
+        for (const auto& [orderId, handle] : expected) {
+            mismatches += store.find(orderId) != handle;
+        }
+    }
+    check(mismatches == 0, "inserts, erases and updates match a std::map over 10000 random steps");
+}
+
+} // namespace
+
+int main() {
+    backwardShiftDelete();
+    updatePath();
+    matchesMap();
+
+    std::cout << (failures ? "FAILED" : "passed") << "\n";
+    return failures ? 1 : 0;
+}
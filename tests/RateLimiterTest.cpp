@@ -0,0 +1,130 @@
+// RateLimiter: GCRA bursts and refill, per-instrument buckets, consuming both
+// buckets or neither, request costs, pacing delays, and concurrent callers
+// never granting more than the burst. Exits non-zero if any check fails.
+//
+// Build from the repository root:
+//   g++ -std=c++20 -pthread -I src tests/RateLimiterTest.cpp src/risk/RateLimiter.cpp
+//       src/market/InstrumentRegistry.cpp -o RateLimiterTest
+#include "risk/RateLimiter.h"
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::cout << (condition ? "ok    " : "FAIL  ") << what << "\n";
+    failures += !condition;
+}
+
+// Slow rates keep refills out of the checks that count credits
+RateLimiter::Config slowConfig(double globalBurst, double instrumentBurst) {
+    RateLimiter::Config config;
+    config.globalCreditsPerSecond = 0.01;
+    config.globalBurstCredits = globalBurst;
+    config.instrumentCreditsPerSecond = 0.01;
+    config.instrumentBurstCredits = instrumentBurst;
+    return config;
+}
+
+int acquireAll(RateLimiter& limiter, InstrumentId instrument, int attempts, double cost = RateLimiter::REQUEST_COST) {
+    int granted = 0;
+    for (int i = 0; i < attempts; ++i) {
+        granted += limiter.tryAcquire(instrument, cost);
+    }
+    return granted;
+}
+
+void bursts(InstrumentId first, InstrumentId second) {
+    RateLimiter global(slowConfig(5, 100));
+    check(!global.wouldExceed(first), "a fresh bucket has credits");
+    check(acquireAll(global, first, 10) == 5, "the global bucket grants its burst and no more");
+    check(global.wouldExceed(first) && global.wouldExceed(INVALID_INSTRUMENT), "wouldExceed sees the empty bucket");
+
+    RateLimiter perInstrument(slowConfig(100, 3));
+    check(acquireAll(perInstrument, first, 10) == 3, "an instrument bucket grants its burst and no more");
+    check(acquireAll(perInstrument, second, 10) == 3, "each instrument has its own bucket");
+    check(acquireAll(perInstrument, INVALID_INSTRUMENT, 10) == 10,
+          "requests without an instrument only draw on the global bucket");
+
+    // The global bucket refills quickly here, so only a refund leaves the instrument a credit
+    RateLimiter::Config fastGlobal = slowConfig(2, 3);
+    fastGlobal.globalCreditsPerSecond = 100;
+    RateLimiter both(fastGlobal);
+    check(acquireAll(both, first, 3) == 2, "a request the global bucket refuses is refused");
+    std::this_thread::sleep_for(std::chrono::milliseconds(25));
+    check(both.tryAcquire(first) && !both.tryAcquire(first),
+          "the refused request gave its instrument credit back");
+
+    RateLimiter costs(slowConfig(5, 100));
+    check(costs.tryAcquire(first, 3) && !costs.tryAcquire(first, 3) && costs.tryAcquire(first, 2),
+          "a request's cost is drawn in credits");
+}
+
+void refill(InstrumentId instrument) {
+    RateLimiter::Config config;
+    config.globalCreditsPerSecond = 100;
+    config.globalBurstCredits = 2;
+    config.instrumentCreditsPerSecond = 0;  // disabled
+    RateLimiter limiter(config);
+    check(acquireAll(limiter, instrument, 1000) == 2, "a disabled instrument bucket leaves the global limit");
+    std::this_thread::sleep_for(std::chrono::milliseconds(25));
+    check(limiter.tryAcquire(instrument), "credits refill over time");
+
+    config.globalCreditsPerSecond = 0;
+    limiter.configure(config);
+    check(acquireAll(limiter, instrument, 1000) == 1000, "a non-positive rate disables the limit");
+}
+
+void pacing(InstrumentId instrument) {
+    RateLimiter::Config config = slowConfig(1, 100);
+    config.globalCreditsPerSecond = 10;
+    RateLimiter rejecting(config);
+    std::chrono::nanoseconds delay{-1};
+    check(rejecting.acquire(instrument, delay) && delay.count() == 0 && !rejecting.acquire(instrument, delay) &&
+              delay.count() == 0,
+          "without pacing, acquire rejects instead of delaying");
+
+    config.paceRequests = true;
+    config.maxPaceDelay = std::chrono::milliseconds(250);
+    RateLimiter paced(config);
+    std::chrono::nanoseconds first, second, third, fourth;
+    bool granted = paced.acquire(instrument, first) && paced.acquire(instrument, second) &&
+                   paced.acquire(instrument, third);
+    check(granted && first.count() == 0, "pacing: the burst is sent at once");
+    check(granted && second > std::chrono::milliseconds(50) && second <= std::chrono::milliseconds(100) &&
+              third > std::chrono::milliseconds(150) && third <= std::chrono::milliseconds(200),
+          "pacing: later requests are spaced one interval apart");
+    check(!paced.acquire(instrument, fourth), "pacing: a delay beyond maxPaceDelay is refused");
+}
+
+void concurrentCallers(InstrumentId instrument) {
+    constexpr int THREADS = 4;
+    RateLimiter limiter(slowConfig(1000, 1e6));
+    std::atomic<int> granted{0};
+    std::vector<std::thread> callers;
+    for (int t = 0; t < THREADS; ++t) {
+        callers.emplace_back([&]() { granted += acquireAll(limiter, instrument, 1000); });
+    }
+    for (std::thread& caller : callers) {
+        caller.join();
+    }
+    check(granted == 1000, "concurrent callers are granted exactly the burst");
+}
+
+} // namespace
+
+int main() {
+    InstrumentId first = InstrumentRegistry::instance().intern("BTC-PERPETUAL");
+    InstrumentId second = InstrumentRegistry::instance().intern("ETH-PERPETUAL");
+    bursts(first, second);
+    refill(first);
+    pacing(first);
+    concurrentCallers(first);
+
+    std::cout << (failures ? "FAILED" : "passed") << "\n";
+    return failures ? 1 : 0;
+}
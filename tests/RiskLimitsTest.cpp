@@ -0,0 +1,140 @@
+// Portfolio-wide limits: the USD daily loss limit against coin-settled PnL,
+// and portfolio delta with futures hedging options. Exits non-zero if any
+// check fails.
+//
+// Build from the repository root:
+//   g++ -std=c++20 -pthread -I src -I src/auth -I /usr/include/jsoncpp tests/RiskLimitsTest.cpp
+//       src/risk/PnlEngine.cpp src/risk/RiskManager.cpp src/risk/RateLimiter.cpp
+//       src/market/InstrumentRegistry.cpp src/market/MarketDataManager.cpp src/market/models/OrderBook.cpp
+//       src/websockets/WebSocketServer.cpp src/auth/AuthManager.cpp src/auth/utils/AsyncHttpClient.cpp
+//       src/auth/utils/HttpClient.cpp src/logger.cpp -ljsoncpp -lcurl -lssl -lcrypto -o RiskLimitsTest
+#include "risk/PnlEngine.h"
+#include "risk/RiskManager.h"
+#include <iostream>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::cout << (condition ? "ok    " : "FAIL  ") << what << "\n";
+    failures += !condition;
+}
+
+Order makeOrder(InstrumentId instrument, OrderSide side, double amount, double price) {
+    Order order;
+    order.instrumentId = instrument;
+    order.side = side;
+    order.amount = amount;
+    order.price = price;
+    return order;
+}
+
+Order smallBuy(InstrumentId instrument) {
+    return makeOrder(instrument, OrderSide::Buy, 0.1, 50000);
+}
+
+// Four long calls at 0.5 delta put a 1 BTC portfolio delta limit at 2; a
+// short of 1.5 BTC in the hedge brings it back to 0.5
+void perpetualHedge(const char* hedgeName, double hedgeAmount, const char* what) {
+    InstrumentId call = InstrumentRegistry::instance().intern("BTC-27DEC24-50000-C");
+    InstrumentId hedge = InstrumentRegistry::instance().intern(hedgeName);
+    RiskManager riskManager;
+    RiskManager::RiskLimits limits = riskManager.getRiskLimits();
+    limits.maxOrderSize = 1e6;
+    limits.maxPositionSize = 1e6;
+    limits.maxPortfolioDelta = 1.0;
+    riskManager.setRiskLimits(limits);
+
+    double callDelta = 0.5;
+    double zero = 0;
+    riskManager.updateGreeks(&call, &callDelta, &zero, &zero, 1);
+    riskManager.updatePosition(call, 4, 0.05);
+    std::cout << what << "\n";
+    check(riskManager.getPortfolioGreeks().delta == 2.0, "  four calls put portfolio delta at 2");
+    check(riskManager.checkOrder(makeOrder(call, OrderSide::Buy, 1, 0.05)) == RiskRejection::GreekLimits,
+          "  another call is rejected");
+    check(riskManager.checkOrder(makeOrder(hedge, OrderSide::Buy, hedgeAmount, 50000)) ==
+              RiskRejection::GreekLimits,
+          "  buying the perpetual adds to delta and is rejected");
+    check(riskManager.checkOrder(makeOrder(hedge, OrderSide::Sell, hedgeAmount, 50000)) == RiskRejection::None,
+          "  selling the perpetual reduces delta and passes");
+
+    riskManager.updatePosition(hedge, -hedgeAmount, 50000);
+    double delta = riskManager.getPortfolioGreeks().delta;
+    check(delta > 0.49 && delta < 0.51, "  the filled hedge brings portfolio delta back to 0.5");
+    check(riskManager.checkOrder(makeOrder(call, OrderSide::Buy, 1, 0.05)) == RiskRejection::None,
+          "  a call fits inside the limit again");
+}
+
+// Long $100k of BTC-PERPETUAL at 50000, marked at markPrice; the loss is in BTC
+void inverseBtcLoss(double markPrice, bool expectBreach, const char* what) {
+    InstrumentId perpetual = InstrumentRegistry::instance().intern("BTC-PERPETUAL");
+    RiskManager riskManager;
+    PnlEngine pnl(riskManager);
+    pnl.setContractType(perpetual, PnlEngine::ContractType::Inverse);
+    pnl.onFill(perpetual, 100000, 50000);
+    pnl.onMark(perpetual, markPrice);
+
+    check(riskManager.isDailyLossBreached() == expectBreach, what);
+    RiskRejection rejection = riskManager.checkOrder(smallBuy(perpetual));
+    check((rejection == RiskRejection::DailyLossLimit) == expectBreach, "  new orders are rejected only after a breach");
+}
+
+}
+
+int main() {
+    // 100000 * (1 / 50000 - 1 / 49000) = -0.0408 BTC, about -$2000: past the $1000 limit
+    inverseBtcLoss(49000, true, "inverse BTC loss of about $2000 breaches the $1000 limit");
+    // -0.0080 BTC, about -$400
+    inverseBtcLoss(49800, false, "inverse BTC loss of about $400 stays inside the limit");
+
+    {
+        // About -$600 in BTC and -$600 in ETH: each inside the limit, together past it
+        InstrumentId btc = InstrumentRegistry::instance().intern("BTC-PERPETUAL");
+        InstrumentId eth = InstrumentRegistry::instance().intern("ETH-PERPETUAL");
+        RiskManager riskManager;
+        PnlEngine pnl(riskManager);
+        pnl.setContractType(btc, PnlEngine::ContractType::Inverse);
+        pnl.setContractType(eth, PnlEngine::ContractType::Inverse);
+        pnl.onFill(btc, 50000, 50000);
+        pnl.onMark(btc, 49400);
+        check(!riskManager.isDailyLossBreached(), "BTC loss alone stays inside the limit");
+        pnl.onFill(eth, 30000, 3000);
+        pnl.onMark(eth, 2940);
+        check(riskManager.isDailyLossBreached(), "BTC and ETH losses are summed in USD");
+        double daily = pnl.getDailyPnlUsd();
+        check(daily < -1150 && daily > -1250, "summed daily PnL is about -$1200");
+    }
+
+    {
+        // A linear USDC contract reports its PnL as is
+        InstrumentId linear = InstrumentRegistry::instance().intern("BTC_USDC-PERPETUAL");
+        RiskManager riskManager;
+        PnlEngine pnl(riskManager);
+        pnl.setContractType(linear, PnlEngine::ContractType::Linear);
+        pnl.onFill(linear, 0.5, 50000);
+        pnl.onMark(linear, 47000);
+        check(riskManager.isDailyLossBreached(), "linear USDC loss of $1500 breaches the limit");
+    }
+
+    {
+        // Options settle in the coin without giving its rate; the rate comes from setUsdRate
+        InstrumentId option = InstrumentRegistry::instance().intern("BTC-27DEC24-60000-C");
+        RiskManager riskManager;
+        PnlEngine pnl(riskManager);
+        pnl.setContractType(option, PnlEngine::ContractType::Linear);
+        pnl.onFill(option, 1, 0.05);
+        pnl.onMark(option, 0.02);
+        check(!riskManager.isDailyLossBreached(), "coin loss without a USD rate is not converted");
+        pnl.setUsdRate("BTC", 50000);
+        check(riskManager.isDailyLossBreached(), "0.03 BTC option loss at $50000 breaches the limit");
+    }
+
+    // Linear: 1.5 BTC. Inverse: $75000 at 50000 is 1.5 BTC.
+    perpetualHedge("BTC_USDC-PERPETUAL", 1.5, "linear perpetual hedge");
+    perpetualHedge("BTC-PERPETUAL", 75000, "inverse perpetual hedge");
+
+    std::cout << (failures ? "FAILED" : "passed") << "\n";
+    return failures ? 1 : 0;
+}
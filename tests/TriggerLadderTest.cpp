@@ -0,0 +1,154 @@
+// TriggerLadder and TrailingLadder: which entries a price crosses, in which
+// order and at which trigger, and trailing stops checked against a naive
+// peak-per-order model under random prices. Exits non-zero if any check
+// fails.
+//
+// Build from the repository root:
+//   g++ -std=c++20 -I src tests/TriggerLadderTest.cpp -o TriggerLadderTest
+#include "market/TriggerLadder.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::cout << (condition ? "ok    " : "FAIL  ") << what << "\n";
+    failures += !condition;
+}
+
+using Fired = std::vector<std::pair<OrderHandle, double>>;
+
+template <typename Ladder>
+Fired popCrossed(Ladder& ladder, double reference) {
+    Fired fired;
+    ladder.popCrossed(reference, [&](OrderHandle handle, double trigger) { fired.emplace_back(handle, trigger); });
+    return fired;
+}
+
+Fired update(TrailingLadder& ladder, double reference) {
+    Fired fired;
+    ladder.update(reference, [&](OrderHandle handle, double stop) { fired.emplace_back(handle, stop); });
+    return fired;
+}
+
+void risingTriggers() {
+    // Sell price watches: fire once the bid rises to them
+    TriggerLadder<std::less<double>> ladder;
+    ladder.add(1, 101);
+    ladder.add(2, 100);
+    ladder.add(3, 102);
+    check(popCrossed(ladder, 99.5).empty(), "rising: nothing fires below every trigger");
+    check(popCrossed(ladder, 100) == Fired{{2, 100}}, "rising: a trigger fires when reached");
+    check(popCrossed(ladder, 105) == (Fired{{1, 101}, {3, 102}}), "rising: a jump fires every crossed trigger, nearest first");
+    check(ladder.size() == 0, "rising: fired entries are removed");
+}
+
+void fallingTriggers() {
+    // Sell stops: fire once the bid falls to them
+    TriggerLadder<std::greater<double>> ladder;
+    ladder.add(1, 95);
+    ladder.add(2, 90);
+    ladder.add(3, 97);
+    check(popCrossed(ladder, 98).empty(), "falling: nothing fires above every trigger");
+    check(popCrossed(ladder, 95) == (Fired{{3, 97}, {1, 95}}), "falling: crossed triggers fire, nearest first");
+
+    check(ladder.remove(2) && !ladder.remove(2), "falling: remove reports whether the entry was there");
+    check(popCrossed(ladder, 50).empty(), "falling: a removed entry never fires");
+
+    ladder.add(4, 80);
+    ladder.add(4, 70);
+    check(ladder.size() == 1 && popCrossed(ladder, 75).empty(), "falling: adding again moves the trigger");
+    check(popCrossed(ladder, 70) == Fired{{4, 70}}, "falling: the moved trigger fires at its new price");
+}
+
+void trailingStops() {
+    TrailingLadder ladder;
+    ladder.add(1, 5, 100);
+    check(update(ladder, 96).empty(), "trailing: a fall short of the offset does not fire");
+    check(update(ladder, 110).empty(), "trailing: a new high raises the peak");
+    check(update(ladder, 106).empty(), "trailing: the stop follows the peak");
+    check(update(ladder, 105) == Fired{{1, 105}}, "trailing: fires offset below the peak");
+
+    // Added at different prices, then merged by a new high
+    ladder.add(2, 2, 100);
+    ladder.add(3, 4, 102);
+    ladder.add(4, 6, 104);
+    check(update(ladder, 108).empty(), "trailing: a new high merges every bucket below it");
+    check(update(ladder, 104) == (Fired{{2, 106}, {3, 104}}), "trailing: merged entries fire from the shared peak");
+    check(ladder.size() == 1 && ladder.contains(4), "trailing: the widest stop is still armed");
+    check(update(ladder, 102) == Fired{{4, 102}}, "trailing: and fires once reached");
+
+    // fire may remove entries that were about to fire
+    ladder.add(5, 1, 100);
+    ladder.add(6, 2, 100);
+    Fired fired;
+    ladder.update(90, [&](OrderHandle handle, double stop) {
+        fired.emplace_back(handle, stop);
+        ladder.remove(6);
+    });
+    check(fired == Fired{{5, 99}} && ladder.empty(), "trailing: an entry removed while firing does not fire");
+}
+
+// Every entry keeps its own peak; the ladder must fire the same entries at the same stops
+void trailingMatchesNaiveModel() {
+    constexpr int HANDLES = 500;
+    std::mt19937 rng(7);
+    TrailingLadder ladder;
+    std::vector<std::pair<double, double>> naive(HANDLES, {-1, 0});  // peak (below 0 when unarmed), offset
+    double reference = 1e6;
+    int mismatches = 0;
+    int fires = 0;
+
+    for (int step = 0; step < 100000; ++step) {
+        int op = rng() % 4;
+        if (op == 0) {
+            int handle = rng() % HANDLES;
+            double offset = 1 + rng() % 20;
+            ladder.add(handle, offset, reference);
+            naive[handle] = {reference, offset};
+        } else if (op == 1) {
+            int handle = rng() % HANDLES;
+            mismatches += ladder.remove(handle) != (naive[handle].first >= 0);
+            naive[handle].first = -1;
+        } else {
+            reference += static_cast<int>(rng() % 11) - 5;
+            Fired expected;
+            for (int handle = 0; handle < HANDLES; ++handle) {
+                auto& [peak, offset] = naive[handle];
+                if (peak < 0) {
+                    continue;
+                }
+                peak = std::max(peak, reference);
+                if (reference <= peak - offset) {
+                    expected.emplace_back(handle, peak - offset);
+                    peak = -1;
+                }
+            }
+            Fired fired = update(ladder, reference);
+            std::sort(fired.begin(), fired.end());
+            mismatches += fired != expected;
+            fires += static_cast<int>(fired.size());
+        }
+        size_t armed = std::count_if(naive.begin(), naive.end(), [](const auto& entry) { return entry.first >= 0; });
+        mismatches += ladder.size() != armed;
+    }
+    check(mismatches == 0 && fires > 1000, "trailing: matches a naive model over 100000 random steps");
+}
+
+} // namespace
+
+int main() {
+    risingTriggers();
+    fallingTriggers();
+    trailingStops();
+    trailingMatchesNaiveModel();
+
+    std::cout << (failures ? "FAILED" : "passed") << "\n";
+    return failures ? 1 : 0;
+}